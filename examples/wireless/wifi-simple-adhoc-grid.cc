@@ -169,7 +169,8 @@ int main (int argc, char *argv[])
   YansWifiChannelHelper wifiChannel;
   wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
   wifiChannel.AddPropagationLoss ("ns3::FriisPropagationLossModel");
-  wifiPhy.SetChannel (wifiChannel.Create ());
+  Ptr<YansWifiChannel> channel = wifiChannel.Create ();
+  wifiPhy.SetChannel (channel);
 
   // Add an upper mac and disable rate control
   WifiMacHelper wifiMac;
@@ -242,6 +243,12 @@ int main (int argc, char *argv[])
 
   Simulator::Stop (Seconds (33.0));
   Simulator::Run ();
+  if (channel->GetNTransmissions () > 0)
+    {
+      NS_LOG_UNCOND ("Packet copies per transmission: "
+                     << (double)channel->GetRxPacketCopies () / channel->GetNTransmissions ()
+                     << " (" << channel->GetNTransmissions () << " transmissions)");
+    }
   Simulator::Destroy ();
 
   return 0;
@@ -60,6 +60,9 @@ public:
   * its position falls inside any of the building in BuildingList, and
   * updating accordingly the BuildingInfo aggregated with the MobilityModel.
   *
+  * The BuildingInfo also does so by itself when it is queried after the
+  * mobility model moved, so this is only needed to set it up front.
+  *
   * \param bmm the mobility model to be made consistent
   */
   static void MakeConsistent (Ptr<MobilityModel> bmm);
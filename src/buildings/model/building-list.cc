@@ -25,13 +25,21 @@
 #include "ns3/config.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include "building-list.h"
 #include "building.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("BuildingList");
 
+/// The number of times buildings were added or changed.
+static uint32_t g_nChanges = 0;
+
 /**
  * \brief private implementation detail of the BuildingList API.
  */
@@ -47,14 +55,34 @@ public:
   BuildingList::Iterator End (void) const;
   Ptr<Building> GetBuilding (uint32_t n);
   uint32_t GetNBuildings (void);
+  Ptr<Building> FindBuilding (const Vector &position);
+  void NotifyBuildingChanged (void);
 
   static Ptr<BuildingListPriv> Get (void);
 
 private:
+  /// Coordinates of a cell of the grid index
+  typedef std::pair<int64_t, int64_t> Cell;
+
   virtual void DoDispose (void);
   static Ptr<BuildingListPriv> *DoGet (void);
   static void Delete (void);
+  /**
+   * \param x the x coordinate of a position
+   * \param y the y coordinate of a position
+   * \returns the cell holding the position
+   */
+  Cell GetCell (double x, double y) const;
+  /// Bin every building in the cells overlapped by its boundaries.
+  void BuildIndex (void);
+
   std::vector<Ptr<Building> > m_buildings;
+  /// the buildings overlapping each cell of the grid index
+  std::map<Cell, std::vector<uint32_t> > m_cells;
+  /// the buildings overlapping too many cells to be binned
+  std::vector<uint32_t> m_largeBuildings;
+  double m_cellSize;   //!< the length of the side of the cells
+  bool m_indexValid;   //!< whether the buildings did not change since binned
 };
 
 NS_OBJECT_ENSURE_REGISTERED (BuildingListPriv);
@@ -100,6 +128,8 @@ BuildingListPriv::Delete (void)
 
 
 BuildingListPriv::BuildingListPriv ()
+  : m_cellSize (1.0),
+    m_indexValid (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -118,6 +148,9 @@ BuildingListPriv::DoDispose (void)
       *i = 0;
     }
   m_buildings.erase (m_buildings.begin (), m_buildings.end ());
+  m_cells.clear ();
+  m_largeBuildings.clear ();
+  m_indexValid = false;
   Object::DoDispose ();
 }
 
@@ -127,6 +160,7 @@ BuildingListPriv::Add (Ptr<Building> building)
 {
   uint32_t index = m_buildings.size ();
   m_buildings.push_back (building);
+  NotifyBuildingChanged ();
   Simulator::ScheduleWithContext (index, TimeStep (0), &Building::Initialize, building);
   return index;
 
@@ -155,6 +189,117 @@ BuildingListPriv::GetBuilding (uint32_t n)
   return m_buildings.at (n);
 }
 
+/**
+ * \param x a coordinate
+ * \returns whether the coordinate is neither infinite nor NaN
+ */
+static bool
+IsFinite (double x)
+{
+  return std::fabs (x) <= std::numeric_limits<double>::max ();
+}
+
+BuildingListPriv::Cell
+BuildingListPriv::GetCell (double x, double y) const
+{
+  return Cell (static_cast<int64_t> (std::floor (x / m_cellSize)),
+               static_cast<int64_t> (std::floor (y / m_cellSize)));
+}
+
+void
+BuildingListPriv::BuildIndex (void)
+{
+  NS_LOG_FUNCTION (this << m_buildings.size ());
+  m_cells.clear ();
+  m_largeBuildings.clear ();
+  // cells about the size of a building
+  double sumSize = 0;
+  uint32_t nSizes = 0;
+  for (std::vector<Ptr<Building> >::const_iterator i = m_buildings.begin (); i != m_buildings.end (); ++i)
+    {
+      Box box = (*i)->GetBoundaries ();
+      double size = std::max (box.xMax - box.xMin, box.yMax - box.yMin);
+      if (IsFinite (size))
+        {
+          sumSize += size;
+          nSizes++;
+        }
+    }
+  m_cellSize = (nSizes > 0) ? std::max (1.0, sumSize / nSizes) : 1.0;
+  // far larger buildings are rare, and checked for every position
+  const int64_t maxCells = 1024;
+  for (uint32_t i = 0; i < m_buildings.size (); ++i)
+    {
+      Box box = m_buildings[i]->GetBoundaries ();
+      if (!IsFinite (box.xMin / m_cellSize) || !IsFinite (box.xMax / m_cellSize)
+          || !IsFinite (box.yMin / m_cellSize) || !IsFinite (box.yMax / m_cellSize)
+          || (box.xMax - box.xMin) / m_cellSize > maxCells
+          || (box.yMax - box.yMin) / m_cellSize > maxCells)
+        {
+          m_largeBuildings.push_back (i);
+          continue;
+        }
+      Cell min = GetCell (box.xMin, box.yMin);
+      Cell max = GetCell (box.xMax, box.yMax);
+      if ((max.first - min.first + 1) * (max.second - min.second + 1) > maxCells)
+        {
+          m_largeBuildings.push_back (i);
+          continue;
+        }
+      for (int64_t x = min.first; x <= max.first; ++x)
+        {
+          for (int64_t y = min.second; y <= max.second; ++y)
+            {
+              m_cells[Cell (x, y)].push_back (i);
+            }
+        }
+    }
+  NS_LOG_LOGIC ("binned " << m_buildings.size () << " buildings in " << m_cells.size ()
+                << " cells of " << m_cellSize << " m, " << m_largeBuildings.size () << " not binned");
+  m_indexValid = true;
+}
+
+Ptr<Building>
+BuildingListPriv::FindBuilding (const Vector &position)
+{
+  if (!m_indexValid)
+    {
+      BuildIndex ();
+    }
+  Ptr<Building> found = 0;
+  if (IsFinite (position.x / m_cellSize) && IsFinite (position.y / m_cellSize))
+    {
+      std::map<Cell, std::vector<uint32_t> >::const_iterator cell = m_cells.find (GetCell (position.x, position.y));
+      if (cell != m_cells.end ())
+        {
+          for (std::vector<uint32_t>::const_iterator i = cell->second.begin (); i != cell->second.end (); ++i)
+            {
+              if (m_buildings[*i]->IsInside (position))
+                {
+                  NS_ABORT_MSG_UNLESS (found == 0, "position " << position << " inside several buildings");
+                  found = m_buildings[*i];
+                }
+            }
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator i = m_largeBuildings.begin (); i != m_largeBuildings.end (); ++i)
+    {
+      if (m_buildings[*i]->IsInside (position))
+        {
+          NS_ABORT_MSG_UNLESS (found == 0, "position " << position << " inside several buildings");
+          found = m_buildings[*i];
+        }
+    }
+  return found;
+}
+
+void
+BuildingListPriv::NotifyBuildingChanged (void)
+{
+  g_nChanges++;
+  m_indexValid = false;
+}
+
 }
 
 /**
@@ -189,5 +334,25 @@ BuildingList::GetNBuildings (void)
 {
   return BuildingListPriv::Get ()->GetNBuildings ();
 }
+Ptr<Building>
+BuildingList::FindBuilding (const Vector &position)
+{
+  if (g_nChanges == 0)
+    {
+      // no building was ever created
+      return 0;
+    }
+  return BuildingListPriv::Get ()->FindBuilding (position);
+}
+void
+BuildingList::NotifyBuildingChanged (void)
+{
+  BuildingListPriv::Get ()->NotifyBuildingChanged ();
+}
+uint32_t
+BuildingList::GetNChanges (void)
+{
+  return g_nChanges;
+}
 
 } // namespace ns3
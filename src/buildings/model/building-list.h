@@ -25,6 +25,7 @@
 
 #include <vector>
 #include "ns3/ptr.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
@@ -62,6 +63,29 @@ public:
    * \returns the number of buildings currently in the list.
    */
   static uint32_t GetNBuildings (void);
+  /**
+   * \param position a position
+   * \returns the building whose boundaries contain the position, or 0 if
+   *          the position is outdoor.
+   *
+   * The buildings are looked up in a grid index over their boundaries,
+   * which is built by the first query following the addition or the
+   * change of a building.  The buildings must not overlap.
+   */
+  static Ptr<Building> FindBuilding (const Vector &position);
+  /**
+   * Notify the list that the boundaries, floors or rooms of one of its
+   * buildings changed.
+   *
+   * This method is called automatically by Building so the user has
+   * little reason to call it himself.
+   */
+  static void NotifyBuildingChanged (void);
+  /**
+   * \returns the number of times buildings were added or changed, to know
+   *          whether a building found earlier is still valid.
+   */
+  static uint32_t GetNChanges (void);
 };
 
 } // namespace ns3
@@ -140,6 +140,7 @@ Building::SetBoundaries (Box boundaries)
 {
   NS_LOG_FUNCTION (this << boundaries);
   m_buildingBounds = boundaries;
+  BuildingList::NotifyBuildingChanged ();
 }
 
 void
@@ -161,6 +162,7 @@ Building::SetNFloors (uint16_t nfloors)
 {
   NS_LOG_FUNCTION (this << nfloors);
   m_floors = nfloors;
+  BuildingList::NotifyBuildingChanged ();
 }
 
 void
@@ -168,6 +170,7 @@ Building::SetNRoomsX (uint16_t nroomx)
 {
   NS_LOG_FUNCTION (this << nroomx);
   m_roomsX = nroomx;
+  BuildingList::NotifyBuildingChanged ();
 }
 
 void
@@ -175,6 +178,7 @@ Building::SetNRoomsY (uint16_t nroomy)
 {
   NS_LOG_FUNCTION (this << nroomy);
   m_roomsY = nroomy;
+  BuildingList::NotifyBuildingChanged ();
 }
 
 Box
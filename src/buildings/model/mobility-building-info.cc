@@ -22,6 +22,7 @@
 #include <ns3/simulator.h>
 #include <ns3/position-allocator.h>
 #include <ns3/mobility-building-info.h>
+#include <ns3/building-list.h>
 #include <ns3/pointer.h>
 #include <ns3/log.h>
 #include <ns3/assert.h>
@@ -45,6 +46,10 @@ MobilityBuildingInfo::GetTypeId (void)
 
 
 MobilityBuildingInfo::MobilityBuildingInfo ()
+  : m_mobility (0),
+    m_courseChanged (true),
+    m_moving (false),
+    m_nChanges (0)
 {
   NS_LOG_FUNCTION (this);
   m_indoor = false;
@@ -55,7 +60,11 @@ MobilityBuildingInfo::MobilityBuildingInfo ()
 
 
 MobilityBuildingInfo::MobilityBuildingInfo (Ptr<Building> building)
-  : m_myBuilding (building)
+  : m_mobility (0),
+    m_courseChanged (true),
+    m_moving (false),
+    m_nChanges (0),
+    m_myBuilding (building)
 {
   NS_LOG_FUNCTION (this);
   m_indoor = false;
@@ -68,6 +77,7 @@ bool
 MobilityBuildingInfo::IsIndoor (void)
 {
   NS_LOG_FUNCTION (this);
+  Update ();
   return (m_indoor);
 }
 
@@ -75,6 +85,7 @@ bool
 MobilityBuildingInfo::IsOutdoor (void)
 {
   NS_LOG_FUNCTION (this);
+  Update ();
   return (!m_indoor);
 }
 
@@ -95,7 +106,7 @@ MobilityBuildingInfo::SetIndoor (Ptr<Building> building, uint8_t nfloor, uint8_t
   NS_ASSERT (m_roomY <= building->GetNRoomsY ());
   NS_ASSERT (m_nFloor > 0);
   NS_ASSERT (m_nFloor <= building->GetNFloors ());
-
+  SetUpdated ();
 }
 
 
@@ -115,7 +126,7 @@ MobilityBuildingInfo::SetIndoor (uint8_t nfloor, uint8_t nroomx, uint8_t nroomy)
   NS_ASSERT (m_roomY <= m_myBuilding->GetNRoomsY ());
   NS_ASSERT (m_nFloor > 0);
   NS_ASSERT (m_nFloor <= m_myBuilding->GetNFloors ());
-
+  SetUpdated ();
 }
 
 
@@ -124,12 +135,14 @@ MobilityBuildingInfo::SetOutdoor (void)
 {
   NS_LOG_FUNCTION (this);
   m_indoor = false;
+  SetUpdated ();
 }
 
 uint8_t
 MobilityBuildingInfo::GetFloorNumber (void)
 {
   NS_LOG_FUNCTION (this);
+  Update ();
   return (m_nFloor);
 }
 
@@ -137,6 +150,7 @@ uint8_t
 MobilityBuildingInfo::GetRoomNumberX (void)
 {
   NS_LOG_FUNCTION (this);
+  Update ();
   return (m_roomX);
 }
 
@@ -144,6 +158,7 @@ uint8_t
 MobilityBuildingInfo::GetRoomNumberY (void)
 {
   NS_LOG_FUNCTION (this);
+  Update ();
   return (m_roomY);
 }
 
@@ -152,8 +167,97 @@ Ptr<Building>
 MobilityBuildingInfo::GetBuilding ()
 {
   NS_LOG_FUNCTION (this);
+  Update ();
   return (m_myBuilding);
 }
 
+void
+MobilityBuildingInfo::MakeConsistent (Ptr<MobilityModel> mm)
+{
+  NS_LOG_FUNCTION (this << mm);
+  Vector pos = mm->GetPosition ();
+  Ptr<Building> building = BuildingList::FindBuilding (pos);
+  if (building != 0)
+    {
+      NS_LOG_LOGIC ("MobilityBuildingInfo " << this << " pos " << pos << " falls inside building " << building->GetId ());
+      SetIndoor (building, building->GetFloor (pos), building->GetRoomX (pos), building->GetRoomY (pos));
+    }
+  else
+    {
+      NS_LOG_LOGIC ("MobilityBuildingInfo " << this << " pos " << pos << " is outdoor");
+      SetOutdoor ();
+    }
+}
+
+void
+MobilityBuildingInfo::NotifyNewAggregate (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_mobility == 0)
+    {
+      // not a Ptr: the mobility model is in the same aggregate, which
+      // would then never be freed
+      m_mobility = PeekPointer (GetObject<MobilityModel> ());
+      if (m_mobility != 0)
+        {
+          m_mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&MobilityBuildingInfo::CourseChanged, this));
+        }
+    }
+  Object::NotifyNewAggregate ();
+}
+
+void
+MobilityBuildingInfo::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_mobility = 0;
+  m_myBuilding = 0;
+  Object::DoDispose ();
+}
+
+void
+MobilityBuildingInfo::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  m_courseChanged = true;
+}
+
+void
+MobilityBuildingInfo::Update (void)
+{
+  if (m_mobility == 0)
+    {
+      return;
+    }
+  uint32_t nChanges = BuildingList::GetNChanges ();
+  if (!m_courseChanged && !m_moving && m_nChanges == nChanges)
+    {
+      return;
+    }
+  Vector position = m_mobility->GetPosition ();
+  if (m_nChanges == nChanges && position.x == m_position.x
+      && position.y == m_position.y && position.z == m_position.z)
+    {
+      // only the speed changed
+      SetUpdated ();
+      return;
+    }
+  NS_LOG_LOGIC ("MobilityBuildingInfo " << this << " moved to " << position);
+  MakeConsistent (m_mobility);
+}
+
+void
+MobilityBuildingInfo::SetUpdated (void)
+{
+  if (m_mobility == 0)
+    {
+      return;
+    }
+  Vector velocity = m_mobility->GetVelocity ();
+  m_courseChanged = false;
+  m_moving = (velocity.x != 0 || velocity.y != 0 || velocity.z != 0);
+  m_position = m_mobility->GetPosition ();
+  m_nChanges = BuildingList::GetNChanges ();
+}
+
   
 } // namespace
@@ -30,6 +30,7 @@
 #include <map>
 #include <ns3/building.h>
 #include <ns3/constant-velocity-helper.h>
+#include <ns3/mobility-model.h>
 
 
 
@@ -42,7 +43,10 @@ namespace ns3 {
  *
  * This model implements the managment of scenarios where users might be
  * either indoor (e.g., houses, offices, etc.) and outdoor.
- * 
+ *
+ * Once aggregated to a MobilityModel, the instance finds again the building,
+ * floor and room of the mobility model when queried after the course of the
+ * mobility model changed, while it moves, or after the buildings changed.
  */
 class MobilityBuildingInfo : public Object
 {
@@ -107,9 +111,36 @@ public:
    */
   Ptr<Building> GetBuilding ();
 
+  /**
+   * Make this MobilityBuildingInfo instance consistent with the position of
+   * a mobility model, by finding the building of BuildingList which
+   * contains it, if any.
+   *
+   * \param mm the mobility model whose position to use
+   */
+  void MakeConsistent (Ptr<MobilityModel> mm);
 
+protected:
+  virtual void NotifyNewAggregate (void);
+  virtual void DoDispose (void);
 
 private:
+  /**
+   * Called when the course of the aggregated mobility model changes.
+   *
+   * \param mobility the mobility model
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+  /// Find again the building of the aggregated mobility model if needed.
+  void Update (void);
+  /// Record that the state matches the aggregated mobility model.
+  void SetUpdated (void);
+
+  MobilityModel *m_mobility; ///< the aggregated mobility model, if any
+  bool m_courseChanged; ///< whether the course changed since the last update
+  bool m_moving;        ///< whether the mobility model moved at the last update
+  Vector m_position;    ///< the position of the mobility model at the last update
+  uint32_t m_nChanges;  ///< BuildingList::GetNChanges () at the last update
 
   Ptr<Building> m_myBuilding;
   bool m_indoor;
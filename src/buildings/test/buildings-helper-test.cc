@@ -25,6 +25,7 @@
 #include <ns3/mobility-building-info.h>
 #include <ns3/constant-position-mobility-model.h>
 #include <ns3/building.h>
+#include <ns3/building-list.h>
 #include <ns3/buildings-helper.h>
 #include <ns3/mobility-helper.h>
 #include <ns3/simulator.h>
@@ -168,8 +169,83 @@ BuildingsHelperOneTestCase::DoRun ()
 }
 
 
+/**
+ * Check the buildings found by the grid index of BuildingList against all
+ * the buildings, and that MobilityBuildingInfo follows its mobility model
+ * and the changes of the buildings without keeping it alive.
+ */
+class BuildingsHelperGridTestCase : public TestCase
+{
+public:
+  BuildingsHelperGridTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BuildingsHelperGridTestCase::BuildingsHelperGridTestCase ()
+  : TestCase ("buildings found with the grid index and after moving")
+{
+}
+
+void
+BuildingsHelperGridTestCase::DoRun ()
+{
+  // 20x20 buildings of various sizes, and a large one across them
+  for (uint32_t i = 0; i < 20; i++)
+    {
+      for (uint32_t j = 0; j < 20; j++)
+        {
+          Ptr<Building> b = CreateObject<Building> ();
+          double size = 4 + (i * 7 + j * 3) % 10;
+          b->SetBoundaries (Box (i * 20.0, i * 20.0 + size, j * 20.0, j * 20.0 + size, 0, 10));
+          b->SetNFloors (2);
+        }
+    }
+  Ptr<Building> large = CreateObject<Building> ();
+  large->SetBoundaries (Box (-1e5, -1e3, -1e5, 1e5, 0, 10));
 
+  for (double x = -1010; x < 410; x += 2.5)
+    {
+      for (double y = -3; y < 410; y += 7.5)
+        {
+          Vector pos (x, y, 2);
+          Ptr<Building> expected = 0;
+          for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+            {
+              if ((*bit)->IsInside (pos))
+                {
+                  expected = *bit;
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (BuildingList::FindBuilding (pos), expected, "wrong building at " << pos);
+        }
+    }
 
+  Ptr<ConstantPositionMobilityModel> mm = CreateObject<ConstantPositionMobilityModel> ();
+  mm->SetPosition (Vector (1, 1, 7));
+  Ptr<MobilityBuildingInfo> buildingInfo = CreateObject<MobilityBuildingInfo> ();
+  mm->AggregateObject (buildingInfo);
+  // a reference from the building info would keep the aggregate alive
+  NS_TEST_ASSERT_MSG_EQ (mm->GetReferenceCount (), 1U, "the mobility model is referenced by its building info");
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->IsIndoor (), true, "should be indoor");
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->GetBuilding (), BuildingList::GetBuilding (0), "wrong building");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) buildingInfo->GetFloorNumber (), 2, "wrong floor");
+
+  mm->SetPosition (Vector (21, 41, 2));
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->IsIndoor (), true, "should be indoor after moving");
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->GetBuilding (), BuildingList::GetBuilding (22), "wrong building after moving");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) buildingInfo->GetFloorNumber (), 1, "wrong floor after moving");
+
+  mm->SetPosition (Vector (19, 41, 2));
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->IsOutdoor (), true, "should be outdoor after moving");
+
+  BuildingList::GetBuilding (2)->SetBoundaries (Box (15, 25, 40, 50, 0, 10));
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->IsIndoor (), true, "should be indoor after the building changed");
+  NS_TEST_ASSERT_MSG_EQ (buildingInfo->GetBuilding (), BuildingList::GetBuilding (2), "wrong building after it changed");
+
+  Simulator::Destroy ();
+}
 
 
 
@@ -321,6 +397,8 @@ BuildingsHelperTestSuite::BuildingsHelperTestSuite ()
   q7.pos = vq7;
   q7.indoor = false;
   AddTestCase (new BuildingsHelperOneTestCase (q7, b2), TestCase::QUICK);     
+
+  AddTestCase (new BuildingsHelperGridTestCase (), TestCase::QUICK);
 }
 
 static BuildingsHelperTestSuite buildingsHelperAntennaTestSuiteInstance;
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "replication-runner.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/system-path.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup randomvariable
+ * ns3::ReplicationRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+ReplicationRunner::ReplicationRunner ()
+  : m_directory ("results"),
+    m_maxWorkers (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ReplicationRunner::SetResultsDirectory (std::string directory)
+{
+  NS_LOG_FUNCTION (this << directory);
+  m_directory = directory;
+}
+
+void
+ReplicationRunner::SetMaxWorkers (uint32_t workers)
+{
+  NS_LOG_FUNCTION (this << workers);
+  m_maxWorkers = workers;
+}
+
+void
+ReplicationRunner::SetPrepareCallback (Callback<void, uint64_t> prepare)
+{
+  NS_LOG_FUNCTION (this << &prepare);
+  m_prepare = prepare;
+}
+
+void
+ReplicationRunner::SetFinishCallback (Callback<void, uint64_t> finish)
+{
+  NS_LOG_FUNCTION (this << &finish);
+  m_finish = finish;
+}
+
+std::string
+ReplicationRunner::GetRunDirectory (uint64_t run) const
+{
+  std::ostringstream oss;
+  oss << "run-" << run;
+  return SystemPath::Append (m_directory, oss.str ());
+}
+
+uint32_t
+ReplicationRunner::Run (uint64_t firstRun, uint32_t replications)
+{
+  NS_LOG_FUNCTION (this << firstRun << replications);
+
+  uint32_t maxWorkers = m_maxWorkers;
+  if (maxWorkers == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      maxWorkers = processors > 0 ? processors : 1;
+    }
+
+  SystemPath::MakeDirectories (m_directory);
+  for (uint32_t i = 0; i < replications; ++i)
+    {
+      SystemPath::MakeDirectories (GetRunDirectory (firstRun + i));
+    }
+
+  // Whatever is buffered would otherwise be written again by each worker.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  std::map<pid_t, uint64_t> workers;
+  std::map<uint64_t, int> statuses;
+  uint32_t next = 0;
+  while (next < replications || !workers.empty ())
+    {
+      if (next < replications && workers.size () < maxWorkers)
+        {
+          uint64_t run = firstRun + next;
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "ReplicationRunner::Run(): fork failed: " << std::strerror (errno));
+          if (pid == 0)
+            {
+              RunWorker (run);
+            }
+          NS_LOG_LOGIC ("Started run " << run << " in process " << pid);
+          workers[pid] = run;
+          ++next;
+          continue;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_ABORT_MSG_IF (errno != EINTR, "ReplicationRunner::Run(): waitpid failed: " << std::strerror (errno));
+          continue;
+        }
+      std::map<pid_t, uint64_t>::iterator worker = workers.find (pid);
+      if (worker == workers.end ())
+        {
+          // Not one of our workers.
+          continue;
+        }
+      NS_LOG_LOGIC ("Run " << worker->second << " ended with status " << status);
+      statuses[worker->second] = status;
+      workers.erase (worker);
+    }
+
+  uint32_t failures = 0;
+  std::ofstream summary (SystemPath::Append (m_directory, "runs.txt").c_str ());
+  for (std::map<uint64_t, int>::const_iterator i = statuses.begin (); i != statuses.end (); ++i)
+    {
+      int status = i->second;
+      summary << i->first << " ";
+      if (WIFEXITED (status))
+        {
+          summary << "exit " << WEXITSTATUS (status);
+          if (WEXITSTATUS (status) != 0)
+            {
+              ++failures;
+            }
+        }
+      else
+        {
+          summary << "signal " << (WIFSIGNALED (status) ? WTERMSIG (status) : 0);
+          ++failures;
+        }
+      summary << std::endl;
+    }
+  NS_LOG_INFO (replications << " runs from " << firstRun << " with " << maxWorkers
+                            << " workers, " << failures << " failed");
+  return failures;
+}
+
+void
+ReplicationRunner::RunWorker (uint64_t run)
+{
+  NS_LOG_FUNCTION (this << run);
+
+  std::string directory = GetRunDirectory (run);
+  if (chdir (directory.c_str ()) != 0
+      || std::freopen ("stdout.txt", "w", stdout) == 0
+      || std::freopen ("stderr.txt", "w", stderr) == 0)
+    {
+      std::cerr << "Cannot run in " << directory << ": " << std::strerror (errno) << std::endl;
+      _exit (1);
+    }
+
+  RngSeedManager::SetRun (run);
+  RandomVariableStream::ResetAll ();
+  if (!m_prepare.IsNull ())
+    {
+      m_prepare (run);
+    }
+  Simulator::Run ();
+  if (!m_finish.IsNull ())
+    {
+      m_finish (run);
+    }
+  Simulator::Destroy ();
+
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  // Do not run the exit handlers and static destructors of the program
+  // which forked this worker: it goes on with its own copy of them.
+  _exit (0);
+}
+
+} // namespace ns3
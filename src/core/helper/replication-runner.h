@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include "ns3/callback.h"
+
+#include <stdint.h>
+#include <string>
+
+/**
+ * \file
+ * \ingroup randomvariable
+ * ns3::ReplicationRunner declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup randomvariable
+ *
+ * \brief Run the replications of a simulation in worker processes
+ * forked once the scenario is built.
+ *
+ * Building the topology, installing the stacks and computing the routes
+ * may take longer than running the simulation itself.  Instead of
+ * repeating them for each run number, the scenario is built once, and
+ * Run () forks a worker process per replication.  Each worker sets its
+ * run number with RngSeedManager::SetRun (), restarts the random
+ * variables created so far with RandomVariableStream::ResetAll (), then
+ * runs and destroys the simulation.
+ *
+ * The values drawn during the run are those of a program building the
+ * scenario with this run number only if no random value is drawn before
+ * Run (): the values drawn while building the scenario, such as the
+ * positions of a random position allocator or the attributes sampled when
+ * an object is constructed, come from the run number of the calling
+ * process, and are the same in all the replications.  Moreover, the
+ * random variables which drew them restart from the first value of their
+ * stream in the workers, so they draw again the values used for the
+ * scenario of this run number, instead of those which follow.
+ *
+ * \code
+ *   // Build the topology, install the applications, ...
+ *   ReplicationRunner runner;
+ *   runner.SetResultsDirectory ("results");
+ *   runner.SetFinishCallback (MakeCallback (&WriteStatistics));
+ *   runner.Run (1, 100);
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * At most as many workers as processors run at once.  Each worker runs
+ * in its own directory, \c run-<run> in the results directory: the
+ * files opened with relative names, such as traces, are written there,
+ * as are the standard output and error of the worker, in \c stdout.txt
+ * and \c stderr.txt.  The exit status of each replication is listed in
+ * the \c runs.txt file of the results directory.
+ *
+ * The simulation must not have run, and the simulator implementation
+ * must not have started threads or MPI: the worker processes only
+ * inherit the calling thread.
+ */
+class ReplicationRunner
+{
+public:
+  /** Construct a ReplicationRunner. */
+  ReplicationRunner ();
+
+  /**
+   * Set the directory gathering the results of the replications.
+   * \param [in] directory The directory, created if needed, "results"
+   *             by default.
+   */
+  void SetResultsDirectory (std::string directory);
+  /**
+   * Set the number of workers which may run at once.
+   * \param [in] workers The number of workers, or 0, the default, for
+   *             the number of processors online.
+   */
+  void SetMaxWorkers (uint32_t workers);
+  /**
+   * Set a function called by each worker before running the simulation,
+   * once the random variables are reset, for instance to enable traces.
+   * \param [in] prepare The function, given the run number.
+   */
+  void SetPrepareCallback (Callback<void, uint64_t> prepare);
+  /**
+   * Set a function called by each worker after running the simulation,
+   * before destroying it, for instance to write statistics.
+   * \param [in] finish The function, given the run number.
+   */
+  void SetFinishCallback (Callback<void, uint64_t> finish);
+
+  /**
+   * Run the replications and wait for their end.
+   * \param [in] firstRun The run number of the first replication.
+   * \param [in] replications The number of replications, using the run
+   *             numbers which follow firstRun.
+   * \returns The number of replications which failed.
+   */
+  uint32_t Run (uint64_t firstRun, uint32_t replications);
+
+  /**
+   * \param [in] run A run number.
+   * \returns The directory of the replication of this run number.
+   */
+  std::string GetRunDirectory (uint64_t run) const;
+
+private:
+  /**
+   * Run a replication in a worker process, and exit.
+   * \param [in] run The run number of the replication.
+   */
+  void RunWorker (uint64_t run);
+
+  std::string m_directory;              //!< The results directory.
+  uint32_t m_maxWorkers;                //!< The number of workers at once.
+  Callback<void, uint64_t> m_prepare;   //!< Called before the run.
+  Callback<void, uint64_t> m_finish;    //!< Called after the run.
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
@@ -59,7 +59,7 @@ AttributeConstructionList::Add (std::string name, Ptr<const AttributeChecker> ch
 
 }
 Ptr<AttributeValue> 
-AttributeConstructionList::Find (Ptr<const AttributeChecker> checker) const
+AttributeConstructionList::Find (const Ptr<const AttributeChecker> &checker) const
 {
   NS_LOG_FUNCTION (this << checker);
   for (CIterator k = m_list.begin (); k != m_list.end (); k++)
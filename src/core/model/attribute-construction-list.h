@@ -72,7 +72,7 @@ public:
    *             AttributeChecker from TypeId::AttributeInformation.
    * \returns The AttributeValue.
    */
-  Ptr<AttributeValue> Find (Ptr<const AttributeChecker> checker) const;
+  Ptr<AttributeValue> Find (const Ptr<const AttributeChecker> &checker) const;
 
   /** \returns The first item in the list */
   CIterator Begin (void) const;
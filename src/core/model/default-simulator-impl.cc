@@ -46,6 +46,13 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+/**
+ * \ingroup simulator
+ * Number of slots in the lock-free ring of events scheduled from
+ * other threads.  Bursts beyond this size go to the overflow list.
+ */
+static const uint32_t EVENTS_WITH_CONTEXT_RING_SIZE = 4096;
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -58,6 +65,9 @@ DefaultSimulatorImpl::GetTypeId (void)
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl ()
+  : m_eventsWithContext (EVENTS_WITH_CONTEXT_RING_SIZE),
+    m_eventsWithContextOverflowing (false),
+    m_eventsWithContextEmpty (true)
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
@@ -71,7 +81,6 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
 }
 
@@ -161,33 +170,57 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContextEmpty.load (std::memory_order_acquire))
     {
       return;
     }
+  // Clear the flag before draining: any event published after this
+  // point sets it again and is picked up on the next call.
+  m_eventsWithContextEmpty.exchange (true, std::memory_order_acq_rel);
+
+  EventWithContext event;
+  while (m_eventsWithContext.TryPop (event))
+    {
+      InsertEventWithContext (event);
+    }
 
-  // swap queues
+  if (!m_eventsWithContextOverflowing.load (std::memory_order_acquire))
+    {
+      return;
+    }
+  if (!m_eventsWithContext.IsDrained ())
+    {
+      // A producer has claimed a slot in the ring but not yet
+      // published it; its event must be inserted before the overflow.
+      m_eventsWithContextEmpty.store (false, std::memory_order_release);
+      return;
+    }
   EventsWithContext eventsWithContext;
   {
     CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
+    m_eventsWithContextOverflow.swap (eventsWithContext);
+    m_eventsWithContextOverflowing.store (false, std::memory_order_release);
   }
   while (!eventsWithContext.empty ())
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
+      InsertEventWithContext (eventsWithContext.front ());
+      eventsWithContext.pop_front ();
     }
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  ev.key.m_ts = m_currentTs + event.timestamp;
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
 void
 DefaultSimulatorImpl::Run (void)
 {
@@ -269,11 +302,14 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      if (m_eventsWithContextOverflowing.load (std::memory_order_acquire)
+          || !m_eventsWithContext.TryPush (ev))
+        {
+          CriticalSection cs (m_eventsWithContextMutex);
+          m_eventsWithContextOverflow.push_back (ev);
+          m_eventsWithContextOverflowing.store (true, std::memory_order_release);
+        }
+      m_eventsWithContextEmpty.store (false, std::memory_order_release);
     }
 }
 
@@ -26,9 +26,11 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
+#include "mpsc-ring.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -95,16 +97,45 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Insert an event received from a different thread into the main
+   * event queue, relative to the current time.
+   *
+   * \param [in] event The event to insert.
+   */
+  void InsertEventWithContext (const EventWithContext &event);
+
+  /**
+   * Lock-free queue of the events scheduled from a different thread.
+   *
+   * Producers only fall back to #m_eventsWithContextOverflow
+   * when this ring is full.
+   */
+  MpscRing<EventWithContext> m_eventsWithContext;
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
+  /**
+   * The events from a different context which did not fit in
+   * #m_eventsWithContext, protected by #m_eventsWithContextMutex.
+   */
+  EventsWithContext m_eventsWithContextOverflow;
+  /**
+   * Flag \c true while #m_eventsWithContextOverflow is in use.
+   *
+   * Once set, producers keep appending to the overflow list until
+   * the main thread drains it, so that the events from one thread
+   * are inserted in the order they were scheduled.
+   */
+  std::atomic<bool> m_eventsWithContextOverflowing;
   /**
    * Flag \c true if all events with context have been moved to the
    * primary event queue.
+   *
+   * This is the only shared state read by the main thread after
+   * each event when no other thread is scheduling events.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
+  std::atomic<bool> m_eventsWithContextEmpty;
+  /** Mutex to control access to the overflow list of events with context. */
   SystemMutex m_eventsWithContextMutex;
 
   /** Container type for the events to run at Simulator::Destroy() */
@@ -21,6 +21,9 @@
 #include "event-impl.h"
 #include "log.h"
 
+#include <iomanip>
+#include <new>
+
 /**
  * \file
  * \ingroup events
@@ -31,6 +34,186 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+/**
+ * \ingroup events
+ * \defgroup eventpool Event Allocation Pool
+ *
+ * Per-thread pools of fixed size blocks backing EventImpl::operator new.
+ *
+ * Blocks are obtained from, and beyond #EVENT_POOL_MAX_FREE returned to,
+ * the global allocator one at a time, so that a block allocated by one
+ * thread can be released into the pool of another.  No pool is ever
+ * accessed by more than one thread, so none needs locking.
+ */
+
+/** \ingroup eventpool Size class granularity, in bytes. */
+static const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** \ingroup eventpool Number of size classes; larger events are not pooled. */
+static const std::size_t EVENT_POOL_CLASSES = 16;
+/** \ingroup eventpool Maximum number of free blocks kept per size class. */
+static const uint32_t EVENT_POOL_MAX_FREE = 4096;
+
+/** \ingroup eventpool A free block, linked in the free list of its class. */
+struct EventPoolBlock
+{
+  EventPoolBlock *next;  //!< The next free block of the same class.
+};
+
+/** \ingroup eventpool The event pools of one thread. */
+struct EventPool
+{
+  /** Constructor. */
+  EventPool ();
+  /** Destructor: release the free blocks at thread exit. */
+  ~EventPool ();
+  /** Free list head of each size class. */
+  EventPoolBlock *m_free[EVENT_POOL_CLASSES];
+  /** Statistics of each size class, then of the oversized events. */
+  EventImpl::PoolStats m_stats[EVENT_POOL_CLASSES + 1];
+};
+
+/**
+ * \ingroup eventpool
+ * Flag \c true once the pool of this thread has been destroyed, after
+ * which events are allocated with the global allocator.
+ */
+static thread_local bool g_eventPoolDestroyed = false;
+/** \ingroup eventpool The pool of this thread. */
+static thread_local EventPool g_eventPool;
+
+EventPool::EventPool ()
+{
+  for (std::size_t i = 0; i <= EVENT_POOL_CLASSES; ++i)
+    {
+      if (i < EVENT_POOL_CLASSES)
+        {
+          m_free[i] = 0;
+          m_stats[i].blockSize = (i + 1) * EVENT_POOL_GRANULARITY;
+        }
+      else
+        {
+          m_stats[i].blockSize = 0;
+        }
+      m_stats[i].allocations = 0;
+      m_stats[i].recycled = 0;
+      m_stats[i].releases = 0;
+      m_stats[i].pooled = 0;
+    }
+}
+
+EventPool::~EventPool ()
+{
+  for (std::size_t i = 0; i < EVENT_POOL_CLASSES; ++i)
+    {
+      while (m_free[i] != 0)
+        {
+          EventPoolBlock *block = m_free[i];
+          m_free[i] = block->next;
+          ::operator delete (block);
+        }
+      m_stats[i].pooled = 0;
+    }
+  g_eventPoolDestroyed = true;
+}
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  // Do not add function logging here: this is called for every event
+  std::size_t cls = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (g_eventPoolDestroyed)
+    {
+      return ::operator new (size);
+    }
+  EventPool &pool = g_eventPool;
+  if (cls >= EVENT_POOL_CLASSES)
+    {
+      pool.m_stats[EVENT_POOL_CLASSES].allocations++;
+      return ::operator new (size);
+    }
+  pool.m_stats[cls].allocations++;
+  EventPoolBlock *block = pool.m_free[cls];
+  if (block != 0)
+    {
+      pool.m_free[cls] = block->next;
+      pool.m_stats[cls].pooled--;
+      pool.m_stats[cls].recycled++;
+      return block;
+    }
+  return ::operator new (pool.m_stats[cls].blockSize);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t cls = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (g_eventPoolDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPool &pool = g_eventPool;
+  if (cls >= EVENT_POOL_CLASSES)
+    {
+      pool.m_stats[EVENT_POOL_CLASSES].releases++;
+      ::operator delete (p);
+      return;
+    }
+  pool.m_stats[cls].releases++;
+  if (pool.m_stats[cls].pooled >= EVENT_POOL_MAX_FREE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPoolBlock *block = static_cast<EventPoolBlock *> (p);
+  block->next = pool.m_free[cls];
+  pool.m_free[cls] = block;
+  pool.m_stats[cls].pooled++;
+}
+
+std::vector<EventImpl::PoolStats>
+EventImpl::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::vector<PoolStats> stats;
+  if (!g_eventPoolDestroyed)
+    {
+      stats.assign (g_eventPool.m_stats, g_eventPool.m_stats + EVENT_POOL_CLASSES + 1);
+    }
+  return stats;
+}
+
+void
+EventImpl::PrintPoolStats (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  std::vector<PoolStats> stats = GetPoolStats ();
+  os << std::setw (10) << "Block" << std::setw (14) << "Allocations"
+     << std::setw (14) << "Recycled" << std::setw (14) << "Releases"
+     << std::setw (10) << "Pooled" << std::endl;
+  for (std::vector<PoolStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      if (i->allocations == 0 && i->releases == 0)
+        {
+          continue;
+        }
+      if (i->blockSize == 0)
+        {
+          os << std::setw (10) << "larger";
+        }
+      else
+        {
+          os << std::setw (10) << i->blockSize;
+        }
+      os << std::setw (14) << i->allocations << std::setw (14) << i->recycled
+         << std::setw (14) << i->releases << std::setw (10) << i->pooled << std::endl;
+    }
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,6 +21,9 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <ostream>
+#include <vector>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +43,15 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Instances are allocated from per-thread pools of fixed size
+ * blocks, one pool per size class.  When the last reference to an
+ * event is released by Unref() its block goes back to the pool of the
+ * releasing thread, so that the steady state of a simulation
+ * schedules events without calling malloc or free.  Each thread only
+ * ever touches its own pools, which keeps this safe with the realtime
+ * and distributed simulator implementations and with events created
+ * by other threads for Simulator::ScheduleWithContext().
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +78,44 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate an event from the pool of the calling thread.
+   *
+   * \param [in] size The size of the event object.
+   * \returns The storage for the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return an event to the pool of the calling thread.
+   *
+   * \param [in] p The storage of the event.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /** Allocation statistics of one size class of the event pool. */
+  struct PoolStats
+  {
+    std::size_t blockSize;   //!< Size of the blocks, 0 for oversized events.
+    uint64_t allocations;    //!< Number of events allocated.
+    uint64_t recycled;       //!< Allocations served from the pool.
+    uint64_t releases;       //!< Number of events released.
+    uint32_t pooled;         //!< Blocks currently held in the pool.
+  };
+  /**
+   * Get the statistics of the event pools of the calling thread.
+   *
+   * \returns One entry per size class, followed by one entry for
+   *          the events too large to be pooled.
+   */
+  static std::vector<PoolStats> GetPoolStats (void);
+  /**
+   * Print the statistics of the event pools of the calling thread.
+   *
+   * \param [in,out] os The output stream.
+   */
+  static void PrintPoolStats (std::ostream &os);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,391 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include "unused.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+/**
+ * \ingroup scheduler
+ * Buckets with more events than this are spread over a new rung
+ * rather than sorted into the bottom.
+ */
+static const uint32_t LADDER_THRESHOLD = 50;
+/** \ingroup scheduler Maximum number of rungs in the ladder. */
+static const uint32_t LADDER_MAX_RUNGS = 8;
+/** \ingroup scheduler Maximum number of buckets in a rung. */
+static const uint32_t LADDER_MAX_BUCKETS = 1 << 20;
+/** \ingroup scheduler End of a bucket chain. */
+static const uint32_t LADDER_NONE = 0xffffffff;
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (~(uint64_t)0),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (LADDER_MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::InitRung (Rung &rung, uint64_t start, uint64_t width, uint32_t nBuckets)
+{
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.count = 0;
+  rung.heads.assign (nBuckets, LADDER_NONE);
+  rung.sizes.assign (nBuckets, 0);
+  rung.events.clear ();
+  rung.next.clear ();
+}
+
+void
+LadderScheduler::AddToRung (Rung &rung, const Scheduler::Event &ev)
+{
+  // the last bucket also holds any event past the end of the rung
+  uint64_t bucket = (ev.key.m_ts - rung.start) / rung.width;
+  if (bucket >= rung.heads.size ())
+    {
+      bucket = rung.heads.size () - 1;
+    }
+  NS_ASSERT (bucket >= rung.current);
+  rung.next.push_back (rung.heads[bucket]);
+  rung.heads[bucket] = rung.events.size ();
+  rung.events.push_back (ev);
+  rung.sizes[bucket]++;
+  rung.count++;
+}
+
+uint64_t
+LadderScheduler::SpawnRung (const std::vector<Scheduler::Event> &events,
+                            uint64_t minTs, uint64_t maxTs)
+{
+  NS_LOG_FUNCTION (this << events.size () << minTs << maxTs);
+  NS_ASSERT (m_nRungs < LADDER_MAX_RUNGS);
+
+  uint64_t nBuckets = std::min<uint64_t> (events.size (), LADDER_MAX_BUCKETS);
+  uint64_t width = (maxTs - minTs) / nBuckets + 1;
+  nBuckets = (maxTs - minTs) / width + 1;
+
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  InitRung (rung, minTs, width, nBuckets);
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin ();
+       i != events.end (); ++i)
+    {
+      AddToRung (rung, *i);
+    }
+  NS_LOG_LOGIC ("rung " << m_nRungs - 1 << " start=" << minTs <<
+                ", width=" << width << ", buckets=" << nBuckets);
+  return minTs + nBuckets * width;
+}
+
+void
+LadderScheduler::SpawnRungFromBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_bottom.size () - m_bottomHead <= LADDER_THRESHOLD
+      || m_nRungs == LADDER_MAX_RUNGS)
+    {
+      return;
+    }
+  uint64_t minTs = m_bottom[m_bottomHead].key.m_ts;
+  uint64_t maxTs = m_bottom.back ().key.m_ts;
+  if (minTs == maxTs)
+    {
+      return;
+    }
+  m_scratch.assign (m_bottom.begin () + m_bottomHead, m_bottom.end ());
+  SpawnRung (m_scratch, minTs, maxTs);
+  FillBottom ();
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_bottom.clear ();
+  m_bottomHead = 0;
+  while (m_qSize > 0)
+    {
+      if (m_nRungs == 0)
+        {
+          // start a new epoch with the content of the top
+          NS_ASSERT (!m_top.empty ());
+          bool direct = m_top.size () <= LADDER_THRESHOLD || m_topMin == m_topMax;
+          if (direct)
+            {
+              m_bottom.swap (m_top);
+              std::sort (m_bottom.begin (), m_bottom.end ());
+              m_topStart = m_topMax + 1;
+            }
+          else
+            {
+              m_topStart = SpawnRung (m_top, m_topMin, m_topMax);
+              m_top.clear ();
+            }
+          m_topMin = ~(uint64_t)0;
+          m_topMax = 0;
+          if (direct)
+            {
+              return;
+            }
+          continue;
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.heads.size () && rung.sizes[rung.current] == 0)
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.heads.size ())
+        {
+          NS_ASSERT (rung.count == 0);
+          m_nRungs--;
+          continue;
+        }
+
+      uint32_t size = rung.sizes[rung.current];
+      uint64_t minTs = ~(uint64_t)0;
+      uint64_t maxTs = 0;
+      m_scratch.clear ();
+      for (uint32_t i = rung.heads[rung.current]; i != LADDER_NONE; i = rung.next[i])
+        {
+          const Scheduler::Event &ev = rung.events[i];
+          minTs = std::min (minTs, ev.key.m_ts);
+          maxTs = std::max (maxTs, ev.key.m_ts);
+          m_scratch.push_back (ev);
+        }
+      rung.heads[rung.current] = LADDER_NONE;
+      rung.sizes[rung.current] = 0;
+      rung.count -= size;
+      rung.current++;
+
+      if (size > LADDER_THRESHOLD && m_nRungs < LADDER_MAX_RUNGS && minTs != maxTs)
+        {
+          SpawnRung (m_scratch, minTs, maxTs);
+          continue;
+        }
+      m_bottom.swap (m_scratch);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+      return;
+    }
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  if (m_bottomHead > 0 && ev < m_bottom[m_bottomHead])
+    {
+      m_bottomHead--;
+      m_bottom[m_bottomHead] = ev;
+      return;
+    }
+  std::vector<Scheduler::Event>::iterator pos =
+    std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  m_bottom.insert (pos, ev);
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  m_qSize++;
+
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+    }
+  else
+    {
+      bool found = false;
+      for (uint32_t r = 0; r < m_nRungs; r++)
+        {
+          Rung &rung = m_rungs[r];
+          if (rung.current < rung.heads.size () && ts >= GetCurrentStart (rung))
+            {
+              AddToRung (rung, ev);
+              found = true;
+              break;
+            }
+        }
+      if (!found)
+        {
+          InsertInBottom (ev);
+          SpawnRungFromBottom ();
+        }
+    }
+
+  if (m_bottomHead == m_bottom.size ())
+    {
+      FillBottom ();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+
+  Scheduler::Event ev = m_bottom[m_bottomHead];
+  m_bottomHead++;
+  m_qSize--;
+  if (m_bottomHead == m_bottom.size ())
+    {
+      FillBottom ();
+    }
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+
+  uint64_t ts = ev.key.m_ts;
+  bool found = false;
+  if (ts >= m_topStart)
+    {
+      for (std::vector<Scheduler::Event>::iterator i = m_top.begin (); i != m_top.end (); ++i)
+        {
+          if (i->key.m_uid == ev.key.m_uid)
+            {
+              NS_ASSERT (ev.impl == i->impl);
+              *i = m_top.back ();
+              m_top.pop_back ();
+              found = true;
+              break;
+            }
+        }
+    }
+  else
+    {
+      uint32_t r;
+      for (r = 0; r < m_nRungs; r++)
+        {
+          if (m_rungs[r].current < m_rungs[r].heads.size ()
+              && ts >= GetCurrentStart (m_rungs[r]))
+            {
+              break;
+            }
+        }
+      if (r < m_nRungs)
+        {
+          Rung &rung = m_rungs[r];
+          uint64_t bucket = std::min<uint64_t> ((ts - rung.start) / rung.width,
+                                                rung.heads.size () - 1);
+          uint32_t *prev = &rung.heads[bucket];
+          for (uint32_t i = *prev; i != LADDER_NONE; i = *prev)
+            {
+              if (rung.events[i].key.m_uid == ev.key.m_uid)
+                {
+                  NS_ASSERT (ev.impl == rung.events[i].impl);
+                  *prev = rung.next[i];
+                  rung.sizes[bucket]--;
+                  rung.count--;
+                  found = true;
+                  break;
+                }
+              prev = &rung.next[i];
+            }
+        }
+      else
+        {
+          std::vector<Scheduler::Event>::iterator i =
+            std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+          if (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid)
+            {
+              NS_ASSERT (ev.impl == i->impl);
+              m_bottom.erase (i);
+              found = true;
+            }
+        }
+    }
+  NS_ASSERT (found);
+  NS_UNUSED (found);
+
+  m_qSize--;
+  if (m_bottomHead == m_bottom.size ())
+    {
+      FillBottom ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * Events are kept in three tiers:
+ *  - Top: an unsorted array of the events furthest in the future.
+ *  - Ladder: up to a fixed number of rungs, each one a calendar of
+ *    buckets.  Each rung stores its events in one contiguous array
+ *    and chains the events of a bucket by array index, so that
+ *    rungs are reused from one epoch to the next without allocating.
+ *  - Bottom: a small sorted array holding the earliest events.
+ *
+ * When the bottom runs dry the first non-empty bucket of the lowest
+ * rung is sorted into it.  A bucket holding too many events is
+ * instead spread over a new, finer rung.  When the ladder itself is
+ * empty a new epoch starts: the top is transferred to the first
+ * rung, whose bucket width is derived from the spread of timestamps
+ * in the top.  The bucket width of each rung therefore adapts to the
+ * event distribution, which avoids the resizing pathologies of
+ * CalendarScheduler with skewed distributions.
+ *
+ * Insert and RemoveNext run in O(1) amortized time.  Remove of an
+ * arbitrary event is O(1) amortized for events in the ladder or
+ * bottom, but linear in the size of the top for events in the top.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** One rung of the ladder: a calendar of buckets over a time range. */
+  struct Rung
+  {
+    /** Start time of the first bucket. */
+    uint64_t start;
+    /** Duration of a bucket, in dimensionless time units. */
+    uint64_t width;
+    /** Index of the first bucket which may still hold events. */
+    uint32_t current;
+    /** Number of events held in the rung. */
+    uint32_t count;
+    /** Index in #events of the first event of each bucket. */
+    std::vector<uint32_t> heads;
+    /** Number of events in each bucket. */
+    std::vector<uint32_t> sizes;
+    /** Storage of the events of all buckets. */
+    std::vector<Scheduler::Event> events;
+    /** Index in #events of the next event in the same bucket. */
+    std::vector<uint32_t> next;
+  };
+
+  /**
+   * Get the start time of the first bucket of a rung which may still
+   * accept events.
+   *
+   * \param [in] rung The rung.
+   * \returns The start time of the current bucket.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /**
+   * Reset a rung to cover a new time range, keeping its storage.
+   *
+   * \param [in,out] rung The rung.
+   * \param [in] start The start time of the rung.
+   * \param [in] width The bucket width.
+   * \param [in] nBuckets The number of buckets.
+   */
+  static void InitRung (Rung &rung, uint64_t start, uint64_t width, uint32_t nBuckets);
+  /**
+   * Add an event to the bucket of a rung matching its timestamp.
+   *
+   * \param [in,out] rung The rung.
+   * \param [in] ev The event.
+   */
+  static void AddToRung (Rung &rung, const Scheduler::Event &ev);
+  /**
+   * Spawn a new lowest rung holding a set of events.
+   *
+   * \param [in] events The events.
+   * \param [in] minTs The smallest timestamp of the events.
+   * \param [in] maxTs The largest timestamp of the events.
+   * \returns The end time of the new rung.
+   */
+  uint64_t SpawnRung (const std::vector<Scheduler::Event> &events,
+                      uint64_t minTs, uint64_t maxTs);
+  /**
+   * Spread the bottom over a new rung, if it has grown too large.
+   */
+  void SpawnRungFromBottom (void);
+  /**
+   * Refill the empty bottom from the ladder or the top.
+   */
+  void FillBottom (void);
+  /**
+   * Insert an event in the sorted bottom.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+
+  /** Unsorted events with a timestamp of at least #m_topStart. */
+  std::vector<Scheduler::Event> m_top;
+  /** Smallest timestamp in the top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in the top. */
+  uint64_t m_topMax;
+  /** Events at or after this timestamp are inserted in the top. */
+  uint64_t m_topStart;
+  /** The rungs, allocated once and reused; only #m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Sorted earliest events, from #m_bottomHead on. */
+  std::vector<Scheduler::Event> m_bottom;
+  /** Index of the earliest event in #m_bottom. */
+  uint32_t m_bottomHead;
+  /** Scratch storage used while spawning rungs. */
+  std::vector<Scheduler::Event> m_scratch;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
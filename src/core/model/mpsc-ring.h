@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_RING_H
+#define MPSC_RING_H
+
+#include "assert.h"
+#include "non-copyable.h"
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MpscRing declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Bounded lock-free multiple-producer, single-consumer ring.
+ *
+ * Each slot carries a sequence number which tells producers whether the
+ * slot is free for the current lap and tells the consumer whether the
+ * slot has been published.  Producers claim a slot with a single
+ * compare-and-swap on the enqueue position; the consumer never
+ * executes an atomic read-modify-write.
+ *
+ * TryPush() may be called concurrently from any number of threads.
+ * TryPop() and IsDrained() must only be called from one thread at
+ * a time, normally the simulator main thread.
+ *
+ * The ring is bounded: TryPush() fails instead of blocking when all
+ * slots are in use, leaving the overflow policy to the caller.
+ *
+ * \tparam T \explicit The element type, which must be copy-assignable.
+ */
+template <typename T>
+class MpscRing : private NonCopyable
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] capacity The number of slots, which must be a
+   *             power of two.
+   */
+  MpscRing (uint32_t capacity);
+  /** Destructor. */
+  ~MpscRing ();
+
+  /**
+   * Append an element, from any thread.
+   *
+   * \param [in] value The element to append.
+   * \returns \c false if the ring is full.
+   */
+  bool TryPush (const T &value);
+  /**
+   * Remove the oldest published element, from the consumer thread.
+   *
+   * \param [out] value The element removed.
+   * \returns \c false if no published element is available.
+   */
+  bool TryPop (T &value);
+  /**
+   * Check that every claimed slot has been consumed.
+   *
+   * This is stronger than TryPop() returning \c false: a producer may
+   * have claimed a slot without having published it yet.
+   *
+   * \returns \c true if no slot is claimed or published.
+   */
+  bool IsDrained (void) const;
+  /**
+   * Get the number of slots.
+   * \returns The ring capacity.
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  /** A ring slot. */
+  struct Cell
+  {
+    /** Lap-tagged sequence number of this slot. */
+    std::atomic<uint64_t> sequence;
+    /** The stored element. */
+    T value;
+  };
+
+  /** The slots. */
+  Cell *m_cells;
+  /** Capacity minus one, to compute slot indices. */
+  uint64_t m_mask;
+  /** Next position to be claimed by a producer. */
+  std::atomic<uint64_t> m_enqueuePos;
+  /** Next position to be read by the consumer. */
+  uint64_t m_dequeuePos;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscRing<T>::MpscRing (uint32_t capacity)
+  : m_cells (new Cell[capacity]),
+    m_mask (capacity - 1),
+    m_enqueuePos (0),
+    m_dequeuePos (0)
+{
+  NS_ASSERT_MSG (capacity >= 2 && (capacity & (capacity - 1)) == 0,
+                 "MpscRing capacity must be a power of two");
+  for (uint64_t i = 0; i < capacity; ++i)
+    {
+      m_cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpscRing<T>::~MpscRing ()
+{
+  delete [] m_cells;
+  m_cells = 0;
+}
+
+template <typename T>
+bool
+MpscRing<T>::TryPush (const T &value)
+{
+  uint64_t pos = m_enqueuePos.load (std::memory_order_relaxed);
+  Cell *cell;
+  for (;;)
+    {
+      cell = &m_cells[pos & m_mask];
+      uint64_t seq = cell->sequence.load (std::memory_order_acquire);
+      int64_t diff = (int64_t)seq - (int64_t)pos;
+      if (diff == 0)
+        {
+          if (m_enqueuePos.compare_exchange_weak (pos, pos + 1,
+                                                  std::memory_order_relaxed))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // the consumer has not freed this slot yet: ring is full
+          return false;
+        }
+      else
+        {
+          pos = m_enqueuePos.load (std::memory_order_relaxed);
+        }
+    }
+  cell->value = value;
+  cell->sequence.store (pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool
+MpscRing<T>::TryPop (T &value)
+{
+  Cell *cell = &m_cells[m_dequeuePos & m_mask];
+  uint64_t seq = cell->sequence.load (std::memory_order_acquire);
+  if (seq != m_dequeuePos + 1)
+    {
+      return false;
+    }
+  value = cell->value;
+  cell->sequence.store (m_dequeuePos + m_mask + 1, std::memory_order_release);
+  ++m_dequeuePos;
+  return true;
+}
+
+template <typename T>
+bool
+MpscRing<T>::IsDrained (void) const
+{
+  return m_enqueuePos.load (std::memory_order_acquire) == m_dequeuePos;
+}
+
+template <typename T>
+uint32_t
+MpscRing<T>::GetCapacity (void) const
+{
+  return m_mask + 1;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_RING_H */
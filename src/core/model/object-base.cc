@@ -87,7 +87,9 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
       NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
       for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
+          // the information is not copied, so that objects can be
+          // constructed concurrently without sharing reference counts
+          const struct TypeId::AttributeInformation &info = tid.GetAttribute(i);
           NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
                         info.name <<"\"");
           // is this attribute stored in this AttributeConstructionList instance ?
@@ -173,8 +175,8 @@ ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 }
 
 bool
-ObjectBase::DoSet (Ptr<const AttributeAccessor> accessor, 
-                   Ptr<const AttributeChecker> checker,
+ObjectBase::DoSet (const Ptr<const AttributeAccessor> &accessor, 
+                   const Ptr<const AttributeChecker> &checker,
                    const AttributeValue &value)
 {
   NS_LOG_FUNCTION (this << accessor << checker << &value);
@@ -225,8 +225,8 @@ private:
    * \returns \c true if the \c value could be validated by the \p checker
    *          and written to the storage location.
    */
-  bool DoSet (Ptr<const AttributeAccessor> spec,
-              Ptr<const AttributeChecker> checker, 
+  bool DoSet (const Ptr<const AttributeAccessor> &spec,
+              const Ptr<const AttributeChecker> &checker, 
               const AttributeValue &value);
 
 };
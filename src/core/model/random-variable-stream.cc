@@ -33,6 +33,7 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "system-mutex.h"
 #include <cmath>
 #include <iostream>
 
@@ -71,17 +72,71 @@ RandomVariableStream::GetTypeId (void)
   return tid;
 }
 
+/**
+ * \ingroup randomvariable
+ * \brief Get the mutex guarding the set of the existing random variables,
+ * the automatic stream numbers and the change of their RngStream.
+ *
+ * Random variables may be created by the threads of the
+ * MultithreadedSimulatorImpl or of the RadioEnvironmentMapHelper.
+ *
+ * \return The mutex.
+ */
+static SystemMutex &
+GetStreamsMutex (void)
+{
+  // Never deleted, like the set it guards.
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_index (0)
 {
   NS_LOG_FUNCTION (this);
+  CriticalSection cs (GetStreamsMutex ());
+  GetStreams ()->insert (this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  CriticalSection cs (GetStreamsMutex ());
+  GetStreams ()->erase (this);
   delete m_rng;
 }
 
+std::set<RandomVariableStream *> *
+RandomVariableStream::GetStreams (void)
+{
+  // Never deleted, since random variables may be destroyed after the
+  // static objects.
+  static std::set<RandomVariableStream *> *streams = new std::set<RandomVariableStream *> ();
+  return streams;
+}
+
+void
+RandomVariableStream::ResetAll (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CriticalSection cs (GetStreamsMutex ());
+  std::set<RandomVariableStream *> *streams = GetStreams ();
+  for (std::set<RandomVariableStream *>::const_iterator i = streams->begin (); i != streams->end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng == 0)
+        {
+          // Its stream number is not set yet.
+          continue;
+        }
+      delete stream->m_rng;
+      stream->m_rng = new RngStream (RngSeedManager::GetSeed (),
+                                     stream->m_index,
+                                     RngSeedManager::GetRun ());
+    }
+  NS_LOG_DEBUG ("Reset " << streams->size () << " random variables for run " << RngSeedManager::GetRun ());
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
@@ -100,6 +155,7 @@ RandomVariableStream::SetStream (int64_t stream)
   NS_LOG_FUNCTION (this << stream);
   // negative values are not legal.
   NS_ASSERT (stream >= -1);
+  CriticalSection cs (GetStreamsMutex ());
   delete m_rng;
   if (stream == -1)
     {
@@ -107,6 +163,7 @@ RandomVariableStream::SetStream (int64_t stream)
       // number assignment.
       uint64_t nextStream = RngSeedManager::GetNextStreamIndex ();
       NS_ASSERT(nextStream <= ((1ULL)<<63));
+      m_index = nextStream;
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
                              RngSeedManager::GetRun ());
@@ -117,6 +174,7 @@ RandomVariableStream::SetStream (int64_t stream)
       // number assignment.
       uint64_t base = ((1ULL)<<63);
       uint64_t target = base + stream;
+      m_index = target;
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
                              RngSeedManager::GetRun ());
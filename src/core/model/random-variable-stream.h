@@ -29,6 +29,7 @@
 #include "type-id.h"
 #include "object.h"
 #include "attribute-helper.h"
+#include <set>
 #include <stdint.h>
 
 /**
@@ -149,6 +150,25 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Restart the RNG streams of all the existing random variables
+   * from the current seed and run.
+   *
+   * Each random variable keeps its stream number, automatically allocated
+   * or not, so that after RngSeedManager::SetRun () and this call, the
+   * existing random variables draw the values they would have drawn since
+   * their creation, had they been created with the new run number.  This
+   * allows to build a scenario once and to run it for several run numbers,
+   * as ReplicationRunner does, as long as no random value is drawn while
+   * building it: the values drawn before this call are not drawn again,
+   * and the variables which drew them start over.
+   *
+   * Random variables may be created or destroyed by other threads
+   * meanwhile, but the automatic stream numbers of the variables created
+   * by several threads depend on the order in which the threads run.
+   */
+  static void ResetAll (void);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RNG stream.
@@ -186,6 +206,15 @@ private:
   /** The stream number for this RNG stream. */
   int64_t m_stream;
 
+  /** The index of the underlying RNG stream, automatic or not. */
+  uint64_t m_index;
+
+  /**
+   * \brief Get the random variables which exist.
+   * \return The set of the existing random variables.
+   */
+  static std::set<RandomVariableStream *> *GetStreams (void);
+
 };  // class RandomVariableStream
 
   
@@ -23,6 +23,7 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
+#include <deque>
 #include <map>
 #include <vector>
 #include <sstream>
@@ -228,7 +229,7 @@ public:
    * \param [in] i Index into attribute array
    * \returns The information associated to attribute whose index is \p i.
    */
-  struct TypeId::AttributeInformation GetAttribute(uint16_t uid, uint32_t i) const;
+  const struct TypeId::AttributeInformation &GetAttribute(uint16_t uid, uint32_t i) const;
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -321,7 +322,7 @@ private:
     std::string supportMsg;
   };
   /** Iterator type. */
-  typedef std::vector<struct IidInformation>::const_iterator Iterator;
+  typedef std::deque<struct IidInformation>::const_iterator Iterator;
 
   /**
    * Retrieve the information record for a type.
@@ -330,8 +331,12 @@ private:
    */
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
 
-  /** The container of all type id records. */
-  std::vector<struct IidInformation> m_information;
+  /**
+   * The container of all type id records.  Registering a type does not
+   * move the records of the others: the references returned by
+   * GetAttribute remain valid.
+   */
+  std::deque<struct IidInformation> m_information;
 
   /** Type of the by-name index. */
   typedef std::map<std::string, uint16_t> namemap_t;
@@ -689,7 +694,7 @@ IidManager::GetAttributeN (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << size);
   return size;
 }
-struct TypeId::AttributeInformation 
+const struct TypeId::AttributeInformation &
 IidManager::GetAttribute(uint16_t uid, uint32_t i) const
 {
   NS_LOG_FUNCTION (IID << uid << i);
@@ -1061,7 +1066,7 @@ TypeId::GetAttributeN (void) const
   uint32_t n = IidManager::Get ()->GetAttributeN (m_tid);
   return n;
 }
-struct TypeId::AttributeInformation 
+const struct TypeId::AttributeInformation &
 TypeId::GetAttribute(uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
@@ -1071,7 +1076,7 @@ std::string
 TypeId::GetAttributeFullName (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  struct TypeId::AttributeInformation info = GetAttribute(i);
+  const struct TypeId::AttributeInformation &info = GetAttribute(i);
   return GetName () + "::" + info.name;
 }
 
@@ -254,7 +254,7 @@ public:
    * \param [in] i Index into attribute array
    * \returns The information associated to attribute whose index is \p i.
    */
-  struct TypeId::AttributeInformation GetAttribute(uint32_t i) const;
+  const struct TypeId::AttributeInformation &GetAttribute(uint32_t i) const;
   /**
    * Get the Attribute name by index.
    *
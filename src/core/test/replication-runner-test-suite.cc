@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/replication-runner.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/rng-stream.h"
+#include "ns3/simulator.h"
+#include "ns3/system-path.h"
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \ingroup tests
+ * The value which a random variable of a fixed stream number draws first.
+ * \param [in] stream The stream number.
+ * \param [in] run The run number.
+ * \returns The first value of a uniform random variable between 0 and 1.
+ */
+double
+FirstValue (int64_t stream, uint64_t run)
+{
+  RngStream rng (RngSeedManager::GetSeed (), (1ULL << 63) + stream, run);
+  return rng.RandU01 ();
+}
+
+/**
+ * \ingroup tests
+ * The value which a random variable of a fixed stream number draws second.
+ * \param [in] stream The stream number.
+ * \param [in] run The run number.
+ * \returns The second value of a uniform random variable between 0 and 1.
+ */
+double
+SecondValue (int64_t stream, uint64_t run)
+{
+  RngStream rng (RngSeedManager::GetSeed (), (1ULL << 63) + stream, run);
+  rng.RandU01 ();
+  return rng.RandU01 ();
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup tests
+ * Check that RandomVariableStream::ResetAll () restarts the existing
+ * random variables as if they were created with the new run number.
+ */
+class RandomVariableResetTestCase : public TestCase
+{
+public:
+  RandomVariableResetTestCase ();
+  virtual void DoRun (void);
+};
+
+RandomVariableResetTestCase::RandomVariableResetTestCase ()
+  : TestCase ("Reset the random variables for another run")
+{
+}
+
+void
+RandomVariableResetTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+
+  Ptr<UniformRandomVariable> fixed = CreateObject<UniformRandomVariable> ();
+  fixed->SetStream (7);
+  Ptr<UniformRandomVariable> automatic = CreateObject<UniformRandomVariable> ();
+
+  RngSeedManager::SetRun (5);
+  RandomVariableStream::ResetAll ();
+  double value = fixed->GetValue ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (value, FirstValue (7, 5), 1e-15, "Not restarted for run 5");
+  NS_TEST_ASSERT_MSG_EQ (fixed->GetStream (), 7, "Lost the stream number");
+  double first = automatic->GetValue ();
+
+  RngSeedManager::SetRun (6);
+  RandomVariableStream::ResetAll ();
+  value = fixed->GetValue ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (value, FirstValue (7, 6), 1e-15, "Not restarted for run 6");
+  NS_TEST_ASSERT_MSG_NE (automatic->GetValue (), first, "Same value for runs 5 and 6");
+
+  RngSeedManager::SetRun (5);
+  RandomVariableStream::ResetAll ();
+  NS_TEST_ASSERT_MSG_EQ (automatic->GetValue (), first, "The automatic stream changed");
+
+  RngSeedManager::SetRun (run);
+  RandomVariableStream::ResetAll ();
+}
+
+/**
+ * \ingroup tests
+ * Run replications of a simulation in worker processes, and check
+ * the values drawn by each of them.
+ */
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Write the values drawn by the random variables, in a worker.
+   */
+  void Draw (void);
+  /**
+   * Print the run number, in a worker.
+   * \param [in] run The run number.
+   */
+  void Prepare (uint64_t run);
+
+  Ptr<UniformRandomVariable> m_fixed;      //!< Random variable of stream 7.
+  Ptr<UniformRandomVariable> m_automatic;  //!< Automatically allocated stream.
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Run replications in worker processes")
+{
+}
+
+void
+ReplicationRunnerTestCase::Draw (void)
+{
+  std::ofstream values ("values.txt");
+  values << std::setprecision (17) << m_fixed->GetValue () << " " << m_automatic->GetValue () << std::endl;
+}
+
+void
+ReplicationRunnerTestCase::Prepare (uint64_t run)
+{
+  std::cout << "run " << run << std::endl;
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+
+  m_fixed = CreateObject<UniformRandomVariable> ();
+  m_fixed->SetStream (7);
+  m_automatic = CreateObject<UniformRandomVariable> ();
+  Simulator::Schedule (Seconds (1), &ReplicationRunnerTestCase::Draw, this);
+
+  std::string directory = CreateTempDirFilename ("replications");
+  ReplicationRunner runner;
+  runner.SetResultsDirectory (directory);
+  runner.SetMaxWorkers (2);
+  runner.SetPrepareCallback (MakeCallback (&ReplicationRunnerTestCase::Prepare, this));
+  uint32_t failures = runner.Run (3, 4);
+  NS_TEST_ASSERT_MSG_EQ (failures, 0, "Some runs failed");
+
+  std::set<double> automatic;
+  for (uint64_t r = 3; r < 7; ++r)
+    {
+      std::string runDirectory = runner.GetRunDirectory (r);
+      std::ifstream values (SystemPath::Append (runDirectory, "values.txt").c_str ());
+      double fixedValue = -1;
+      double automaticValue = -1;
+      values >> fixedValue >> automaticValue;
+      NS_TEST_ASSERT_MSG_EQ_TOL (fixedValue, FirstValue (7, r), 1e-15, "Wrong value for run " << r);
+      automatic.insert (automaticValue);
+
+      std::ifstream output (SystemPath::Append (runDirectory, "stdout.txt").c_str ());
+      std::string line;
+      std::getline (output, line);
+      NS_TEST_ASSERT_MSG_EQ (line, "run " + std::to_string (r), "Wrong output for run " << r);
+    }
+  NS_TEST_ASSERT_MSG_EQ (automatic.size (), 4, "Runs drew the same values");
+
+  std::ifstream summary (SystemPath::Append (directory, "runs.txt").c_str ());
+  uint32_t lines = 0;
+  std::string line;
+  while (std::getline (summary, line))
+    {
+      NS_TEST_ASSERT_MSG_EQ (line.substr (line.find (' ')), " exit 0", "Wrong summary line " << line);
+      ++lines;
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines, 4, "Wrong number of runs in the summary");
+
+  // The simulation and the run number of this process are left as they were.
+  NS_TEST_ASSERT_MSG_EQ (RngSeedManager::GetRun (), run, "Changed the run number");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (0), "The simulation ran");
+  Simulator::Destroy ();
+  m_fixed = 0;
+  m_automatic = 0;
+}
+
+/**
+ * \ingroup tests
+ * Draw a random value while building the scenario, and check that the
+ * replications do not draw the values of a program building the scenario
+ * with their run number.
+ */
+class ReplicationRunnerSetupDrawTestCase : public TestCase
+{
+public:
+  ReplicationRunnerSetupDrawTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Write the value drawn during the setup and the one drawn during the
+   * run, in a worker.
+   */
+  void Draw (void);
+
+  Ptr<UniformRandomVariable> m_fixed;  //!< Random variable of stream 7.
+  double m_setup;                      //!< The value drawn during the setup.
+};
+
+ReplicationRunnerSetupDrawTestCase::ReplicationRunnerSetupDrawTestCase ()
+  : TestCase ("Draw a random value before running the replications")
+{
+}
+
+void
+ReplicationRunnerSetupDrawTestCase::Draw (void)
+{
+  std::ofstream values ("values.txt");
+  values << std::setprecision (17) << m_setup << " " << m_fixed->GetValue () << std::endl;
+}
+
+void
+ReplicationRunnerSetupDrawTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+
+  // as a random position allocator would, while building the scenario
+  m_fixed = CreateObject<UniformRandomVariable> ();
+  m_fixed->SetStream (7);
+  m_setup = m_fixed->GetValue ();
+  Simulator::Schedule (Seconds (1), &ReplicationRunnerSetupDrawTestCase::Draw, this);
+
+  std::string directory = CreateTempDirFilename ("replications");
+  ReplicationRunner runner;
+  runner.SetResultsDirectory (directory);
+  runner.SetMaxWorkers (2);
+  uint32_t failures = runner.Run (3, 2);
+  NS_TEST_ASSERT_MSG_EQ (failures, 0, "Some runs failed");
+
+  for (uint64_t r = 3; r < 5; ++r)
+    {
+      std::string runDirectory = runner.GetRunDirectory (r);
+      std::ifstream values (SystemPath::Append (runDirectory, "values.txt").c_str ());
+      double setupValue = -1;
+      double runValue = -1;
+      values >> setupValue >> runValue;
+      // The setup is that of the run number of this process, in all the
+      // replications, and the variable starts over instead of drawing
+      // the value which follows the setup of run r.
+      NS_TEST_ASSERT_MSG_EQ_TOL (setupValue, FirstValue (7, run), 1e-15, "Setup value of run " << r);
+      NS_TEST_ASSERT_MSG_EQ_TOL (runValue, FirstValue (7, r), 1e-15, "Value drawn by run " << r);
+      double second = SecondValue (7, r);
+      NS_TEST_ASSERT_MSG_NE (runValue, second, "Run " << r << " drew the value following its setup");
+    }
+
+  Simulator::Destroy ();
+  m_fixed = 0;
+}
+
+/**
+ * \ingroup tests
+ * The ReplicationRunner test suite.
+ */
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ();
+};
+
+ReplicationRunnerTestSuite::ReplicationRunnerTestSuite ()
+  : TestSuite ("replication-runner", UNIT)
+{
+  AddTestCase (new RandomVariableResetTestCase, TestCase::QUICK);
+  AddTestCase (new ReplicationRunnerTestCase, TestCase::QUICK);
+  AddTestCase (new ReplicationRunnerSetupDrawTestCase, TestCase::QUICK);
+}
+
+static ReplicationRunnerTestSuite g_replicationRunnerTestSuite; //!< The test suite
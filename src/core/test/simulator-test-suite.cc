@@ -19,10 +19,16 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-impl.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+
+#include <set>
 
 using namespace ns3;
 
@@ -459,6 +465,192 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  /**
+   * Hold-model run: insert a population, then repeatedly remove the
+   * earliest event and insert a later one, cancelling some events on
+   * the way, and check the order against a reference set.
+   *
+   * \param [in] delay The stream of event delays.
+   * \param [in] name The name of the delay distribution.
+   */
+  void RunDistribution (Ptr<RandomVariableStream> delay, std::string name);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check event ordering and removal with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::RunDistribution (Ptr<RandomVariableStream> delay, std::string name)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> coin = CreateObject<UniformRandomVariable> ();
+  std::set<Scheduler::EventKey> reference;
+  uint32_t uid = 0;
+  uint64_t now = 0;
+
+  for (uint32_t i = 0; i < 10000; ++i)
+    {
+      if (i < 2000 || coin->GetValue () < 0.5)
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + (uint64_t)delay->GetValue ();
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference.insert (ev.key);
+        }
+      if (reference.empty ())
+        {
+          continue;
+        }
+      if (coin->GetValue () < 0.1)
+        {
+          // cancel a random pending event
+          std::set<Scheduler::EventKey>::iterator j = reference.begin ();
+          std::advance (j, coin->GetInteger (0, reference.size () - 1));
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key = *j;
+          scheduler->Remove (ev);
+          reference.erase (j);
+        }
+      else
+        {
+          Scheduler::Event next = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, reference.begin ()->m_uid,
+                                 "Bad event order with " << name << " delays");
+          now = next.key.m_ts;
+          reference.erase (reference.begin ());
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), reference.empty (),
+                             "Bad event count with " << name << " delays");
+    }
+  while (!reference.empty ())
+    {
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, reference.begin ()->m_uid,
+                             "Bad event order with " << name << " delays");
+      reference.erase (reference.begin ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true,
+                         "Scheduler not empty with " << name << " delays");
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  exponential->SetAttribute ("Mean", DoubleValue (100));
+  RunDistribution (exponential, "exponential");
+
+  // many simultaneous events
+  Ptr<UniformRandomVariable> narrow = CreateObject<UniformRandomVariable> ();
+  narrow->SetAttribute ("Min", DoubleValue (0));
+  narrow->SetAttribute ("Max", DoubleValue (3));
+  RunDistribution (narrow, "narrow");
+
+  // a few events far in the future among many close ones
+  Ptr<ParetoRandomVariable> pareto = CreateObject<ParetoRandomVariable> ();
+  pareto->SetAttribute ("Mean", DoubleValue (1000));
+  pareto->SetAttribute ("Shape", DoubleValue (1.1));
+  RunDistribution (pareto, "pareto");
+}
+
+class EventImplPoolTestCase : public TestCase
+{
+public:
+  EventImplPoolTestCase ();
+  virtual void DoRun (void);
+  /** An event argument too large for the pooled size classes. */
+  struct Large
+  {
+    uint8_t data[1024];  //!< Payload.
+  };
+  void Hop (uint32_t left);
+  void Sink (Large large);
+  /**
+   * Sum the statistics of all the pooled size classes.
+   *
+   * \param [in] stats The statistics of each size class.
+   * \returns The sums, with blockSize set to 0.
+   */
+  static EventImpl::PoolStats Sum (std::vector<EventImpl::PoolStats> stats);
+};
+
+EventImplPoolTestCase::EventImplPoolTestCase ()
+  : TestCase ("Check that events are recycled through the event pool")
+{
+}
+
+void
+EventImplPoolTestCase::Hop (uint32_t left)
+{
+  if (left > 0)
+    {
+      Simulator::Schedule (NanoSeconds (1), &EventImplPoolTestCase::Hop, this, left - 1);
+    }
+}
+
+void
+EventImplPoolTestCase::Sink (Large large)
+{
+}
+
+EventImpl::PoolStats
+EventImplPoolTestCase::Sum (std::vector<EventImpl::PoolStats> stats)
+{
+  EventImpl::PoolStats sum = { 0, 0, 0, 0, 0 };
+  for (std::vector<EventImpl::PoolStats>::const_iterator i = stats.begin (); i != stats.end (); ++i)
+    {
+      if (i->blockSize != 0)
+        {
+          sum.allocations += i->allocations;
+          sum.recycled += i->recycled;
+          sum.releases += i->releases;
+          sum.pooled += i->pooled;
+        }
+    }
+  return sum;
+}
+
+void
+EventImplPoolTestCase::DoRun (void)
+{
+  std::vector<EventImpl::PoolStats> before = EventImpl::GetPoolStats ();
+  EventImpl::PoolStats pooledBefore = Sum (before);
+
+  Simulator::Schedule (NanoSeconds (1), &EventImplPoolTestCase::Hop, this, 1000);
+  Large large = Large ();
+  Simulator::Schedule (NanoSeconds (1), &EventImplPoolTestCase::Sink, this, large);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<EventImpl::PoolStats> after = EventImpl::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (after.size (), before.size (), "Missing pool statistics");
+  EventImpl::PoolStats pooledAfter = Sum (after);
+
+  uint64_t allocations = pooledAfter.allocations - pooledBefore.allocations;
+  uint64_t releases = pooledAfter.releases - pooledBefore.releases;
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (allocations, 1001, "Events were not allocated from the pool");
+  NS_TEST_EXPECT_MSG_EQ (allocations, releases, "Events leaked from the pool");
+  NS_TEST_EXPECT_MSG_GT (pooledAfter.recycled - pooledBefore.recycled, 999,
+                         "Events were not recycled");
+  NS_TEST_EXPECT_MSG_EQ (after.back ().blockSize, 0, "Oversized events not reported last");
+  NS_TEST_EXPECT_MSG_EQ (after.back ().allocations - before.back ().allocations, 1,
+                         "Oversized event not counted");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +667,20 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new EventImplPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -23,9 +23,12 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
 
 #include <ctime>
 #include <list>
@@ -225,6 +228,170 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class ThreadedSimulatorOrderTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorOrderTestCase (unsigned int threads, uint32_t events, bool duringRun);
+  void Receive (unsigned int threadno, uint32_t seq);
+  void Poll (void);
+  static void SchedulingThread (std::pair<ThreadedSimulatorOrderTestCase *, unsigned int> context);
+  unsigned int m_threads;
+  uint32_t m_events;
+  bool m_duringRun;
+  uint32_t m_next[MAXTHREADS];
+  uint32_t m_received;
+  std::string m_error;
+  std::list<Ptr<SystemThread> > m_threadlist;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedSimulatorOrderTestCase::ThreadedSimulatorOrderTestCase (unsigned int threads, uint32_t events, bool duringRun)
+  : TestCase (std::string ("Check that events scheduled from other threads keep their order ") +
+              (duringRun ? "during the run" : "before the run")),
+    m_threads (threads),
+    m_events (events),
+    m_duringRun (duringRun)
+{
+}
+
+void
+ThreadedSimulatorOrderTestCase::SchedulingThread (std::pair<ThreadedSimulatorOrderTestCase *, unsigned int> context)
+{
+  ThreadedSimulatorOrderTestCase *me = context.first;
+  unsigned int threadno = context.second;
+
+  for (uint32_t i = 0; i < me->m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (threadno, Seconds (0),
+                                      &ThreadedSimulatorOrderTestCase::Receive, me, threadno, i);
+    }
+}
+
+void
+ThreadedSimulatorOrderTestCase::Receive (unsigned int threadno, uint32_t seq)
+{
+  if (seq != m_next[threadno])
+    {
+      m_error = "Events from one thread were reordered";
+    }
+  m_next[threadno] = seq + 1;
+  ++m_received;
+}
+
+void
+ThreadedSimulatorOrderTestCase::Poll (void)
+{
+  if (m_received < m_threads * m_events)
+    {
+      Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::Poll, this);
+    }
+}
+
+void
+ThreadedSimulatorOrderTestCase::DoRun (void)
+{
+  m_received = 0;
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      m_next[i] = 0;
+      m_threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+            &ThreadedSimulatorOrderTestCase::SchedulingThread,
+                std::pair<ThreadedSimulatorOrderTestCase *, unsigned int> (this, i) )) );
+    }
+
+  // make sure the simulator main thread is this one
+  Simulator::Schedule (MicroSeconds (1), &ThreadedSimulatorOrderTestCase::Poll, this);
+
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  if (!m_duringRun)
+    {
+      for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+        {
+          (*it)->Join ();
+        }
+    }
+
+  Simulator::Run ();
+
+  if (m_duringRun)
+    {
+      for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+        {
+          (*it)->Join ();
+        }
+    }
+  Simulator::Destroy ();
+  m_threadlist.clear ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_error.empty (), true, m_error.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_threads * m_events, "Lost events scheduled from other threads");
+}
+
+// Random variables created and destroyed by several threads, while the
+// main thread restarts them, must each get their own automatic stream.
+class ThreadedRandomVariableTestCase : public TestCase
+{
+public:
+  ThreadedRandomVariableTestCase (unsigned int threads, uint32_t variables);
+  static void CreatingThread (ThreadedRandomVariableTestCase *me);
+  unsigned int m_threads;
+  uint32_t m_variables;
+  std::list<Ptr<SystemThread> > m_threadlist;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedRandomVariableTestCase::ThreadedRandomVariableTestCase (unsigned int threads, uint32_t variables)
+  : TestCase ("Check that random variables can be created by several threads"),
+    m_threads (threads),
+    m_variables (variables)
+{
+}
+
+void
+ThreadedRandomVariableTestCase::CreatingThread (ThreadedRandomVariableTestCase *me)
+{
+  for (uint32_t i = 0; i < me->m_variables; ++i)
+    {
+      Ptr<UniformRandomVariable> variable = CreateObject<UniformRandomVariable> ();
+      variable->GetValue ();
+    }
+}
+
+void
+ThreadedRandomVariableTestCase::DoRun (void)
+{
+  uint64_t first = RngSeedManager::GetNextStreamIndex ();
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      m_threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (&ThreadedRandomVariableTestCase::CreatingThread, this)));
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  for (uint32_t i = 0; i < m_variables; ++i)
+    {
+      RandomVariableStream::ResetAll ();
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  m_threadlist.clear ();
+
+  uint64_t last = RngSeedManager::GetNextStreamIndex ();
+  NS_TEST_EXPECT_MSG_EQ (last - first - 1, m_threads * m_variables, "Some random variables got the same stream");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +408,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +430,9 @@ public:
               }
           }
       }
+    // more events than the lock-free ring holds, to exercise the overflow
+    AddTestCase (new ThreadedSimulatorOrderTestCase (4, 10000, false), TestCase::QUICK);
+    AddTestCase (new ThreadedSimulatorOrderTestCase (4, 10000, true), TestCase::QUICK);
+    AddTestCase (new ThreadedRandomVariableTestCase (4, 20000), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
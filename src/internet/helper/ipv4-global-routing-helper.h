@@ -82,6 +82,9 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * If the GlobalRoutingIncrementalSpf global value is true, only the
+   * routes of the routers affected by the changes of the topology are
+   * recomputed.
    */
   static void RecomputeRoutingTables (void);
 private:
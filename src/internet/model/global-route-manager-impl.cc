@@ -27,6 +27,7 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -35,6 +36,14 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -44,6 +53,27 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * The number of threads computing the SPF trees of the routers.
+ */
+static GlobalValue g_spfThreads = GlobalValue
+  ("GlobalRoutingSpfThreads",
+   "The number of threads used to compute the global routes",
+   UintegerValue (1),
+   MakeUintegerChecker<uint32_t> (1));
+
+/**
+ * \ingroup globalrouting
+ * Whether GlobalRouteManager::RecomputeRoutes only recomputes the routes
+ * of the routers affected by the changes of the topology.
+ */
+static GlobalValue g_incrementalSpf = GlobalValue
+  ("GlobalRoutingIncrementalSpf",
+   "Only recompute the global routes of the routers affected by a change of the topology",
+   BooleanValue (false),
+   MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -446,6 +476,9 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_lsas.clear ();
+  m_lsaIndexes.clear ();
+  m_linkDataIndex.clear ();
 }
 
 void
@@ -470,7 +503,31 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      if (!m_database.insert (LSDBPair_t (addr, lsa)).second)
+        {
+          return;
+        }
+      m_lsaIndexes[lsa] = m_lsas.size ();
+      m_lsas.push_back (lsa);
+//
+// Index the LSA by the link data of its TransitNetwork records.  If several
+// LSAs have the same link data, keep the first one in the order of the
+// database, which is the one GetLSAByLinkData () used to find.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<LSDBMap_t::iterator, bool> i =
+            m_linkDataIndex.insert (LSDBPair_t (lr->GetLinkData (), lsa));
+          if (!i.second && addr < i.first->second->GetLinkStateId ())
+            {
+              i.first->second = lsa;
+            }
+        }
     }
 }
 
@@ -495,13 +552,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -511,26 +565,39 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of its TransitNetwork records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return i->second;
     }
   return 0;
 }
 
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsas.size ();
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_lsas.at (index);
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetLSAIndex (GlobalRoutingLSA* lsa) const
+{
+  NS_LOG_FUNCTION (this << lsa);
+  std::map<GlobalRoutingLSA*, uint32_t>::const_iterator i = m_lsaIndexes.find (lsa);
+  NS_ASSERT_MSG (i != m_lsaIndexes.end (), "LSA not in the database");
+  return i->second;
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,7 +606,11 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfrootIpv4 (0),
+    m_spfrootRouting (0),
+    m_nNodes (0),
+    m_rootQueue (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -572,25 +643,7 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
-        {
-          continue;
-        }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteNodeRoutes (*i);
     }
   if (m_lsdb)
     {
@@ -600,6 +653,30 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteNodeRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  if (router == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -700,6 +777,7 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  SPFRoots_t roots;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -711,9 +789,8 @@ GlobalRouteManagerImpl::InitializeRoutes ()
       Ptr<GlobalRouter> rtr = 
         node->GetObject<GlobalRouter> ();
 
-      uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      // Ignore nodes that are not simulated by this process (distributed sim)
+      if (!MpiInterface::IsLocal (node->GetSystemId ()))
         {
           continue;
         }
@@ -724,12 +801,494 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (MakeSPFRoot (rtr->GetRouterId (), node));
         }
     }
+  SPFCalculateRoots (roots);
   NS_LOG_INFO ("Finished SPF calculation");
 }
 
+/**
+ * \ingroup globalrouting
+ * The SPF computations left to run, shared by the threads running them.
+ */
+struct GlobalRouteManagerImpl::SPFRootQueue
+{
+  const SPFRoots_t *roots; //!< the roots of the computations
+  uint32_t next;           //!< the index of the next root to compute
+#ifdef HAVE_PTHREAD_H
+  SystemMutex mutex;       //!< protects next
+#endif
+};
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots (const SPFRoots_t &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  UintegerValue nThreads;
+  g_spfThreads.GetValue (nThreads);
+  m_nNodes = NodeList::GetNNodes ();
+#ifdef HAVE_PTHREAD_H
+  uint32_t n = std::min<uint64_t> (nThreads.Get (), roots.size ());
+  if (n > 1)
+    {
+      NS_LOG_INFO ("Computing " << roots.size () << " SPF trees with " << n << " threads");
+      SPFRootQueue queue;
+      queue.roots = &roots;
+      queue.next = 0;
+//
+// Each worker has its own SPF state, but shares the Link State Database,
+// which is not modified while the routes are computed.  The routes of a
+// router are only written by the thread computing its SPF tree.
+//
+      std::vector<GlobalRouteManagerImpl *> workers;
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 1; i < n; i++)
+        {
+          GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+          delete worker->m_lsdb;
+          worker->m_lsdb = m_lsdb;
+          worker->m_nNodes = m_nNodes;
+          worker->m_rootQueue = &queue;
+          workers.push_back (worker);
+          threads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateQueuedRoots, worker)));
+          threads.back ()->Start ();
+        }
+      m_rootQueue = &queue;
+      SPFCalculateQueuedRoots ();
+      m_rootQueue = 0;
+      for (uint32_t i = 0; i < threads.size (); i++)
+        {
+          threads[i]->Join ();
+          workers[i]->m_lsdb = 0;
+          delete workers[i];
+        }
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  for (SPFRoots_t::const_iterator i = roots.begin (); i != roots.end (); i++)
+    {
+      SPFCalculate (*i);
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateQueuedRoots (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  for (;;)
+    {
+      uint32_t i;
+      {
+        CriticalSection cs (m_rootQueue->mutex);
+        if (m_rootQueue->next == m_rootQueue->roots->size ())
+          {
+            return;
+          }
+        i = m_rootQueue->next++;
+      }
+      SPFCalculate ((*m_rootQueue->roots)[i]);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+Ptr<Node>
+GlobalRouteManagerImpl::FindRouterNode (Ipv4Address routerId)
+{
+  NS_LOG_FUNCTION (routerId);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == routerId)
+        {
+          return *i;
+        }
+    }
+  NS_LOG_LOGIC ("Can't find the node of router " << routerId);
+  return 0;
+}
+
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::MakeSPFRoot (Ipv4Address routerId, Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (routerId << node);
+  SPFRoot root;
+  root.routerId = routerId;
+  root.ipv4 = 0;
+  root.routing = 0;
+  if (node != 0)
+    {
+      root.ipv4 = PeekPointer (node->GetObject<Ipv4> ());
+      NS_ASSERT_MSG (root.ipv4,
+                     "GlobalRouteManagerImpl::MakeSPFRoot (): "
+                     "GetObject for <Ipv4> interface failed");
+      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+      NS_ASSERT (router);
+      root.routing = PeekPointer (router->GetRoutingProtocol ());
+      NS_ASSERT (root.routing);
+    }
+  return root;
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetSPFStatus (GlobalRoutingLSA* lsa) const
+{
+  return m_spfStatus[m_lsdb->GetLSAIndex (lsa)];
+}
+
+void
+GlobalRouteManagerImpl::SetSPFStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_spfStatus[m_lsdb->GetLSAIndex (lsa)] = status;
+}
+
+/**
+ * \ingroup globalrouting
+ * Container: for each LSA of an LSDB, by index, the index of the LSAs
+ * with a link to it and the metric of the link.
+ */
+typedef std::vector<std::vector<std::pair<uint32_t, uint32_t> > > SPFLinks_t;
+
+/**
+ * \ingroup globalrouting
+ * Find the links followed by the SPF computation between the Router and
+ * Network LSAs of an LSDB.
+ *
+ * \param [in] lsdb the LSDB
+ * \param [out] links the links, indexed by the LSA they lead to
+ */
+static void
+GetReverseLinks (const GlobalRouteManagerLSDB &lsdb, SPFLinks_t &links)
+{
+  links.assign (lsdb.GetNumLSAs (), SPFLinks_t::value_type ());
+  for (uint32_t i = 0; i < lsdb.GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *lsa = lsdb.GetLSAByIndex (i);
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint
+                  && l->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  continue;
+                }
+              GlobalRoutingLSA *w = lsdb.GetLSA (l->GetLinkId ());
+              if (w != 0)
+                {
+                  links[lsdb.GetLSAIndex (w)].push_back (std::make_pair (i, l->GetMetric ()));
+                }
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              GlobalRoutingLSA *w = lsdb.GetLSAByLinkData (lsa->GetAttachedRouter (j));
+              if (w != 0)
+                {
+                  links[lsdb.GetLSAIndex (w)].push_back (std::make_pair (i, 0));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup globalrouting
+ * Compute the distance from every LSA of an LSDB to an LSA.
+ *
+ * \param [in] links the reverse links of the LSDB
+ * \param [in] target the index of the LSA
+ * \param [out] distances the distances, by index, or the maximum value if
+ *              the target cannot be reached
+ */
+static void
+GetDistancesTo (const SPFLinks_t &links, uint32_t target, std::vector<uint64_t> &distances)
+{
+  typedef std::pair<uint64_t, uint32_t> Item;
+  distances.assign (links.size (), std::numeric_limits<uint64_t>::max ());
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item> > queue;
+  distances[target] = 0;
+  queue.push (Item (0, target));
+  while (!queue.empty ())
+    {
+      Item item = queue.top ();
+      queue.pop ();
+      if (item.first > distances[item.second])
+        {
+          continue;
+        }
+      const SPFLinks_t::value_type &in = links[item.second];
+      for (SPFLinks_t::value_type::const_iterator i = in.begin (); i != in.end (); i++)
+        {
+          uint64_t distance = item.first + i->second;
+          if (distance < distances[i->first])
+            {
+              distances[i->first] = distance;
+              queue.push (Item (distance, i->first));
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup globalrouting
+ * Find the LSAs of an LSDB from which some LSAs can be reached.
+ *
+ * \param [in] links the reverse links of the LSDB
+ * \param [in] targets the indexes of the LSAs to reach
+ * \param [out] reaching whether each LSA can reach one of the targets
+ */
+static void
+GetReachingLSAs (const SPFLinks_t &links, const std::vector<uint32_t> &targets,
+                 std::vector<bool> &reaching)
+{
+  reaching.assign (links.size (), false);
+  std::vector<uint32_t> stack;
+  for (std::vector<uint32_t>::const_iterator i = targets.begin (); i != targets.end (); i++)
+    {
+      if (!reaching[*i])
+        {
+          reaching[*i] = true;
+          stack.push_back (*i);
+        }
+    }
+  while (!stack.empty ())
+    {
+      uint32_t v = stack.back ();
+      stack.pop_back ();
+      for (SPFLinks_t::value_type::const_iterator i = links[v].begin (); i != links[v].end (); i++)
+        {
+          if (!reaching[i->first])
+            {
+              reaching[i->first] = true;
+              stack.push_back (i->first);
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup globalrouting
+ * Compare two Link State Advertisements.
+ *
+ * \param a the first LSA
+ * \param b the second LSA
+ * \param compareMetrics whether to compare the metrics of the link records
+ * \returns true if the LSAs are the same
+ */
+static bool
+IsSameLSA (GlobalRoutingLSA *a, GlobalRoutingLSA *b, bool compareMetrics)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ()
+      || a->GetNode () != b->GetNode ())
+    {
+      return false;
+    }
+  for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (j);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (j);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || (compareMetrics && la->GetMetric () != lb->GetMetric ()))
+        {
+          return false;
+        }
+    }
+  for (uint32_t j = 0; j < a->GetNAttachedRouters (); j++)
+    {
+      if (a->GetAttachedRouter (j) != b->GetAttachedRouter (j))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+GlobalRouteManagerImpl::FindAffectedRouters (const GlobalRouteManagerLSDB &oldLsdb,
+                                             std::set<Ipv4Address> &routers) const
+{
+  NS_LOG_FUNCTION (this << &oldLsdb);
+//
+// The external routes are added for every router: any change of the
+// External LSAs affects all the routers.
+//
+  if (oldLsdb.GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ())
+    {
+      return true;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      if (!IsSameLSA (oldLsdb.GetExtLSA (i), m_lsdb->GetExtLSA (i), true))
+        {
+          return true;
+        }
+    }
+//
+// Sort the LSAs which changed.  The routes of a router depend on the
+// content of all the LSAs it can reach, so an LSA whose link records
+// changed affects all the routers which could reach it, or can now.  An
+// LSA where only the metrics of some links changed does not change the
+// routes of a router if neither the previous nor the new metric makes one
+// of these links part of its shortest paths.
+//
+  std::vector<uint32_t> oldChanged;
+  std::vector<uint32_t> newChanged;
+  std::vector<std::pair<std::pair<uint32_t, uint32_t>, uint32_t> > metricChanges;
+  for (uint32_t i = 0; i < oldLsdb.GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *o = oldLsdb.GetLSAByIndex (i);
+      GlobalRoutingLSA *n = m_lsdb->GetLSA (o->GetLinkStateId ());
+      if (n == 0)
+        {
+          oldChanged.push_back (i);
+        }
+      else if (IsSameLSA (o, n, false))
+        {
+          for (uint32_t j = 0; j < o->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *lo = o->GetLinkRecord (j);
+              GlobalRoutingLinkRecord *ln = n->GetLinkRecord (j);
+              GlobalRoutingLSA *w = oldLsdb.GetLSA (lo->GetLinkId ());
+              if (lo->GetMetric () != ln->GetMetric () && w != 0
+                  && (lo->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                      || lo->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork))
+                {
+                  uint32_t metric = std::min (lo->GetMetric (), ln->GetMetric ());
+                  metricChanges.push_back (std::make_pair (std::make_pair (i, oldLsdb.GetLSAIndex (w)), metric));
+                }
+            }
+        }
+      else
+        {
+          oldChanged.push_back (i);
+          newChanged.push_back (m_lsdb->GetLSAIndex (n));
+        }
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumLSAs (); i++)
+    {
+      if (oldLsdb.GetLSA (m_lsdb->GetLSAByIndex (i)->GetLinkStateId ()) == 0)
+        {
+          newChanged.push_back (i);
+        }
+    }
+  NS_LOG_LOGIC (oldChanged.size () << " previous and " << newChanged.size () <<
+                " new LSAs changed, " << metricChanges.size () << " metrics changed");
+
+  SPFLinks_t oldLinks;
+  GetReverseLinks (oldLsdb, oldLinks);
+  std::vector<bool> reaching;
+  GetReachingLSAs (oldLinks, oldChanged, reaching);
+  for (uint32_t i = 0; i < oldLsdb.GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA *lsa = oldLsdb.GetLSAByIndex (i);
+      if (reaching[i] && lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          routers.insert (lsa->GetLinkStateId ());
+        }
+    }
+  if (!newChanged.empty ())
+    {
+      SPFLinks_t newLinks;
+      GetReverseLinks (*m_lsdb, newLinks);
+      GetReachingLSAs (newLinks, newChanged, reaching);
+      for (uint32_t i = 0; i < m_lsdb->GetNumLSAs (); i++)
+        {
+          GlobalRoutingLSA *lsa = m_lsdb->GetLSAByIndex (i);
+          if (reaching[i] && lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+            {
+              routers.insert (lsa->GetLinkStateId ());
+            }
+        }
+    }
+//
+// A link from v to w is part of a shortest path of router r if
+// d(r, v) + metric = d(r, w).  If this does not hold with the lower of the
+// previous and the new metric, the distances from r are the same with
+// both metrics, and so are its shortest paths.
+//
+  std::map<uint32_t, std::vector<uint64_t> > distances;
+  for (uint32_t c = 0; c < metricChanges.size (); c++)
+    {
+      uint32_t v = metricChanges[c].first.first;
+      uint32_t w = metricChanges[c].first.second;
+      if (distances.find (v) == distances.end ())
+        {
+          GetDistancesTo (oldLinks, v, distances[v]);
+        }
+      if (distances.find (w) == distances.end ())
+        {
+          GetDistancesTo (oldLinks, w, distances[w]);
+        }
+      const std::vector<uint64_t> &toV = distances[v];
+      const std::vector<uint64_t> &toW = distances[w];
+      for (uint32_t i = 0; i < oldLsdb.GetNumLSAs (); i++)
+        {
+          GlobalRoutingLSA *lsa = oldLsdb.GetLSAByIndex (i);
+          if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA
+              && toV[i] != std::numeric_limits<uint64_t>::max ()
+              && toV[i] + metricChanges[c].second <= toW[i])
+            {
+              routers.insert (lsa->GetLinkStateId ());
+            }
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_incrementalSpf.GetValue (incremental);
+  if (!incremental.Get () || m_lsdb == 0 || m_lsdb->GetNumLSAs () == 0)
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::set<Ipv4Address> routers;
+  bool all = FindAffectedRouters (*oldLsdb, routers);
+  delete oldLsdb;
+  NS_LOG_INFO ("Recomputing the routes of " << (all ? "all the" : "the affected") << " routers");
+
+  SPFRoots_t roots;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0 || (!all && routers.find (rtr->GetRouterId ()) == routers.end ()))
+        {
+          continue;
+        }
+      DeleteNodeRoutes (node);
+      if (MpiInterface::IsLocal (node->GetSystemId ()) && rtr->GetNumLSAs ())
+        {
+          roots.push_back (MakeSPFRoot (rtr->GetRouterId (), node));
+        }
+    }
+  SPFCalculateRoots (roots);
+}
+
 //
 // This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
 // 16.1 (2) for further details.
@@ -836,7 +1395,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (GetSPFStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1420,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (GetSPFStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -873,7 +1432,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
           w = new SPFVertex (w_lsa);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              SetSPFStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1447,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (GetSPFStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -1122,9 +1681,11 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
                             " via outgoing interface " << outIf);
             }
         }
-      else 
+      else
         {
-          w->SetRootExitDirection (v->GetRootExitDirection ());
+// The network may be reached from the root through several equal cost
+// paths: the router behind it inherits all of them.
+          w->InheritAllRootExitDirections (v);
         }
     }
   else 
@@ -1320,11 +1881,8 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                  NS_ASSERT (m_spfrootRouting);
+                  m_spfrootRouting->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
@@ -1337,17 +1895,33 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
   return false;
 }
 
-// quagga ospf_spf_calculate
 void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  m_nNodes = NodeList::GetNNodes ();
+  SPFCalculate (MakeSPFRoot (root, FindRouterNode (root)));
+}
+
+// quagga ospf_spf_calculate
+void
+GlobalRouteManagerImpl::SPFCalculate (const SPFRoot &spfRoot)
+{
+  Ipv4Address root = spfRoot.routerId;
+  NS_LOG_FUNCTION (this << root);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the status of the Link State Advertisements.  The status is
+// kept here rather than in the Link State Database, so that several SPF
+// calculations may share the database.
+//
+  m_spfStatus.assign (m_lsdb->GetNumLSAs (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+//
+// The routes are only written to the routing protocol of the root.
 //
-  m_lsdb->Initialize ();
+  m_spfrootIpv4 = spfRoot.ipv4;
+  m_spfrootRouting = spfRoot.routing;
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +1941,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetSPFStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +1951,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_nNodes > 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootIpv4 = 0;
+      m_spfrootRouting = 0;
       return;
     }
 
@@ -1428,7 +2005,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      SetSPFStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1502,6 +2079,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootIpv4 = 0;
+  m_spfrootRouting = 0;
 }
 
 void
@@ -1560,108 +2139,57 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
+// The routing protocol of the node corresponding to the root vertex was
+// found when the computation started.  This is the one we're going to write
 // the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for router " << routerId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
+// adding the routes to.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 //
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
+// The vertex <v> (corresponding to the router advertising the external
+// route) has the next hop addresses and the outbound interfaces to which the
+// root node should send packets to be forwarded to the external network.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+// walk through all next-hop-IPs and out-going-interfaces for reaching
+// the stub network gateway 'v' from the root node
+//
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          m_spfrootRouting->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
-
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
@@ -1729,107 +2257,57 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
+// The routing protocol of the node corresponding to the root vertex was
+// found when the computation started.  This is the one we're going to write
 // the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for router " << routerId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
+// adding the routes to.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
+// We're going to add a network route to the stub network found in the link
+// record.  The vertex <v> (corresponding to the node that has this stub
+// network) has the next hop addresses precalculated for us, to which the
+// root node should send packets to be forwarded to this network, and the
+// outbound interfaces to send them to.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+// walk through all next-hop-IPs and out-going-interfaces for reaching
+// the stub network gateway 'v' from the root node
+//
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          m_spfrootRouting->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1844,70 +2322,27 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// We have an IP address <a> and the Ipv4 interface of the node at the root
+// of the SPF tree, which was found when the computation started.  Look
+// through the interfaces on this node for one that has the IP address we're
+// looking for.  If we find one, return the corresponding interface index,
+// or -1 if not found.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootIpv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << m_spfroot->GetVertexId ());
+      return -1;
+    }
+  int32_t interface = m_spfrootIpv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1944,60 +2379,28 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
+// The routing protocol of the node corresponding to the root vertex was
+// found when the computation started.  This is the one we're going to write
 // the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("Setting routes for router " << routerId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2409,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,46 +2434,35 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
-            }
-//
-// Done adding the routes for the selected node.
+// walk through all available exit directions due to ECMP,
+// and add host route for each of the exit direction toward
+// the vertex 'v'
 //
-          return;
-        }
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              m_spfrootRouting->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                                outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
+            }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 {
@@ -2089,95 +2481,54 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
+// The routing protocol of the node corresponding to the root vertex was
+// found when the computation started.  This is the one we're going to write
 // the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_LOG_LOGIC ("setting routes for router " << routerId);
 //
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 //
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
+// walk through all available exit directions due to ECMP,
+// and add host route for each of the exit direction toward
+// the vertex 'v'
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          m_spfrootRouting->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
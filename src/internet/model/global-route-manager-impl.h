@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -37,6 +38,7 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -674,6 +676,32 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the number of Router and Network Link State Advertisements.
+   *
+   * @returns the number of Link State Advertisements, not counting the
+   * External Link State Advertisements.
+   */
+  uint32_t GetNumLSAs () const;
+  /**
+   * @brief Look up a Router or Network Link State Advertisement by index.
+   *
+   * @param index the index of the LSA, between 0 and GetNumLSAs () - 1
+   * @returns A pointer to the Link State Advertisement.
+   */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+  /**
+   * @brief Get the index of a Router or Network Link State Advertisement.
+   *
+   * The LSAs are indexed in the order they were inserted.  The index allows
+   * the SPF computations to keep their state outside of the database, which
+   * is not modified while the routes are computed.
+   *
+   * @param lsa A pointer to a Link State Advertisement of the database.
+   * @returns the index of the LSA.
+   */
+  uint32_t GetLSAIndex (GlobalRoutingLSA* lsa) const;
+
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +709,9 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< Router and Network Link State Advertisements, by index
+  std::map<GlobalRoutingLSA*, uint32_t> m_lsaIndexes; //!< index of each Link State Advertisement
+  LSDBMap_t m_linkDataIndex; //!< Link State Advertisements, by link data of their TransitNetwork records
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -735,6 +766,17 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology
+ *
+ * By default, this deletes all the routes, builds a new routing database
+ * and computes all the routes again.  If the GlobalRoutingIncrementalSpf
+ * global value is true, the new database is compared with the previous
+ * one, and only the routers whose routes may depend on the Link State
+ * Advertisements which changed are recomputed.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +808,109 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * The root of an SPF computation.  The objects of its node are looked up
+   * beforehand, so that the threads computing the routes do not change the
+   * reference counts or the aggregates of the objects they share.
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId; //!< the router ID of the root
+    Ipv4 *ipv4; //!< the Ipv4 of the node of the router, or 0
+    Ipv4GlobalRouting *routing; //!< the routing protocol of the router, or 0
+  };
+  /// Container: the roots of the SPF computations
+  typedef std::vector<SPFRoot> SPFRoots_t;
+  /// The SPF computations left to run, shared by the threads running them
+  struct SPFRootQueue;
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  /// SPF status of each Link State Advertisement of the LSDB, by index
+  std::vector<GlobalRoutingLSA::SPFStatus> m_spfStatus;
+  Ipv4 *m_spfrootIpv4; //!< the Ipv4 of the root node
+  Ipv4GlobalRouting *m_spfrootRouting; //!< the routing protocol of the root node
+  uint32_t m_nNodes; //!< the number of nodes, read before the computations start
+  SPFRootQueue* m_rootQueue; //!< the queue to take roots from, in a worker thread
+
+  /**
+   * \brief Find the node of a router
+   *
+   * \param routerId the router ID
+   * \returns the node whose GlobalRouter has this router ID, or 0
+   */
+  static Ptr<Node> FindRouterNode (Ipv4Address routerId);
+
+  /**
+   * \brief Look up the objects of the node of the root of an SPF computation
+   *
+   * \param routerId the router ID of the root
+   * \param node the node of the router, or 0
+   * \returns the root, valid as long as the node exists
+   */
+  static SPFRoot MakeSPFRoot (Ipv4Address routerId, Ptr<Node> node);
+
+  /**
+   * \brief Delete the routes computed for a node
+   *
+   * \param node the node
+   */
+  static void DeleteNodeRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Get the SPF status of a Link State Advertisement for the current
+   * computation
+   *
+   * \param lsa an LSA of the LSDB
+   * \returns the status of the LSA
+   */
+  GlobalRoutingLSA::SPFStatus GetSPFStatus (GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \brief Set the SPF status of a Link State Advertisement for the current
+   * computation
+   *
+   * \param lsa an LSA of the LSDB
+   * \param status the new status of the LSA
+   */
+  void SetSPFStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+  /**
+   * \brief Run the SPF computation of a set of routers
+   *
+   * The computations are spread over GlobalRoutingSpfThreads threads.
+   * Each computation only writes to the routing table of its root, and the
+   * LSDB is only read, so the resulting routes do not depend on the number
+   * of threads.  The threads do not copy any Ptr of a shared object, whose
+   * reference count is not atomic.
+   *
+   * \param roots the roots of the computations
+   */
+  void SPFCalculateRoots (const SPFRoots_t &roots);
+
+  /**
+   * \brief Run SPF computations from m_rootQueue until it is empty
+   *
+   * This is the body of the worker threads of SPFCalculateRoots ().
+   */
+  void SPFCalculateQueuedRoots (void);
+
+  /**
+   * \brief Find the routers whose routes may be affected by the changes
+   * between the previous and the current LSDB
+   *
+   * A router is affected if, in the previous or the current LSDB, it can
+   * reach an LSA which was added, removed, or whose link records changed.
+   * When only the metrics of some links changed, a router is only affected
+   * if the new or the previous metric makes the link part of one of its
+   * shortest paths.
+   *
+   * \param oldLsdb the previous LSDB
+   * \param routers the router IDs of the affected routers
+   * \returns true if all the routers are affected
+   */
+  bool FindAffectedRouters (const GlobalRouteManagerLSDB &oldLsdb,
+                            std::set<Ipv4Address> &routers) const;
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -789,6 +932,14 @@ private:
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Calculate the shortest path first (SPF) tree of a router
+   *
+   * \param root the root router, to whose routing protocol the routes are
+   * added
+   */
+  void SPFCalculate (const SPFRoot &root);
+
   /**
    * \brief Process Stub nodes
    *
@@ -64,6 +64,16 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes (), unless the GlobalRoutingIncrementalSpf global
+ * value is true, in which case only the routes of the routers affected by
+ * the changes of the Link State Advertisements are recomputed.
+ */
+  static void RecomputeRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
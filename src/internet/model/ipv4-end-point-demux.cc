@@ -29,7 +29,8 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152),
+    m_nextOrder (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -37,36 +38,83 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (OrderedEndPoints::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
-      Ipv4EndPoint *endPoint = *i;
+      Ipv4EndPoint *endPoint = i->second;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_orders.clear ();
+  m_index.clear ();
+  m_ports.clear ();
+}
+
+Ipv4EndPointDemux::IndexKey
+Ipv4EndPointDemux::GetKey (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort)
+{
+  return std::make_pair (localPort, std::make_pair (peerAddress, peerPort));
+}
+
+size_t
+Ipv4EndPointDemux::IndexKeyHash::operator() (const IndexKey &key) const
+{
+  uint64_t h = Ipv4AddressHash () (key.second.first);
+  h = h * 0x9e3779b97f4a7c15ULL ^ (static_cast<uint64_t> (key.first) << 16) ^ key.second.second;
+  // the finalizer of MurmurHash3, so that the keys of the peers of a
+  // port, which only differ by a few bits, spread over the buckets
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return static_cast<size_t> (h);
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  uint64_t order = m_nextOrder++;
+  m_endPoints[order] = endPoint;
+  m_orders[endPoint] = order;
+  m_index[GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ())][order] = endPoint;
+  m_ports[endPoint->GetLocalPort ()][order] = endPoint;
+  endPoint->SetPeerCallback (MakeCallback (&Ipv4EndPointDemux::PeerChanged, this));
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void
+Ipv4EndPointDemux::PeerChanged (Ipv4EndPoint *endPoint, Ipv4Address address, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << endPoint << address << port);
+  uint64_t order = m_orders[endPoint];
+  EndPointIndex::iterator i = m_index.find (GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+  NS_ASSERT (i != m_index.end ());
+  i->second.erase (order);
+  if (i->second.empty ())
+    {
+      m_index.erase (i);
+    }
+  m_index[GetKey (endPoint->GetLocalPort (), address, port)][order] = endPoint;
 }
 
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  PortIndex::const_iterator i = m_ports.find (port);
+  if (i == m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      return false;
+    }
+  for (OrderedEndPoints::const_iterator j = i->second.begin (); j != i->second.end (); j++)
+    {
+      if (j->second->GetLocalAddress () == addr)
         {
           return true;
         }
@@ -85,8 +133,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -101,8 +148,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -124,8 +170,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
   return endPoint;
 }
 
@@ -134,23 +179,22 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointIndex::const_iterator i = m_index.find (GetKey (localPort, peerAddress, peerPort));
+  if (i != m_index.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
+      for (OrderedEndPoints::const_iterator j = i->second.begin (); j != i->second.end (); j++)
         {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
+          if (j->second->GetLocalAddress () == localAddress) 
+            {
+              NS_LOG_WARN ("No way we can allocate this end-point.");
+              /* no way we can allocate this end-point. */
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  Insert (endPoint);
 
   return endPoint;
 }
@@ -159,15 +203,29 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<Ipv4EndPoint *, uint64_t>::iterator i = m_orders.find (endPoint);
+  if (i == m_orders.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  uint64_t order = i->second;
+  m_orders.erase (i);
+  m_endPoints.erase (order);
+  EndPointIndex::iterator j = m_index.find (GetKey (endPoint->GetLocalPort (), endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+  NS_ASSERT (j != m_index.end ());
+  j->second.erase (order);
+  if (j->second.empty ())
+    {
+      m_index.erase (j);
+    }
+  PortIndex::iterator k = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT (k != m_ports.end ());
+  k->second.erase (order);
+  if (k->second.empty ())
+    {
+      m_ports.erase (k);
     }
+  delete endPoint;
 }
 
 /*
@@ -179,9 +237,9 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   NS_LOG_FUNCTION (this);
   EndPoints ret;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (OrderedEndPoints::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
-      Ipv4EndPoint* endP = *i;
+      Ipv4EndPoint* endP = i->second;
       ret.push_back (endP);
     }
   return ret;
@@ -205,109 +263,129 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval3; // Matches all but local address
   EndPoints retval4; // Exact match on all 4
 
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  // Only the endpoints connected to the source of the packet and the
+  // endpoints with a wildcard peer may match: look at these two entries
+  // of the index only.  When they differ, the former may only be an
+  // exact match on the peer and the latter a wildcard match, so the
+  // order of each return list is still the order of allocation.
+  const OrderedEndPoints *candidates[2] = { 0, 0 };
+  EndPointIndex::const_iterator exact = m_index.find (GetKey (dport, saddr, sport));
+  if (exact != m_index.end ())
     {
-      Ipv4EndPoint* endP = *i;
-
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-
-      if (!endP->IsRxEnabled ())
+      candidates[0] = &exact->second;
+    }
+  if (saddr != Ipv4Address::GetAny () || sport != 0)
+    {
+      EndPointIndex::const_iterator wildcard = m_index.find (GetKey (dport, Ipv4Address::GetAny (), 0));
+      if (wildcard != m_index.end ())
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                        << " because endpoint can not receive packets");
-          continue;
+          candidates[1] = &wildcard->second;
         }
+    }
+
+  bool addressesChecked = false;
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
 
-      if (endP->GetLocalPort () != dport) 
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
+  for (uint32_t c = 0; c < 2; c++)
+    {
+      if (candidates[c] == 0)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
           continue;
         }
-      if (endP->GetBoundNetDevice ())
+      for (OrderedEndPoints::const_iterator i = candidates[c]->begin (); i != candidates[c]->end (); i++) 
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+          Ipv4EndPoint* endP = i->second;
+
+          NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
+                                                     << " daddr=" << endP->GetLocalAddress ()
+                                                     << " sport=" << endP->GetPeerPort ()
+                                                     << " saddr=" << endP->GetPeerAddress ());
+
+          if (!endP->IsRxEnabled ())
             {
               NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
+                            << " because endpoint can not receive packets");
               continue;
             }
-        }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+
+          NS_ASSERT (endP->GetLocalPort () == dport);
+          if (endP->GetBoundNetDevice ())
             {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
+              if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
+                {
+                  NS_LOG_LOGIC ("Skipping endpoint " << &endP
+                                                     << " because endpoint is bound to specific device and"
+                                                     << endP->GetBoundNetDevice ()
+                                                     << " does not match packet device " << incomingInterface->GetDevice ());
+                  continue;
+                }
             }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
-      bool localAddressMatchesWildCard = 
-        endP->GetLocalAddress () == Ipv4Address::GetAny ();
-      bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
+          if (!addressesChecked)
+            {
+              for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+                {
+                  Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+                  if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+                      daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+                    {
+                      subnetDirected = true;
+                      incomingInterfaceAddr = addr.GetLocal ();
+                    }
+                }
+              addressesChecked = true;
+            }
+          bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+          NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+          bool localAddressMatchesWildCard = 
+            endP->GetLocalAddress () == Ipv4Address::GetAny ();
+          bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
 
-      if (isBroadcast)
-        {
-          NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
-        }
+          if (isBroadcast)
+            {
+              NS_LOG_DEBUG ("Found bcast, localaddr " << endP->GetLocalAddress ());
+            }
 
-      if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
-        {
-          localAddressMatchesExact = (endP->GetLocalAddress () ==
-                                      incomingInterfaceAddr);
-        }
-      // if no match here, keep looking
-      if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        continue; 
-      bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () ==
-        Ipv4Address::GetAny ();
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
-
-      // Now figure out which return list to add this one to
-      if (localAddressMatchesWildCard &&
-          remotePeerMatchesWildCard &&
-          remoteAddressMatchesWildCard)
-        { // Only local port matches exactly
-          retval1.push_back (endP);
-        }
-      if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
-          remotePeerMatchesWildCard &&
-          remoteAddressMatchesWildCard)
-        { // Only local port and local address matches exactly
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard &&
-          remotePeerMatchesExact &&
-          remoteAddressMatchesExact)
-        { // All but local address
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact &&
-          remotePeerMatchesExact &&
-          remoteAddressMatchesExact)
-        { // All 4 match
-          retval4.push_back (endP);
+          if (isBroadcast && (endP->GetLocalAddress () != Ipv4Address::GetAny ()))
+            {
+              localAddressMatchesExact = (endP->GetLocalAddress () ==
+                                          incomingInterfaceAddr);
+            }
+          // if no match here, keep looking
+          if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+            continue; 
+          bool remotePeerMatchesExact = endP->GetPeerPort () == sport;
+          bool remotePeerMatchesWildCard = endP->GetPeerPort () == 0;
+          bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
+          bool remoteAddressMatchesWildCard = endP->GetPeerAddress () ==
+            Ipv4Address::GetAny ();
+
+          // Now figure out which return list to add this one to
+          if (localAddressMatchesWildCard &&
+              remotePeerMatchesWildCard &&
+              remoteAddressMatchesWildCard)
+            { // Only local port matches exactly
+              retval1.push_back (endP);
+            }
+          if ((localAddressMatchesExact || (isBroadcast && localAddressMatchesWildCard))&&
+              remotePeerMatchesWildCard &&
+              remoteAddressMatchesWildCard)
+            { // Only local port and local address matches exactly
+              retval2.push_back (endP);
+            }
+          if (localAddressMatchesWildCard &&
+              remotePeerMatchesExact &&
+              remoteAddressMatchesExact)
+            { // All but local address
+              retval3.push_back (endP);
+            }
+          if (localAddressMatchesExact &&
+              remotePeerMatchesExact &&
+              remoteAddressMatchesExact)
+            { // All 4 match
+              retval4.push_back (endP);
+            }
         }
     }
 
@@ -326,35 +404,45 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  EndPointIndex::const_iterator exact = m_index.find (GetKey (dport, saddr, sport));
+  if (exact != m_index.end ())
+    {
+      for (OrderedEndPoints::const_iterator i = exact->second.begin (); i != exact->second.end (); i++)
+        {
+          if (i->second->GetLocalAddress () == daddr)
+            {
+              /* this is an exact match. */
+              return i->second;
+            }
+        }
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
-  // function.
+  // function.  It considers all the endpoints of the port, in the order
+  // of allocation.
+  PortIndex::const_iterator port = m_ports.find (dport);
+  if (port == m_ports.end ())
+    {
+      return 0;
+    }
+  const OrderedEndPoints &endPoints = port->second;
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (OrderedEndPoints::const_iterator i = endPoints.begin ();
+       i != endPoints.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
-      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
+      if (i->second->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
-      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ()) 
+      if (i->second->GetPeerAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
       if (tmp < genericity) 
         {
-          generic = (*i);
+          generic = i->second;
           genericity = tmp;
         }
     }
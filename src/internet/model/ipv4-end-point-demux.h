@@ -23,6 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
+#include <utility>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +43,11 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port, peer address and peer port,
+ * so that a lookup only considers the endpoints connected to the source
+ * of the packet and the endpoints accepting packets from any peer,
+ * whatever the number of connections of the node.
  */
 
 class Ipv4EndPointDemux {
@@ -186,9 +194,84 @@ private:
   uint16_t m_portFirst;
 
   /**
-   * \brief A list of IPv4 end points.
+   * \brief Key of the endpoint index: local port, peer address and peer port.
+   */
+  typedef std::pair<uint16_t, std::pair<Ipv4Address, uint16_t> > IndexKey;
+
+  /**
+   * \brief Hash function of the keys of the endpoint index.
+   */
+  struct IndexKeyHash
+  {
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    size_t operator() (const IndexKey &key) const;
+  };
+
+  /**
+   * \brief Container of IPv4 end points, by order of allocation.
+   */
+  typedef std::map<uint64_t, Ipv4EndPoint *> OrderedEndPoints;
+
+  /**
+   * \brief Index of the IPv4 end points.
+   */
+  typedef std::unordered_map<IndexKey, OrderedEndPoints, IndexKeyHash> EndPointIndex;
+
+  /**
+   * \brief Index of the IPv4 end points by local port.
+   */
+  typedef std::unordered_map<uint16_t, OrderedEndPoints> PortIndex;
+
+  /**
+   * \brief Get the key of the index.
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the key
+   */
+  static IndexKey GetKey (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add a new end point to the demux.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Move an end point in the index when its peer changes.
+   * \param endPoint the end point
+   * \param address the new peer address
+   * \param port the new peer port
+   */
+  void PeerChanged (Ipv4EndPoint *endPoint, Ipv4Address address, uint16_t port);
+
+  /**
+   * \brief The IPv4 end points, by order of allocation.
+   */
+  OrderedEndPoints m_endPoints;
+
+  /**
+   * \brief The order of allocation of each end point.
+   */
+  std::unordered_map<Ipv4EndPoint *, uint64_t> m_orders;
+
+  /**
+   * \brief The IPv4 end points, by local port, peer address and peer port.
+   */
+  EndPointIndex m_index;
+
+  /**
+   * \brief The IPv4 end points of each local port, by order of allocation.
+   */
+  PortIndex m_ports;
+
+  /**
+   * \brief The order of allocation of the next end point.
    */
-  EndPoints m_endPoints;
+  uint64_t m_nextOrder;
 };
 
 } // namespace ns3
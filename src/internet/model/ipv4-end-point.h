@@ -141,6 +141,17 @@ public:
    */
   void SetDestroyCallback (Callback<void> callback);
 
+  /**
+   * \brief Set the peer change callback.
+   *
+   * The callback is invoked by SetPeer before the peer is changed, so
+   * that the Ipv4EndPointDemux holding the endpoint can index it
+   * under its new peer.
+   * \param callback callback function, called with the endpoint and
+   *        its new peer address and port
+   */
+  void SetPeerCallback (Callback<void, Ipv4EndPoint *, Ipv4Address, uint16_t> callback);
+
   /**
    * \brief Forward the packet to the upper level.
    *
@@ -223,6 +234,11 @@ private:
    */
   Callback<void> m_destroyCallback;
 
+  /**
+   * \brief The peer change callback.
+   */
+  Callback<void, Ipv4EndPoint *, Ipv4Address, uint16_t> m_peerCallback;
+
   /**
    * \brief true if the endpoint can receive packets.
    */
@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -267,11 +269,27 @@ private:
    * \return Ipv4Route to route the packet to reach dest address
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  /**
+   * \brief Rebuild the lookup tries from the routes, if they changed
+   * since the last lookup.
+   */
+  void UpdateLookupTables (void);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  bool m_lookupTablesValid;            //!< Whether the tries below match the routes
+  PrefixTrie m_hostTrie;               //!< Trie of the routes to hosts
+  PrefixTrie m_networkTrie;            //!< Trie of the routes to networks
+  PrefixTrie m_ASexternalTrie;         //!< Trie of the external routes
+  /// Routes to hosts, indexed by the trie
+  std::vector<Ipv4RoutingTableEntry *> m_hostTable;
+  /// Routes to networks, indexed by the trie
+  std::vector<Ipv4RoutingTableEntry *> m_networkTable;
+  /// External routes, indexed by the trie
+  std::vector<Ipv4RoutingTableEntry *> m_ASexternalTable;
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -24,6 +24,7 @@
                 << " [node " << m_ipv4->GetObject<Node> ()->GetId () << "] "; }
 
 #include <iomanip>
+#include <algorithm>
 #include "ns3/log.h"
 #include "ns3/names.h"
 #include "ns3/packet.h"
@@ -54,7 +55,9 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_lookupTableValid (false),
+    m_networkTrie (4),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +76,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_lookupTableValid = false;
 }
 
 void 
@@ -87,6 +91,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_lookupTableValid = false;
 }
 
 void 
@@ -144,6 +149,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_lookupTableValid = false;
 }
 
 uint32_t 
@@ -219,6 +225,27 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::UpdateLookupTable (void)
+{
+  if (m_lookupTableValid)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  m_networkTrie.Clear ();
+  m_networkTable.assign (m_networkRoutes.begin (), m_networkRoutes.end ());
+  for (uint32_t i = 0; i < m_networkTable.size (); i++)
+    {
+      uint8_t address[4];
+      uint8_t mask[4];
+      m_networkTable[i].first->GetDestNetwork ().Serialize (address);
+      Ipv4Address (m_networkTable[i].first->GetDestNetworkMask ().Get ()).Serialize (mask);
+      m_networkTrie.Insert (address, mask, i);
+    }
+  m_lookupTableValid = true;
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -239,56 +266,63 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
-
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
+  UpdateLookupTable ();
+  Ipv4RoutingTableEntry *route = 0;
+  uint8_t address[4];
+  dest.Serialize (address);
+  // consider the matching routes in the order of m_networkRoutes, as
+  // the selection below depends on it for routes of equal mask and metric
+  std::vector<uint32_t> matches;
+  m_networkTrie.Lookup (address, matches);
+  std::sort (matches.begin (), matches.end ());
+  for (std::vector<uint32_t>::const_iterator i = matches.begin (); 
+       i != matches.end (); 
        i++) 
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
+      Ipv4RoutingTableEntry *j = m_networkTable[*i].first;
+      uint32_t metric = m_networkTable[*i].second;
       Ipv4Mask mask = (j)->GetDestNetworkMask ();
       uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      NS_ASSERT (mask.IsMatch (dest, j->GetDestNetwork ()));
+      NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+      if (oif != 0)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
+          if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
             {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
               continue;
             }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
-            {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
-            }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
         }
+      if (masklen < longest_mask) // Not interested if got shorter mask
+        {
+          NS_LOG_LOGIC ("Previous match longer, skipping");
+          continue;
+        }
+      if (masklen > longest_mask) // Reset metric if longer masklen
+        {
+          shortest_metric = 0xffffffff;
+        }
+      longest_mask = masklen;
+      if (metric > shortest_metric)
+        {
+          NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+          continue;
+        }
+      shortest_metric = metric;
+      route = j;
+      if (masklen == 32)
+        {
+          break;
+        }
+    }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
     }
   if (rtentry != 0)
     {
@@ -449,6 +483,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_lookupTableValid = false;
           return;
         }
       tmp++;
@@ -575,6 +610,9 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_lookupTableValid = false;
+  m_networkTrie.Clear ();
+  m_networkTable.clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -615,6 +653,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_lookupTableValid = false;
         }
       else
         {
@@ -662,6 +701,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_lookupTableValid = false;
         }
       else
         {
@@ -24,6 +24,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -413,11 +415,32 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Rebuild the lookup trie from the network routes, if they
+   * changed since the last lookup.
+   */
+  void UpdateLookupTable (void);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief Whether the lookup trie matches the network routes.
+   */
+  bool m_lookupTableValid;
+
+  /**
+   * \brief the trie of the network routes.
+   */
+  PrefixTrie m_networkTrie;
+
+  /**
+   * \brief the network routes, indexed by the trie.
+   */
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > m_networkTable;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -47,6 +47,7 @@ Ipv6EndPoint::~Ipv6EndPoint ()
   m_rxCallback.Nullify ();
   m_icmpCallback.Nullify ();
   m_destroyCallback.Nullify ();
+  m_peerCallback.Nullify ();
 }
 
 Ipv6Address Ipv6EndPoint::GetLocalAddress ()
@@ -92,6 +93,10 @@ Ptr<NetDevice> Ipv6EndPoint::GetBoundNetDevice (void)
 
 void Ipv6EndPoint::SetPeer (Ipv6Address addr, uint16_t port)
 {
+  if (!m_peerCallback.IsNull ())
+    {
+      m_peerCallback (this, addr, port);
+    }
   m_peerAddr = addr;
   m_peerPort = port;
 }
@@ -111,6 +116,11 @@ void Ipv6EndPoint::SetDestroyCallback (Callback<void> callback)
   m_destroyCallback = callback;
 }
 
+void Ipv6EndPoint::SetPeerCallback (Callback<void, Ipv6EndPoint *, Ipv6Address, uint16_t> callback)
+{
+  m_peerCallback = callback;
+}
+
 void Ipv6EndPoint::ForwardUp (Ptr<Packet> p, Ipv6Header header, uint16_t port, Ptr<Ipv6Interface> incomingInterface)
 {
   if (!m_rxCallback.IsNull ())
@@ -151,6 +151,17 @@ public:
    */
   void SetDestroyCallback (Callback<void> callback);
 
+  /**
+   * \brief Set the peer change callback.
+   *
+   * The callback is invoked by SetPeer before the peer is changed, so
+   * that the Ipv6EndPointDemux holding the endpoint can index it
+   * under its new peer.
+   * \param callback callback function, called with the endpoint and
+   *        its new peer address and port
+   */
+  void SetPeerCallback (Callback<void, Ipv6EndPoint *, Ipv6Address, uint16_t> callback);
+
   /**
    * \brief Forward the packet to the upper level.
    *
@@ -232,6 +243,11 @@ private:
    */
   Callback<void> m_destroyCallback;
 
+  /**
+   * \brief The peer change callback.
+   */
+  Callback<void, Ipv6EndPoint *, Ipv6Address, uint16_t> m_peerCallback;
+
   /**
    * \brief true if the endpoint can receive packets.
    */
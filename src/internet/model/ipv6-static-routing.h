@@ -24,12 +24,14 @@
 #include <stdint.h>
 
 #include <list>
+#include <vector>
 
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -287,11 +289,32 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Rebuild the lookup trie from the network routes, if they
+   * changed since the last lookup.
+   */
+  void UpdateLookupTable (void);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief Whether the lookup trie matches the network routes.
+   */
+  bool m_lookupTableValid;
+
+  /**
+   * \brief the trie of the network routes.
+   */
+  PrefixTrie m_networkTrie;
+
+  /**
+   * \brief the network routes, indexed by the trie.
+   */
+  std::vector<std::pair <Ipv6RoutingTableEntry *, uint32_t> > m_networkTable;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "prefix-trie.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PrefixTrie");
+
+PrefixTrie::PrefixTrie (uint32_t bytes)
+  : m_bytes (bytes),
+    m_root (0)
+{
+  NS_LOG_FUNCTION (this << bytes);
+  NS_ASSERT (bytes > 0 && bytes <= MAX_BYTES);
+  uint8_t zero[MAX_BYTES] = { 0 };
+  m_root = CreateNode (zero, 0);
+}
+
+PrefixTrie::~PrefixTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNode (m_root);
+}
+
+PrefixTrie::Node *
+PrefixTrie::CreateNode (const uint8_t *prefix, uint32_t length) const
+{
+  Node *node = new Node;
+  std::memset (node->prefix, 0, MAX_BYTES);
+  for (uint32_t i = 0; i < length / 8; i++)
+    {
+      node->prefix[i] = prefix[i];
+    }
+  if (length % 8)
+    {
+      node->prefix[length / 8] = prefix[length / 8] & (0xff << (8 - length % 8));
+    }
+  node->length = length;
+  node->children[0] = 0;
+  node->children[1] = 0;
+  return node;
+}
+
+void
+PrefixTrie::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->children[0]);
+      DeleteNode (node->children[1]);
+      delete node;
+    }
+}
+
+uint32_t
+PrefixTrie::GetBit (const uint8_t *address, uint32_t i)
+{
+  return (address[i / 8] >> (7 - i % 8)) & 1;
+}
+
+uint32_t
+PrefixTrie::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t length)
+{
+  uint32_t i = 0;
+  while (i + 8 <= length && a[i / 8] == b[i / 8])
+    {
+      i += 8;
+    }
+  while (i < length && GetBit (a, i) == GetBit (b, i))
+    {
+      i++;
+    }
+  return i;
+}
+
+void
+PrefixTrie::Insert (const uint8_t *address, const uint8_t *mask, uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+
+  uint32_t length = 0;
+  while (length < m_bytes * 8 && GetBit (mask, length))
+    {
+      length++;
+    }
+  for (uint32_t i = length; i < m_bytes * 8; i++)
+    {
+      if (GetBit (mask, i))
+        {
+          NS_LOG_LOGIC ("non-contiguous mask for route " << index);
+          MaskedRoute route;
+          std::memset (&route, 0, sizeof (route));
+          for (uint32_t j = 0; j < m_bytes; j++)
+            {
+              route.address[j] = address[j] & mask[j];
+              route.mask[j] = mask[j];
+            }
+          route.index = index;
+          m_masked.push_back (route);
+          return;
+        }
+    }
+
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      uint32_t bit = GetBit (address, node->length);
+      Node *child = node->children[bit];
+      if (child == 0)
+        {
+          child = CreateNode (address, length);
+          node->children[bit] = child;
+          node = child;
+          break;
+        }
+      uint32_t common = GetCommonLength (child->prefix, address, std::min (child->length, length));
+      if (common < child->length)
+        {
+          // split the edge to the child at the first differing bit
+          Node *split = CreateNode (address, common);
+          split->children[GetBit (child->prefix, common)] = child;
+          node->children[bit] = split;
+          child = split;
+        }
+      node = child;
+    }
+  NS_ASSERT (node->length == length);
+  node->indexes.push_back (index);
+}
+
+void
+PrefixTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNode (m_root->children[0]);
+  DeleteNode (m_root->children[1]);
+  m_root->children[0] = 0;
+  m_root->children[1] = 0;
+  m_root->indexes.clear ();
+  m_masked.clear ();
+}
+
+void
+PrefixTrie::Lookup (const uint8_t *address, std::vector<uint32_t> &indexes) const
+{
+  const Node *node = m_root;
+  while (node != 0 && GetCommonLength (node->prefix, address, node->length) == node->length)
+    {
+      indexes.insert (indexes.end (), node->indexes.begin (), node->indexes.end ());
+      if (node->length == m_bytes * 8)
+        {
+          break;
+        }
+      node = node->children[GetBit (address, node->length)];
+    }
+  for (std::vector<MaskedRoute>::const_iterator i = m_masked.begin (); i != m_masked.end (); ++i)
+    {
+      bool match = true;
+      for (uint32_t j = 0; j < m_bytes && match; j++)
+        {
+          match = (address[j] & i->mask[j]) == i->address[j];
+        }
+      if (match)
+        {
+          indexes.push_back (i->index);
+        }
+    }
+}
+
+} // namespace ns3
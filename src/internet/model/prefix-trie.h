@@ -0,0 +1,126 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include "ns3/non-copyable.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ * \ingroup ipv6Routing
+ * \brief a path-compressed binary trie of address prefixes
+ *
+ * The trie maps address prefixes to the indexes of the routes which
+ * have them as destination, and finds all the routes whose destination
+ * matches an address by walking down the bits of the address once,
+ * instead of testing the mask of every route.
+ *
+ * Addresses and masks are given in network byte order, as returned by
+ * Ipv4Address::Serialize and Ipv6Address::GetBytes.  Masks which are
+ * not contiguous, which may be built from an Ipv4Mask, cannot be
+ * stored in the trie: the routes with such masks are kept apart and
+ * tested one by one.
+ */
+class PrefixTrie : private NonCopyable
+{
+public:
+  /**
+   * \param bytes the length of the addresses, in bytes (4 or 16)
+   */
+  PrefixTrie (uint32_t bytes);
+  ~PrefixTrie ();
+
+  /**
+   * \brief Add a route to the trie.
+   * \param address the destination of the route
+   * \param mask the mask of the destination
+   * \param index the index of the route
+   */
+  void Insert (const uint8_t *address, const uint8_t *mask, uint32_t index);
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \brief Find the routes whose destination matches an address.
+   * \param address the address
+   * \param indexes the indexes of the matching routes, by increasing
+   *        length of their mask for contiguous masks, then in the order
+   *        of insertion for routes with the same mask and for the
+   *        routes with a non-contiguous mask, which come last
+   *
+   * The matching indexes are appended to the indexes.
+   */
+  void Lookup (const uint8_t *address, std::vector<uint32_t> &indexes) const;
+
+private:
+  /// Maximum length of the addresses, in bytes
+  static const uint32_t MAX_BYTES = 16;
+
+  /// A node of the trie
+  struct Node
+  {
+    uint8_t prefix[MAX_BYTES];       //!< the prefix of the node, zero past its length
+    uint32_t length;                 //!< the length of the prefix, in bits
+    Node *children[2];               //!< the subtries following a 0 and a 1 bit
+    std::vector<uint32_t> indexes;   //!< the routes to this prefix
+  };
+
+  /// A route with a non-contiguous mask
+  struct MaskedRoute
+  {
+    uint8_t address[MAX_BYTES];      //!< the destination, masked
+    uint8_t mask[MAX_BYTES];         //!< the mask
+    uint32_t index;                  //!< the index of the route
+  };
+
+  /**
+   * \param prefix the prefix of the new node
+   * \param length the length of the new node, in bits
+   * \returns a node with no children and no routes
+   */
+  Node * CreateNode (const uint8_t *prefix, uint32_t length) const;
+  /**
+   * \param node the root of the subtrie to delete
+   */
+  static void DeleteNode (Node *node);
+  /**
+   * \param address an address
+   * \param i the index of a bit, from the most significant one
+   * \returns the value of the bit
+   */
+  static uint32_t GetBit (const uint8_t *address, uint32_t i);
+  /**
+   * \param a an address
+   * \param b an address
+   * \param length the number of bits to compare
+   * \returns the number of leading bits a and b have in common, at most
+   *          length
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t length);
+
+  uint32_t m_bytes;                       //!< the length of the addresses, in bytes
+  Node *m_root;                           //!< the root, with an empty prefix
+  std::vector<MaskedRoute> m_masked;      //!< the routes with a non-contiguous mask
+};
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
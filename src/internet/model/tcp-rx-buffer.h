@@ -36,6 +36,11 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * The buffered data is a set of disjoint intervals of sequence numbers,
+ * ordered by their first sequence number, so that the intervals that a
+ * new packet overlaps and the data that it makes available are found in
+ * logarithmic time, whatever the number of holes in the buffer.
  */
 class TcpRxBuffer : public Object
 {
@@ -57,7 +57,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_headOffset (0), m_cursor (0)
 {
 }
 
@@ -111,6 +111,7 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
+          m_offsets.push_back (m_headOffset + m_size);
           m_data.push_back (p);
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
@@ -133,6 +134,29 @@ TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
   return lastSeq - seq;
 }
 
+uint64_t
+TcpTxBuffer::GetPacketEnd (uint32_t i) const
+{
+  return i + 1 < m_offsets.size () ? m_offsets[i + 1] : m_headOffset + m_size;
+}
+
+uint32_t
+TcpTxBuffer::FindPacket (uint64_t offset) const
+{
+  NS_ASSERT (offset >= m_headOffset && offset < m_headOffset + m_size);
+  // Segments are mostly taken in sequence: try the packet of the last
+  // copied byte and the next one before searching
+  for (uint32_t i = m_cursor; i < m_cursor + 2 && i < m_offsets.size (); i++)
+    {
+      if (m_offsets[i] <= offset && offset < GetPacketEnd (i))
+        {
+          return i;
+        }
+    }
+  std::deque<uint64_t>::const_iterator i = std::upper_bound (m_offsets.begin (), m_offsets.end (), offset);
+  return (i - m_offsets.begin ()) - 1;
+}
+
 Ptr<Packet>
 TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 {
@@ -148,55 +172,40 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
+  uint64_t offset = m_headOffset + (seq - m_firstByteSeq.Get ());
+  uint32_t i = FindPacket (offset);
+  NS_LOG_LOGIC ("First byte found in packet #" << i << " of " << m_data.size ()
+                                               << " at stream offset " << m_offsets[i]);
   Ptr<Packet> outPacket;
-  NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  uint32_t copied = 0;
+  while (copied < s)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
+      NS_ASSERT (i < m_data.size ());
+      uint32_t pktSize = m_data[i]->GetSize ();
+      uint32_t packetOffset = offset + copied - m_offsets[i];
+      uint32_t fragmentLength = std::min (pktSize - packetOffset, s - copied);
+      // The fragments share the data of the buffered packets
+      Ptr<Packet> fragment;
+      if (packetOffset == 0 && fragmentLength == pktSize)
+        {
+          fragment = m_data[i]->Copy ();
         }
-      else if (count + pktSize >= offset + s)
-        { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-          break;
+      else
+        {
+          fragment = m_data[i]->CreateFragment (packetOffset, fragmentLength);
+        }
+      if (outPacket == 0)
+        {
+          outPacket = fragment;
         }
       else
         {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          outPacket->AddAtEnd (fragment);
         }
-      count += pktSize;
+      copied += fragmentLength;
+      m_cursor = i++;
     }
+  NS_LOG_LOGIC ("Output packet is of size " << outPacket->GetSize ());
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
 }
@@ -217,30 +226,21 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
-  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
-  uint32_t pktSize;
+  // Skip the acknowledged bytes, and release the packets all of whose
+  // bytes are acknowledged
+  uint32_t offset = std::min<uint32_t> (seq - m_firstByteSeq.Get (), m_size);  // Number of bytes to remove
   NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  m_headOffset += offset;
+  m_size -= offset;
+  m_firstByteSeq += offset;
+  while (!m_data.empty () && GetPacketEnd (0) <= m_headOffset)
     {
-      if (offset > (*i)->GetSize ())
-        { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
-          m_size -= pktSize;
-          offset -= pktSize;
-          m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
-          NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
-        }
-      else if (offset > 0)
-        { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
-          m_size -= offset;
-          m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
-          break;
+      NS_LOG_LOGIC ("Removed one packet of size " << m_data.front ()->GetSize ());
+      m_data.pop_front ();
+      m_offsets.pop_front ();
+      if (m_cursor > 0)
+        {
+          m_cursor--;
         }
     }
   // Catching the case of ACKing a FIN
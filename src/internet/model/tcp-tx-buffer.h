@@ -21,7 +21,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
@@ -36,6 +36,14 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets added by the application are kept whole, in a deque, along
+ * with the offset of their first byte in the stream of data sent by the
+ * application.  The packet holding a given byte is found by a binary
+ * search over these offsets, or directly when the segments are taken in
+ * sequence.  Acknowledged bytes at the head of the first packet are only
+ * skipped: the packet is released when all its bytes are acknowledged,
+ * so that an acknowledgment never fragments the buffered data.
  */
 class TcpTxBuffer : public Object
 {
@@ -128,13 +136,25 @@ public:
   void DiscardUpTo (const SequenceNumber32& seq);
 
 private:
-  /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  /**
+   * Find the packet holding a byte of the buffer
+   * \param offset the offset of the byte in the stream
+   * \returns the index of the packet in m_data
+   */
+  uint32_t FindPacket (uint64_t offset) const;
+  /**
+   * \param i the index of a packet in m_data
+   * \returns the offset in the stream of the byte following the packet
+   */
+  uint64_t GetPacketEnd (uint32_t i) const;
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  std::deque<Ptr<Packet> > m_data;              //!< Corresponding data
+  std::deque<uint64_t> m_offsets;               //!< Offset in the stream of the first byte of each packet
+  uint64_t m_headOffset;                        //!< Offset in the stream of the first byte in data
+  uint32_t m_cursor;                            //!< Index of the packet holding the last byte copied
 };
 
 } // namepsace ns3
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-interface.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Check that Ipv4EndPointDemux finds the most specific endpoint,
+ * follows the endpoints whose peer is set after their allocation and
+ * forgets the deallocated endpoints.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Check the endpoints found by an Ipv4EndPointDemux")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4Address other ("10.0.0.3");
+
+  Ipv4EndPoint *listener = demux.Allocate (80);
+  Ipv4EndPoint *connection = demux.Allocate (local, 80, peer, 5000);
+  Ipv4EndPoint *bound = demux.Allocate (local, 81);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, peer, 5000), 0, "Duplicate endpoint allocated");
+
+  Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connection, "The exact match should be found");
+  endPoints = demux.Lookup (local, 80, other, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "The listener should be found");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 5000), connection, "The exact match should be found");
+
+  // an endpoint connected after its allocation
+  bound->SetPeer (other, 6000);
+  endPoints = demux.Lookup (local, 81, other, 6000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), bound, "The connected endpoint should be found");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, 81, peer, 6000, interface).size (), 0,
+                         "A connected endpoint should not match other peers");
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 81, other, 6000), bound, "The connected endpoint should be found");
+
+  Ipv4EndPointDemux::EndPoints all = demux.GetAllEndPoints ();
+  NS_TEST_ASSERT_MSG_EQ (all.size (), 3, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (all.front (), listener, "The endpoints should be in the order of allocation");
+  NS_TEST_EXPECT_MSG_EQ (all.back (), bound, "The endpoints should be in the order of allocation");
+
+  demux.DeAllocate (connection);
+  endPoints = demux.Lookup (local, 80, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "The deallocated endpoint should not be found");
+  demux.DeAllocate (listener);
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupPortLocal (80), false, "Port 80 should be free");
+  NS_TEST_EXPECT_MSG_EQ (demux.LookupLocal (local, 81), true, "Port 81 should be in use");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Check that Ipv6EndPointDemux finds the most specific endpoint and
+ * follows the endpoints whose peer is set after their allocation.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Check the endpoints found by an Ipv6EndPointDemux")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  Ipv6Address local ("2001:db8::1");
+  Ipv6Address peer ("2001:db8::2");
+  Ipv6Address other ("2001:db8::3");
+
+  Ipv6EndPoint *listener = demux.Allocate (80);
+  Ipv6EndPoint *connection = demux.Allocate (local, 80, peer, 5000);
+  Ipv6EndPoint *bound = demux.Allocate (local, 81);
+
+  Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup (local, 80, peer, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), connection, "The exact match should be found");
+  endPoints = demux.Lookup (local, 80, other, 5000, interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), 1, "Wrong number of endpoints");
+  NS_TEST_EXPECT_MSG_EQ (endPoints.front (), listener, "The listener should be found");
+
+  bound->SetPeer (other, 6000);
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 81, other, 6000), bound, "The connected endpoint should be found");
+  NS_TEST_EXPECT_MSG_EQ (demux.Lookup (local, 81, peer, 6000, interface).size (), 0,
+                         "A connected endpoint should not match other peers");
+
+  demux.DeAllocate (connection);
+  NS_TEST_EXPECT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 5000), listener,
+                         "The deallocated endpoint should not be found");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase (), TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase (), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
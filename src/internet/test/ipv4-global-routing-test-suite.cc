@@ -15,6 +15,7 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -1167,6 +1168,260 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * Check that the routes computed with several threads, and the routes
+ * recomputed incrementally after a change of the topology, are the same
+ * as the routes computed from scratch by a single thread.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+  virtual ~Ipv4GlobalRoutingRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param threads the number of threads computing the routes
+   * \param incremental whether to recompute the routes incrementally
+   * \returns the routes of all the nodes, in order
+   */
+  std::vector<std::string> Recompute (uint32_t threads, bool incremental);
+
+  NodeContainer m_nodes; //!< the routers
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Global routing computed by several threads and incrementally")
+{
+}
+
+Ipv4GlobalRoutingRecomputeTestCase::~Ipv4GlobalRoutingRecomputeTestCase ()
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingRecomputeTestCase::Recompute (uint32_t threads, bool incremental)
+{
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (threads));
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (incremental));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+// A grid of 5 x 5 routers connected by point-to-point links, where the
+// routers 0, 1 and 25 also share a LAN.
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  const uint32_t n = 5;
+  m_nodes.Create (n * n + 1);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < n * n; i++)
+    {
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          uint32_t j = k ? i + n : i + 1;
+          if ((k == 0 && (i + 1) % n == 0) || j >= n * n)
+            {
+              continue;
+            }
+          NetDeviceContainer link = p2pHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (j)),
+                                                       CreateObject<SimpleChannel> ());
+          ipv4.Assign (link);
+          ipv4.NewNetwork ();
+        }
+    }
+  SimpleNetDeviceHelper lanHelper;
+  NetDeviceContainer lan = lanHelper.Install (NodeContainer (m_nodes.Get (0), m_nodes.Get (1), m_nodes.Get (n * n)),
+                                              CreateObject<SimpleChannel> ());
+  ipv4.SetBase ("10.2.1.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> reference = Recompute (1, false);
+  NS_TEST_ASSERT_MSG_NE (reference[12], "", "No routes computed");
+  NS_TEST_ASSERT_MSG_EQ ((Recompute (4, false) == reference), true, "Routes computed by 4 threads differ");
+  NS_TEST_ASSERT_MSG_EQ ((Recompute (1, true) == reference), true, "Routes recomputed without changes differ");
+
+  // Make the links of router 12, in the middle of the grid, more expensive
+  Ptr<Ipv4> ipv4Middle = m_nodes.Get (12)->GetObject<Ipv4> ();
+  ipv4Middle->SetMetric (1, 3);
+  ipv4Middle->SetMetric (2, 2);
+  std::vector<std::string> incremental = Recompute (4, true);
+  NS_TEST_ASSERT_MSG_EQ ((incremental == Recompute (1, false)), true, "Routes recomputed after metric changes differ");
+  NS_TEST_ASSERT_MSG_EQ ((incremental == reference), false, "The metric changes should change some routes");
+
+  // Bring a link down, and the LAN
+  ipv4Middle->SetDown (3);
+  m_nodes.Get (n * n)->GetObject<Ipv4> ()->SetDown (1);
+  incremental = Recompute (2, true);
+  NS_TEST_ASSERT_MSG_EQ ((incremental == Recompute (1, false)), true, "Routes recomputed after a link went down differ");
+
+  // Back to the first topology
+  ipv4Middle->SetUp (3);
+  m_nodes.Get (n * n)->GetObject<Ipv4> ()->SetUp (1);
+  ipv4Middle->SetMetric (1, 1);
+  ipv4Middle->SetMetric (2, 1);
+  NS_TEST_ASSERT_MSG_EQ ((Recompute (4, true) == reference), true, "Routes recomputed after the links were restored differ");
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  Config::SetGlobal ("GlobalRoutingIncrementalSpf", BooleanValue (false));
+  m_nodes = NodeContainer ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that the routes computed by several threads are those computed by
+ * a single thread, and that the threads leave the reference counts of the
+ * nodes and of their objects unchanged.
+ */
+class Ipv4GlobalRoutingThreadsTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingThreadsTestCase ();
+  virtual ~Ipv4GlobalRoutingThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param threads the number of threads computing the routes
+   * \returns the routes of all the nodes, in order
+   */
+  std::vector<std::string> Compute (uint32_t threads);
+  /**
+   * \returns the reference counts of the nodes, of their Ipv4 and of their
+   * routing protocols
+   */
+  std::vector<uint32_t> GetReferenceCounts (void);
+
+  NodeContainer m_nodes; //!< the routers
+};
+
+Ipv4GlobalRoutingThreadsTestCase::Ipv4GlobalRoutingThreadsTestCase ()
+  : TestCase ("Global routing computed by 1 and by several threads")
+{
+}
+
+Ipv4GlobalRoutingThreadsTestCase::~Ipv4GlobalRoutingThreadsTestCase ()
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingThreadsTestCase::Compute (uint32_t threads)
+{
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (threads));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << *routing->GetRoute (j) << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+std::vector<uint32_t>
+Ipv4GlobalRoutingThreadsTestCase::GetReferenceCounts (void)
+{
+  std::vector<uint32_t> counts;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Node *node = PeekPointer (m_nodes.Get (i));
+      Ipv4L3Protocol *ipv4 = PeekPointer (node->GetObject<Ipv4L3Protocol> ());
+      Ipv4RoutingProtocol *routing = PeekPointer (ipv4->GetRoutingProtocol ());
+      counts.push_back (node->GetReferenceCount ());
+      counts.push_back (ipv4->GetReferenceCount ());
+      counts.push_back (routing->GetReferenceCount ());
+    }
+  return counts;
+}
+
+// A grid of 8 x 8 routers connected by point-to-point links of metrics
+// 1 to 3, so that there are many equal and unequal cost paths.
+void
+Ipv4GlobalRoutingThreadsTestCase::DoRun (void)
+{
+  const uint32_t n = 8;
+  m_nodes.Create (n * n);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < n * n; i++)
+    {
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          uint32_t j = k ? i + n : i + 1;
+          if ((k == 0 && (i + 1) % n == 0) || j >= n * n)
+            {
+              continue;
+            }
+          NetDeviceContainer link = p2pHelper.Install (NodeContainer (m_nodes.Get (i), m_nodes.Get (j)),
+                                                       CreateObject<SimpleChannel> ());
+          Ipv4InterfaceContainer interfaces = ipv4.Assign (link);
+          ipv4.NewNetwork ();
+          uint16_t metric = 1 + (i + j) % 3;
+          interfaces.Get (0).first->SetMetric (interfaces.Get (0).second, metric);
+          interfaces.Get (1).first->SetMetric (interfaces.Get (1).second, metric);
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> reference = Compute (1);
+  std::vector<uint32_t> counts = GetReferenceCounts ();
+  NS_TEST_ASSERT_MSG_NE (reference[n * n - 1], "", "No routes computed");
+  for (uint32_t run = 0; run < 3; run++)
+    {
+      for (uint32_t threads = 2; threads <= 8; threads *= 2)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((Compute (threads) == reference), true,
+                                 "Routes computed by " << threads << " threads differ");
+          NS_TEST_ASSERT_MSG_EQ ((GetReferenceCounts () == counts), true,
+                                 "Reference counts changed by " << threads << " threads");
+        }
+    }
+
+  Config::SetGlobal ("GlobalRoutingSpfThreads", UintegerValue (1));
+  m_nodes = NodeContainer ();
+  Simulator::Destroy ();
+}
+
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
 public:
@@ -1184,6 +1439,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingThreadsTestCase, TestCase::QUICK);
   }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/prefix-trie.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Check that PrefixTrie::Lookup returns the same routes as testing the
+ * mask of every route, for IPv4 routes, including routes with a
+ * non-contiguous mask, and for IPv6 routes.
+ */
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  PrefixTrieTestCase ();
+  virtual ~PrefixTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param bytes the length of the addresses
+   * \param nonContiguous whether to add routes with non-contiguous masks
+   */
+  void Check (uint32_t bytes, bool nonContiguous);
+  /**
+   * \param bytes the length of the address
+   * \param address the address to fill, which is a random address
+   *        close to the previous addresses most of the time
+   */
+  void GetAddress (uint32_t bytes, uint8_t *address);
+
+  Ptr<UniformRandomVariable> m_random;   //!< random routes and addresses
+  std::vector<uint8_t> m_addresses;      //!< the addresses created so far
+};
+
+PrefixTrieTestCase::PrefixTrieTestCase ()
+  : TestCase ("Check the routes returned by a PrefixTrie")
+{
+}
+
+PrefixTrieTestCase::~PrefixTrieTestCase ()
+{
+}
+
+void
+PrefixTrieTestCase::GetAddress (uint32_t bytes, uint8_t *address)
+{
+  uint32_t n = m_addresses.size () / bytes;
+  if (n > 0 && m_random->GetInteger (0, 3) != 0)
+    {
+      // flip a few bits of a previous address, to get long common prefixes
+      uint32_t previous = m_random->GetInteger (0, n - 1);
+      std::copy (&m_addresses[previous * bytes], &m_addresses[previous * bytes] + bytes, address);
+      for (uint32_t i = m_random->GetInteger (0, 2); i > 0; i--)
+        {
+          uint32_t bit = m_random->GetInteger (0, bytes * 8 - 1);
+          address[bit / 8] ^= 0x80 >> (bit % 8);
+        }
+    }
+  else
+    {
+      for (uint32_t i = 0; i < bytes; i++)
+        {
+          address[i] = m_random->GetInteger (0, 255);
+        }
+    }
+  m_addresses.insert (m_addresses.end (), address, address + bytes);
+}
+
+void
+PrefixTrieTestCase::Check (uint32_t bytes, bool nonContiguous)
+{
+  PrefixTrie trie (bytes);
+  std::vector<uint8_t> addresses;
+  std::vector<uint8_t> masks;
+  m_addresses.clear ();
+
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      uint32_t nRoutes = 600;
+      for (uint32_t r = 0; r < nRoutes; r++)
+        {
+          uint8_t address[16];
+          uint8_t mask[16];
+          GetAddress (bytes, address);
+          // favour host routes and a few common prefix lengths
+          uint32_t length;
+          switch (m_random->GetInteger (0, 3))
+            {
+            case 0:
+              length = bytes * 8;
+              break;
+            case 1:
+              length = bytes * 2;
+              break;
+            default:
+              length = m_random->GetInteger (0, bytes * 8);
+              break;
+            }
+          for (uint32_t i = 0; i < bytes; i++)
+            {
+              uint32_t ones = std::min (8U, length - std::min (length, i * 8));
+              mask[i] = (0xff00 >> ones) & 0xff;
+            }
+          if (nonContiguous && r % 50 == 0)
+            {
+              mask[0] = 0xff;
+              mask[bytes - 1] = 0x0f;
+            }
+          addresses.insert (addresses.end (), address, address + bytes);
+          masks.insert (masks.end (), mask, mask + bytes);
+          trie.Insert (address, mask, r);
+        }
+
+      for (uint32_t q = 0; q < 2000; q++)
+        {
+          uint8_t address[16];
+          GetAddress (bytes, address);
+          std::vector<uint32_t> indexes;
+          trie.Lookup (address, indexes);
+          std::sort (indexes.begin (), indexes.end ());
+          std::vector<uint32_t> expected;
+          for (uint32_t r = 0; r < nRoutes; r++)
+            {
+              bool match = true;
+              for (uint32_t i = 0; i < bytes && match; i++)
+                {
+                  match = (address[i] & masks[r * bytes + i]) == (addresses[r * bytes + i] & masks[r * bytes + i]);
+                }
+              if (match)
+                {
+                  expected.push_back (r);
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (indexes.size (), expected.size (), "Wrong number of matching routes");
+          NS_TEST_ASSERT_MSG_EQ (std::equal (indexes.begin (), indexes.end (), expected.begin ()), true,
+                                 "Wrong matching routes");
+        }
+
+      // the trie must work the same after being cleared
+      trie.Clear ();
+      addresses.clear ();
+      masks.clear ();
+    }
+}
+
+void
+PrefixTrieTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  Check (4, false);
+  Check (4, true);
+  Check (16, false);
+
+  // the order of the routes of a prefix is the order of insertion
+  PrefixTrie trie (4);
+  uint8_t address[4];
+  uint8_t mask[4];
+  Ipv4Address ("10.1.0.0").Serialize (address);
+  Ipv4Address (Ipv4Mask ("/16").Get ()).Serialize (mask);
+  trie.Insert (address, mask, 3);
+  trie.Insert (address, mask, 1);
+  Ipv4Address ("10.1.2.0").Serialize (address);
+  Ipv4Address (Ipv4Mask ("/24").Get ()).Serialize (mask);
+  trie.Insert (address, mask, 0);
+  Ipv4Address ("0.0.0.0").Serialize (address);
+  Ipv4Address (Ipv4Mask ("/0").Get ()).Serialize (mask);
+  trie.Insert (address, mask, 2);
+  std::vector<uint32_t> indexes;
+  Ipv4Address ("10.1.2.3").Serialize (address);
+  trie.Lookup (address, indexes);
+  NS_TEST_ASSERT_MSG_EQ (indexes.size (), 4, "Wrong number of matching routes");
+  NS_TEST_EXPECT_MSG_EQ (indexes[0], 2, "The default route should come first");
+  NS_TEST_EXPECT_MSG_EQ (indexes[1], 3, "Routes to a prefix should be in order");
+  NS_TEST_EXPECT_MSG_EQ (indexes[2], 1, "Routes to a prefix should be in order");
+  NS_TEST_EXPECT_MSG_EQ (indexes[3], 0, "The longest prefix should come last");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite ()
+  : TestSuite ("prefix-trie", UNIT)
+{
+  AddTestCase (new PrefixTrieTestCase (), TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite g_prefixTrieTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \param stream the offset of the first byte in the stream
+ * \param size the number of bytes
+ * \returns a packet holding the bytes of the stream
+ */
+static Ptr<Packet>
+CreateStreamPacket (uint32_t stream, uint32_t size)
+{
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = (stream + i) % 251;
+    }
+  return Create<Packet> (&data[0], size);
+}
+
+/**
+ * \param p a packet
+ * \param stream the offset in the stream of the first byte expected
+ * \returns true if the packet holds the bytes of the stream
+ */
+static bool
+CheckStreamPacket (Ptr<Packet> p, uint32_t stream)
+{
+  std::vector<uint8_t> data (p->GetSize ());
+  p->CopyData (&data[0], data.size ());
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      if (data[i] != (stream + i) % 251)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Check the data of the segments copied from a TcpTxBuffer while the
+ * application adds packets of random sizes and the data is acknowledged.
+ */
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("Check the segments copied from a TcpTxBuffer")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  // start close to the wrap around of the sequence numbers
+  uint32_t isn = 0xffff0000;
+  TcpTxBuffer buffer (isn);
+  buffer.SetMaxBufferSize (65536);
+  uint32_t added = 0;
+  uint32_t acked = 0;
+
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      uint32_t size = random->GetInteger (1, 3000);
+      if (size <= buffer.Available ())
+        {
+          NS_TEST_ASSERT_MSG_EQ (buffer.Add (CreateStreamPacket (added, size)), true, "Packet not added");
+          added += size;
+        }
+      NS_TEST_ASSERT_MSG_EQ (buffer.Size (), added - acked, "Wrong buffer size");
+
+      // send a few segments from some point after the head
+      uint32_t from = acked + random->GetInteger (0, added - acked);
+      for (uint32_t segment = 0; segment < 4; segment++)
+        {
+          uint32_t length = random->GetInteger (1, 1500);
+          Ptr<Packet> p = buffer.CopyFromSequence (length, SequenceNumber32 (isn + from));
+          NS_TEST_ASSERT_MSG_EQ (p->GetSize (), std::min (length, added - from), "Wrong segment size");
+          NS_TEST_ASSERT_MSG_EQ (CheckStreamPacket (p, from), true, "Wrong segment data");
+          from += p->GetSize ();
+        }
+
+      uint32_t ack = acked + random->GetInteger (0, (added - acked) / 2);
+      buffer.DiscardUpTo (SequenceNumber32 (isn + ack));
+      acked = ack;
+      NS_TEST_ASSERT_MSG_EQ (buffer.HeadSequence (), SequenceNumber32 (isn + acked), "Wrong head sequence");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Check the data extracted from a TcpRxBuffer which receives overlapping
+ * segments out of order.
+ */
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("Check the data extracted from a TcpRxBuffer")
+{
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (2);
+  uint32_t isn = 0xffff0000;
+  TcpRxBuffer buffer (isn);
+  buffer.SetMaxBufferSize (65536);
+  uint32_t extracted = 0;
+
+  for (uint32_t step = 0; step < 20000; step++)
+    {
+      // a segment in the window, possibly overlapping received data
+      uint32_t next = buffer.NextRxSequence () - SequenceNumber32 (isn);
+      uint32_t start = next + random->GetInteger (0, 40000);
+      if (start >= 1000 && random->GetInteger (0, 3) == 0)
+        {
+          start -= 1000;
+        }
+      uint32_t size = random->GetInteger (1, 3000);
+      TcpHeader header;
+      header.SetSequenceNumber (SequenceNumber32 (isn + start));
+      buffer.Add (CreateStreamPacket (start, size), header);
+      NS_TEST_ASSERT_MSG_EQ ((buffer.NextRxSequence () - SequenceNumber32 (isn)) - extracted,
+                             buffer.Available (), "Wrong number of available bytes");
+
+      if (random->GetInteger (0, 1) == 0)
+        {
+          Ptr<Packet> p = buffer.Extract (random->GetInteger (1, 20000));
+          if (p != 0)
+            {
+              NS_TEST_ASSERT_MSG_EQ (CheckStreamPacket (p, extracted), true, "Wrong extracted data");
+              extracted += p->GetSize ();
+            }
+        }
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (buffer.Size (), 65536, "Buffer larger than the window");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TcpTxBuffer and TcpRxBuffer TestSuite
+ */
+class TcpBuffersTestSuite : public TestSuite
+{
+public:
+  TcpBuffersTestSuite ();
+};
+
+TcpBuffersTestSuite::TcpBuffersTestSuite ()
+  : TestSuite ("tcp-buffers", UNIT)
+{
+  AddTestCase (new TcpTxBufferTestCase (), TestCase::QUICK);
+  AddTestCase (new TcpRxBufferTestCase (), TestCase::QUICK);
+}
+
+static TcpBuffersTestSuite g_tcpBuffersTestSuite; //!< Static variable for test initialization
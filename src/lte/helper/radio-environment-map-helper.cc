@@ -37,9 +37,26 @@
 #include <ns3/node.h>
 #include <ns3/buildings-helper.h>
 #include <ns3/lte-spectrum-value-helper.h>
+#include <ns3/lte-spectrum-signal-parameters.h>
+#include <ns3/spectrum-converter.h>
+#include <ns3/propagation-loss-model.h>
+#include <ns3/jakes-propagation-loss-model.h>
+#include <ns3/spectrum-propagation-loss-model.h>
+#include <ns3/propagation-delay-model.h>
+#include <ns3/buildings-propagation-loss-model.h>
+#include <ns3/building-list.h>
+#include <ns3/antenna-model.h>
+#include <ns3/angles.h>
+#include <ns3/core-config.h>
+#ifdef HAVE_PTHREAD_H
+#include <ns3/system-thread.h>
+#include <ns3/system-mutex.h>
+#endif
 
 #include <fstream>
 #include <limits>
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -48,6 +65,8 @@ NS_LOG_COMPONENT_DEFINE ("RadioEnvironmentMapHelper");
 NS_OBJECT_ENSURE_REGISTERED (RadioEnvironmentMapHelper);
 
 RadioEnvironmentMapHelper::RadioEnvironmentMapHelper ()
+  : m_maxLossDb (std::numeric_limits<double>::infinity ()),
+    m_maxRange (0)
 {
 }
 
@@ -144,6 +163,27 @@ RadioEnvironmentMapHelper::GetTypeId (void)
                    IntegerValue (-1),
                    MakeIntegerAccessor (&RadioEnvironmentMapHelper::m_rbId),
                    MakeIntegerChecker<int32_t> ())
+    .AddAttribute ("DirectComputation",
+                   "If true, the SINR of every point is computed directly from "
+                   "the loss models of the channel for the signals transmitted "
+                   "while the first iteration would have been listening, instead "
+                   "of simulating the reception of the signals by "
+                   "MaxPointsPerIteration RemSpectrumPhys per iteration. "
+                   "The map is the same with deterministic loss models, but "
+                   "the PathLoss trace of the channel is not fired for its points.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RadioEnvironmentMapHelper::m_directComputation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Threads",
+                   "The number of threads computing the map when DirectComputation "
+                   "is true. The loss and antenna models of the channel must then be "
+                   "safe to use concurrently, as the models depending only on the "
+                   "positions are; a single thread is used when there are buildings, "
+                   "or with a buildings, random, Nakagami or Jakes loss model, or a "
+                   "spectrum propagation loss or propagation delay model.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RadioEnvironmentMapHelper::m_threads),
+                   MakeUintegerChecker<uint32_t> (1, 1024))
   ;
   return tid;
 }
@@ -220,6 +260,18 @@ RadioEnvironmentMapHelper::DelayedInstall ()
   NS_LOG_FUNCTION (this);
   m_xStep = (m_xMax - m_xMin)/(m_xRes-1);
   m_yStep = (m_yMax - m_yMin)/(m_yRes-1);
+
+  if (m_directComputation)
+    {
+      // listen to the channel while the first iteration would
+      m_captureEnd = Simulator::Now () + Seconds (0.0001) + Seconds (0.0005);
+      m_channel->TraceConnectWithoutContext ("TxSigParams",
+                                             MakeCallback (&RadioEnvironmentMapHelper::CaptureTransmission, this));
+      Simulator::Schedule (Seconds (0.0001) + Seconds (0.0005),
+                           &RadioEnvironmentMapHelper::ComputeDirectly,
+                           this);
+      return;
+    }
   
   if ((double)m_xRes * (double) m_yRes < (double) m_maxPointsPerIteration)
     {
@@ -352,4 +404,318 @@ RadioEnvironmentMapHelper::Finalize ()
 }
 
 
+void
+RadioEnvironmentMapHelper::CaptureTransmission (Ptr<SpectrumSignalParameters> params)
+{
+  NS_LOG_FUNCTION (this << params);
+  if (m_useDataChannel)
+    {
+      if (DynamicCast<LteSpectrumSignalParametersDataFrame> (params) == 0)
+        {
+          return;
+        }
+    }
+  else if (DynamicCast<LteSpectrumSignalParametersDlCtrlFrame> (params) == 0)
+    {
+      return;
+    }
+  Ptr<MobilityModel> mobility = params->txPhy->GetMobility ();
+  if (mobility == 0)
+    {
+      // not received by a RemSpectrumPhy, which always has a position
+      return;
+    }
+  RemTransmission tx;
+  tx.mobility = mobility;
+  tx.antenna = params->txAntenna;
+  Ptr<const SpectrumModel> model = LteSpectrumValueHelper::GetSpectrumModel (m_earfcn, m_bandwidth);
+  if (params->psd->GetSpectrumModelUid () == model->GetUid ())
+    {
+      tx.psd = params->psd;
+    }
+  else
+    {
+      SpectrumConverter converter (params->psd->GetSpectrumModel (), model);
+      tx.psd = converter.Convert (params->psd);
+    }
+  tx.start = Simulator::Now ();
+  m_transmissions.push_back (tx);
+}
+
+
+/**
+ * The state of a thread computing columns of the map.
+ */
+struct RadioEnvironmentMapHelper::RemWorker
+{
+  /// The columns left to compute, shared by the threads computing them.
+  struct ColumnQueue
+  {
+    uint32_t first;  //!< the index of the first column of the block
+    uint32_t next;   //!< the index of the next column to compute
+    uint32_t end;    //!< the index following the last column of the block
+    double *sinr;    //!< the SINR of the points of the block, by column
+#ifdef HAVE_PTHREAD_H
+    SystemMutex mutex; //!< protects next
+#endif
+  };
+
+  const RadioEnvironmentMapHelper *helper; //!< the map being computed
+  ColumnQueue *queue;                      //!< the columns to compute
+  Ptr<MobilityModel> rx;                   //!< the position of the point
+  std::vector<Ptr<MobilityModel> > tx;     //!< the positions of the transmitters
+  bool makeConsistent;                     //!< whether there are buildings
+  PropagationLossModel *loss;              //!< the loss model of the channel
+  SpectrumPropagationLossModel *spectrumLoss; //!< the spectrum loss model of the channel
+  PropagationDelayModel *delay;            //!< the delay model of the channel
+  std::vector<std::pair<Time, uint32_t> > arrivals; //!< the signals by time of arrival
+
+  /// Compute the columns of the queue until there are none left.
+  void ComputeQueuedColumns (void);
+};
+
+void
+RadioEnvironmentMapHelper::RemWorker::ComputeQueuedColumns (void)
+{
+  for (;;)
+    {
+      uint32_t i;
+      {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (queue->mutex);
+#endif
+        if (queue->next == queue->end)
+          {
+            return;
+          }
+        i = queue->next++;
+      }
+      helper->ComputeColumn (*this, helper->m_xs[i],
+                             queue->sinr + (i - queue->first) * helper->m_ys.size ());
+    }
+}
+
+void
+RadioEnvironmentMapHelper::ComputeColumn (RemWorker &worker, double x, double *sinr) const
+{
+  for (uint32_t j = 0; j < m_ys.size (); ++j)
+    {
+      worker.rx->SetPosition (Vector (x, m_ys[j], m_z));
+      if (worker.makeConsistent)
+        {
+          BuildingsHelper::MakeConsistent (worker.rx);
+        }
+      Vector rxPosition = worker.rx->GetPosition ();
+
+      // the signals are received by time of arrival, then of transmission
+      worker.arrivals.clear ();
+      for (uint32_t k = 0; k < m_transmissions.size (); ++k)
+        {
+          Time arrival = m_transmissions[k].start;
+          if (worker.delay)
+            {
+              arrival += worker.delay->GetDelay (worker.tx[k], worker.rx);
+            }
+          if (arrival < m_captureEnd)
+            {
+              worker.arrivals.push_back (std::make_pair (arrival, k));
+            }
+        }
+      if (worker.delay)
+        {
+          std::sort (worker.arrivals.begin (), worker.arrivals.end ());
+        }
+
+      // as the channel and RemSpectrumPhy would do
+      double sumPower = 0;
+      double referenceSignalPower = 0;
+      for (uint32_t a = 0; a < worker.arrivals.size (); ++a)
+        {
+          uint32_t k = worker.arrivals[a].second;
+          const RemTransmission &tx = m_transmissions[k];
+          Ptr<MobilityModel> txMobility = worker.tx[k];
+          if (m_maxRange > 0 && txMobility->GetDistanceFrom (worker.rx) > m_maxRange)
+            {
+              continue;
+            }
+          double pathLossDb = 0;
+          if (tx.antenna != 0)
+            {
+              Angles txAngles (rxPosition, txMobility->GetPosition ());
+              pathLossDb -= tx.antenna->GetGainDb (txAngles);
+            }
+          if (worker.loss)
+            {
+              pathLossDb -= worker.loss->CalcRxPower (0, txMobility, worker.rx);
+            }
+          if (pathLossDb > m_maxLossDb)
+            {
+              continue;
+            }
+          double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+
+          double power = 0;
+          if (worker.spectrumLoss)
+            {
+              Ptr<SpectrumValue> psd = Copy<SpectrumValue> (tx.psd);
+              *psd *= pathGainLinear;
+              psd = worker.spectrumLoss->CalcRxPowerSpectralDensity (psd, txMobility, worker.rx);
+              power = (m_rbId >= 0) ? (*psd)[m_rbId] * 180000 : Integral (*psd);
+            }
+          else if (m_rbId >= 0)
+            {
+              power = (*tx.psd)[m_rbId] * pathGainLinear * 180000;
+            }
+          else
+            {
+              Values::const_iterator vit = tx.psd->ConstValuesBegin ();
+              for (uint32_t b = 0; b < m_bandWidths.size (); ++b, ++vit)
+                {
+                  power += (*vit) * pathGainLinear * m_bandWidths[b];
+                }
+            }
+
+          sumPower += power;
+          if (power > referenceSignalPower)
+            {
+              referenceSignalPower = power;
+            }
+        }
+      sinr[j] = referenceSignalPower / (sumPower - referenceSignalPower + m_noisePower);
+    }
+}
+
+void
+RadioEnvironmentMapHelper::ComputeDirectly ()
+{
+  NS_LOG_FUNCTION (this);
+  m_channel->TraceDisconnectWithoutContext ("TxSigParams",
+                                            MakeCallback (&RadioEnvironmentMapHelper::CaptureTransmission, this));
+  NS_LOG_INFO ("computing the map from " << m_transmissions.size () << " signals");
+
+  for (double x = m_xMin; x < m_xMax + 0.5*m_xStep; x += m_xStep)
+    {
+      m_xs.push_back (x);
+    }
+  for (double y = m_yMin; y < m_yMax + 0.5*m_yStep; y += m_yStep)
+    {
+      m_ys.push_back (y);
+    }
+  Ptr<const SpectrumModel> model = LteSpectrumValueHelper::GetSpectrumModel (m_earfcn, m_bandwidth);
+  for (Bands::const_iterator it = model->Begin (); it != model->End (); ++it)
+    {
+      m_bandWidths.push_back (it->fh - it->fl);
+    }
+  DoubleValue maxLossDb;
+  if (m_channel->GetAttributeFailSafe ("MaxLossDb", maxLossDb))
+    {
+      m_maxLossDb = maxLossDb.Get ();
+    }
+  DoubleValue maxRange;
+  if (m_channel->GetAttributeFailSafe ("MaxRange", maxRange))
+    {
+      m_maxRange = maxRange.Get ();
+    }
+
+  Ptr<PropagationLossModel> loss = m_channel->GetPropagationLossModel ();
+  Ptr<SpectrumPropagationLossModel> spectrumLoss = m_channel->GetSpectrumPropagationLossModel ();
+  Ptr<PropagationDelayModel> delay = m_channel->GetPropagationDelayModel ();
+
+  // Reference counting is not thread-safe: each thread has its own
+  // positions, and the models which are not known to be safe to use
+  // concurrently are only used by a single thread.
+  // The models drawing random values are used by a single thread too,
+  // so that the points draw them in the same order at every run.
+  uint32_t nThreads = std::min<uint32_t> (m_threads, m_xs.size ());
+  bool buildings = BuildingList::GetNBuildings () > 0;
+  bool random = false;
+  for (Ptr<PropagationLossModel> l = loss; l != 0; l = l->GetNext ())
+    {
+      buildings = buildings || (DynamicCast<BuildingsPropagationLossModel> (l) != 0);
+      random = random
+        || (DynamicCast<RandomPropagationLossModel> (l) != 0)
+        || (DynamicCast<NakagamiPropagationLossModel> (l) != 0)
+        || (DynamicCast<JakesPropagationLossModel> (l) != 0);
+    }
+  if (nThreads > 1 && (buildings || random || spectrumLoss != 0 || delay != 0))
+    {
+      NS_LOG_WARN ("computing the map with a single thread");
+      nThreads = 1;
+    }
+#ifndef HAVE_PTHREAD_H
+  nThreads = 1;
+#endif
+
+  RemWorker::ColumnQueue queue;
+  std::vector<RemWorker> workers (nThreads);
+  for (uint32_t i = 0; i < nThreads; ++i)
+    {
+      RemWorker &worker = workers[i];
+      worker.helper = this;
+      worker.queue = &queue;
+      worker.rx = CreateObject<ConstantPositionMobilityModel> ();
+      worker.rx->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+      worker.makeConsistent = (nThreads == 1);
+      worker.loss = PeekPointer (loss);
+      worker.spectrumLoss = PeekPointer (spectrumLoss);
+      worker.delay = PeekPointer (delay);
+      for (uint32_t k = 0; k < m_transmissions.size (); ++k)
+        {
+          if (nThreads == 1)
+            {
+              worker.tx.push_back (m_transmissions[k].mobility);
+            }
+          else
+            {
+              Ptr<MobilityModel> tx = CreateObject<ConstantPositionMobilityModel> ();
+              tx->SetPosition (m_transmissions[k].mobility->GetPosition ());
+              tx->AggregateObject (CreateObject<MobilityBuildingInfo> ());
+              worker.tx.push_back (tx);
+            }
+        }
+    }
+
+  // the map is written by blocks of columns, computed by all the threads
+  uint32_t blockColumns = std::max<uint32_t> (1, m_maxPointsPerIteration / m_ys.size ());
+  std::vector<double> sinr (std::min<uint32_t> (blockColumns, m_xs.size ()) * m_ys.size ());
+  for (uint32_t first = 0; first < m_xs.size (); first += blockColumns)
+    {
+      queue.first = first;
+      queue.next = first;
+      queue.end = std::min<uint32_t> (first + blockColumns, m_xs.size ());
+      queue.sinr = &sinr[0];
+#ifdef HAVE_PTHREAD_H
+      std::vector<Ptr<SystemThread> > threads;
+      for (uint32_t i = 1; i < nThreads; ++i)
+        {
+          threads.push_back (Create<SystemThread> (MakeCallback (&RemWorker::ComputeQueuedColumns, &workers[i])));
+          threads.back ()->Start ();
+        }
+#endif
+      workers[0].ComputeQueuedColumns ();
+#ifdef HAVE_PTHREAD_H
+      for (uint32_t i = 0; i < threads.size (); ++i)
+        {
+          threads[i]->Join ();
+        }
+#endif
+      for (uint32_t i = first; i < queue.end; ++i)
+        {
+          const double *column = &sinr[(i - first) * m_ys.size ()];
+          for (uint32_t j = 0; j < m_ys.size (); ++j)
+            {
+              m_outFile << m_xs[i] << "\t"
+                        << m_ys[j] << "\t"
+                        << m_z << "\t"
+                        << column[j]
+                        << "\n";
+            }
+        }
+    }
+
+  m_transmissions.clear ();
+  Finalize ();
+}
+
+
 } // namespace ns3
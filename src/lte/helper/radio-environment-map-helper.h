@@ -24,7 +24,9 @@
 
 
 #include <ns3/object.h>
+#include <ns3/nstime.h>
 #include <fstream>
+#include <vector>
 
 
 namespace ns3 {
@@ -35,6 +37,9 @@ class NetDevice;
 class SpectrumChannel;
 //class BuildingsMobilityModel;
 class MobilityModel;
+class SpectrumSignalParameters;
+class SpectrumValue;
+class AntennaModel;
 
 /** 
  * \ingroup lte
@@ -108,6 +113,35 @@ private:
   /// Called when the map generation procedure has been completed.
   void Finalize ();
 
+  /**
+   * Connected to the `TxSigParams` trace of the channel when the map is
+   * computed directly: keep the signals which a RemSpectrumPhy would take
+   * into account.
+   *
+   * \param params the parameters of the signal being transmitted
+   */
+  void CaptureTransmission (Ptr<SpectrumSignalParameters> params);
+
+  /**
+   * Scheduled by DelayedInstall() when the map is computed directly, at the
+   * time the first iteration would have written its points: compute the
+   * SINR of every point from the captured signals, writing the map by
+   * blocks of at most `MaxPointsPerIteration` points, then call Finalize().
+   */
+  void ComputeDirectly ();
+
+  struct RemWorker;
+
+  /**
+   * Compute the SINR of the points of a column of the map, as RemSpectrumPhy
+   * would receive the captured signals through the channel.
+   *
+   * \param worker the positions used by the calling thread
+   * \param x the X coordinate of the column
+   * \param sinr where to write the SINR of the points of the column
+   */
+  void ComputeColumn (RemWorker &worker, double x, double *sinr) const;
+
   /// A complete Radio Environment Map is composed of many of this structure.
   struct RemPoint 
   {
@@ -152,6 +186,37 @@ private:
   bool m_useDataChannel;  ///< The `UseDataChannel` attribute.
   int32_t m_rbId;         ///< The `RbId` attribute.
 
+  bool m_directComputation;  ///< The `DirectComputation` attribute.
+  uint32_t m_threads;        ///< The `Threads` attribute.
+
+  /// A signal captured for the direct computation of the map.
+  struct RemTransmission
+  {
+    /// Position of the transmitter.
+    Ptr<MobilityModel> mobility;
+    /// Antenna of the transmitter, if any.
+    Ptr<AntennaModel> antenna;
+    /// PSD of the signal, in the spectrum model of the map.
+    Ptr<const SpectrumValue> psd;
+    /// Start of the transmission.
+    Time start;
+  };
+
+  /// Signals captured for the direct computation of the map.
+  std::vector<RemTransmission> m_transmissions;
+  /// End of the capture of the signals.
+  Time m_captureEnd;
+  /// X coordinates of the columns of the map.
+  std::vector<double> m_xs;
+  /// Y coordinates of the points of a column of the map.
+  std::vector<double> m_ys;
+  /// Width in Hz of the bands of the spectrum model of the map.
+  std::vector<double> m_bandWidths;
+  /// The `MaxLossDb` attribute of the channel, if any.
+  double m_maxLossDb;
+  /// The `MaxRange` attribute of the channel, if any.
+  double m_maxRange;
+
 }; // end of `class RadioEnvironmentMapHelper`
 
 
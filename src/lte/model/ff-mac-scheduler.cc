@@ -66,6 +66,23 @@ FfMacScheduler::GetTypeId (void)
   return tid;
 }
 
+int
+FfMacScheduler::CountActiveLcs (const RlcBufferReqMap_t &rlcBufferReq, uint16_t rnti)
+{
+  int lcActive = 0;
+  for (RlcBufferReqMap_t::const_iterator it = rlcBufferReq.lower_bound (LteFlowId_t (rnti, 0));
+       it != rlcBufferReq.end () && (*it).first.m_rnti == rnti; it++)
+    {
+      if (((*it).second.m_rlcTransmissionQueueSize > 0)
+          || ((*it).second.m_rlcRetransmissionQueueSize > 0)
+          || ((*it).second.m_rlcStatusPduSize > 0))
+        {
+          lcActive++;
+        }
+    }
+  return (lcActive);
+}
+
 
 } // namespace ns3
 
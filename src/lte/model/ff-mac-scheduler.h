@@ -23,6 +23,9 @@
 #define FF_MAC_SCHEDULER_H
 
 #include <ns3/object.h>
+#include <ns3/lte-common.h>
+#include <ns3/ff-mac-sched-sap.h>
+#include <map>
 
 
 namespace ns3 {
@@ -125,7 +128,19 @@ public:
   virtual LteFfrSapUser* GetLteFfrSapUser () = 0;
   
 protected:
-    
+  /// The DL RLC buffer status of the flows, by RNTI and LCID
+  typedef std::map <LteFlowId_t, FfMacSchedSapProvider::SchedDlRlcBufferReqParameters> RlcBufferReqMap_t;
+
+  /**
+   * Count the logical channels of a UE with data to transmit.  The flows
+   * of the UE are contiguous in the map, so only they are visited.
+   *
+   * \param rlcBufferReq the DL RLC buffer status of the flows
+   * \param rnti the RNTI of the UE
+   * \return the number of logical channels of the UE with data to transmit
+   */
+  static int CountActiveLcs (const RlcBufferReqMap_t &rlcBufferReq, uint16_t rnti);
+
   UlCqiFilter_t m_ulCqiFilter;
 
 };
@@ -63,7 +63,7 @@ LteChunkProcessor::EvaluateChunk (const SpectrumValue& sinr, Time duration)
     {
       m_sumValues = Create<SpectrumValue> (sinr.GetSpectrumModel ());
     }
-  (*m_sumValues) += sinr * duration.GetSeconds ();
+  m_sumValues->AddProduct (sinr, duration.GetSeconds ());
   m_totDuration += duration;
 }
 
@@ -23,6 +23,7 @@
 #include <ns3/log.h>
 #include <cfloat>
 #include <cmath>
+#include <algorithm>
 #include <ns3/simulator.h>
 #include <ns3/attribute-accessor-helper.h>
 #include <ns3/double.h>
@@ -240,6 +241,7 @@ LteEnbPhy::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_ueAttached.clear ();
   m_srsUeOffset.clear ();
+  m_txPsd = 0;
   delete m_enbPhySapProvider;
   delete m_enbCphySapProvider;
   LtePhy::DoDispose ();
@@ -438,8 +440,15 @@ LteEnbPhy::SetDownlinkSubChannels (std::vector<int> mask)
 {
   NS_LOG_FUNCTION (this);
   m_listOfDownlinkSubchannel = mask;
-  Ptr<SpectrumValue> txPsd = CreateTxPowerSpectralDensity ();
-  m_downlinkSpectrumPhy->SetTxPowerSpectralDensity (txPsd);
+  // the control frame of every subframe uses the whole band: reuse its
+  // PSD as long as the mask and the power are the same
+  if (m_txPsd == 0 || mask != m_txPsdMask || m_txPower != m_txPsdPower)
+    {
+      m_txPsd = CreateTxPowerSpectralDensity ();
+      m_txPsdMask = mask;
+      m_txPsdPower = m_txPower;
+    }
+  m_downlinkSpectrumPhy->SetTxPowerSpectralDensity (m_txPsd);
 }
 
 void
@@ -890,6 +899,7 @@ LteEnbPhy::DoSetBandwidth (uint8_t ulBandwidth, uint8_t dlBandwidth)
   NS_LOG_FUNCTION (this << (uint32_t) ulBandwidth << (uint32_t) dlBandwidth);
   m_ulBandwidth = ulBandwidth;
   m_dlBandwidth = dlBandwidth;
+  m_txPsd = 0;
 
   static const int Type0AllocationRbg[4] = {
     10,     // RGB size 1
@@ -913,6 +923,7 @@ LteEnbPhy::DoSetEarfcn (uint16_t ulEarfcn, uint16_t dlEarfcn)
   NS_LOG_FUNCTION (this << ulEarfcn << dlEarfcn);
   m_ulEarfcn = ulEarfcn;
   m_dlEarfcn = dlEarfcn;
+  m_txPsd = 0;
 }
 
 
@@ -1035,22 +1046,11 @@ std::list<UlDciLteControlMessage>
 LteEnbPhy::DequeueUlDci (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_ulDciQueue.at (0).size ()>0)
-    {
-      std::list<UlDciLteControlMessage> ret = m_ulDciQueue.at (0);
-      m_ulDciQueue.erase (m_ulDciQueue.begin ());
-      std::list<UlDciLteControlMessage> l;
-      m_ulDciQueue.push_back (l);
-      return (ret);
-    }
-  else
-    {
-      m_ulDciQueue.erase (m_ulDciQueue.begin ());
-      std::list<UlDciLteControlMessage> l;
-      m_ulDciQueue.push_back (l);
-      std::list<UlDciLteControlMessage> emptylist;
-      return (emptylist);
-    }
+  std::list<UlDciLteControlMessage> ret;
+  ret.swap (m_ulDciQueue.at (0));
+  // the head of the queue, now empty, becomes its tail
+  std::rotate (m_ulDciQueue.begin (), m_ulDciQueue.begin () + 1, m_ulDciQueue.end ());
+  return (ret);
 }
 
 void
@@ -358,6 +358,13 @@ private:
    */
   std::vector <int> m_listOfDownlinkSubchannel;
 
+  /// The PSD of the control frames, reused while the mask and power are the same.
+  Ptr<SpectrumValue> m_txPsd;
+  /// The mask of m_txPsd.
+  std::vector <int> m_txPsdMask;
+  /// The power of m_txPsd, in dBm.
+  double m_txPsdPower;
+
   std::vector <int> m_dlDataRbMap;
 
   /// For storing info on future receptions.
@@ -135,6 +135,12 @@ private:
 
   Ptr<const SpectrumValue> m_noise;
 
+  SpectrumValue m_interf; /**< scratch storage of the interference
+                           * plus noise of a chunk
+                           */
+
+  SpectrumValue m_sinr; /**< scratch storage of the SINR of a chunk */
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
@@ -36,7 +36,7 @@
 #include <ns3/pointer.h>
 #include <stdint.h>
 #include <cmath>
-#include <stdint.h>
+#include <limits>
 #include "stdlib.h"
 #include <ns3/lte-mi-error-model.h>
 
@@ -323,83 +323,132 @@ static const double cEcrTable [9][38] = {
 };
 
 
-double 
-LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+/**
+ * \param sinrLin the SINR of a RB, in linear units
+ * \param mcs the MCS of the TB
+ * \return the MI of the RB for the modulation of the MCS
+ */
+static double
+MiOfRb (double sinrLin, uint8_t mcs)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
-  
   double MI;
-  double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  
-  for (uint32_t i = 0; i < map.size (); i++)
+  if (mcs <= MI_QPSK_MAX_ID) // QPSK
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MI_QPSK_MAX_ID) // QPSK
-        {
 
-          if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
+      if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
+        {
+          MI = 1;
+        }
+      else 
+        { 
+          // since the values in MI_map_qpsk_axis are uniformly spaced, we have
+          // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+          // the scaling coefficient is always the same, so we use a static const
+          // to speed up the calculation
+          static const double scalingCoeffQpsk = 
+            (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
+          double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
+          uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
+          NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
+          MI = MI_map_qpsk[sinrIndex];
+        }
+    }
+  else
+    {
+      if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+        {
+          if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
             {
               MI = 1;
             }
           else 
-            { 
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
+            {
+              // since the values in MI_map_16QAM_axis are uniformly spaced, we have
               // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
               // the scaling coefficient is always the same, so we use a static const
               // to speed up the calculation
-              static const double scalingCoeffQpsk = 
-                (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
+              static const double scalingCoeff16qam = 
+                (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
+              double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
               uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
+              NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
+              MI = MI_map_16qam[sinrIndex];
             }
         }
-      else
+      else // 64-QAM
         {
-          if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+          if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
             {
-              if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else 
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam = 
-                    (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
+              MI = 1;
             }
-          else // 64-QAM
+          else
             {
-              if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam = 
-                    (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
+              // since the values in MI_map_64QAM_axis are uniformly spaced, we have
+              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+              // the scaling coefficient is always the same, so we use a static const
+              // to speed up the calculation
+              static const double scalingCoeff64qam = 
+                (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
+              double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
+              uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
+              NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
+              MI = MI_map_64qam[sinrIndex];
             }
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+    }
+  return MI;
+}
+
+
+LteMiPerRb::LteMiPerRb ()
+{
+}
+
+void
+LteMiPerRb::SetSinr (const SpectrumValue& sinr)
+{
+  m_sinr.assign (sinr.ConstValuesBegin (), sinr.ConstValuesEnd ());
+  for (uint8_t m = 0; m < 3; m++)
+    {
+      m_mi[m].assign (m_sinr.size (), -1.0);
+    }
+}
+
+double
+LteMiPerRb::GetSinr (int rb) const
+{
+  return m_sinr.at (rb);
+}
+
+double
+LteMiPerRb::GetMi (int rb, uint8_t mcs)
+{
+  uint8_t m = mcs <= MI_QPSK_MAX_ID ? 0 : (mcs <= MI_16QAM_MAX_ID ? 1 : 2);
+  double &mi = m_mi[m].at (rb);
+  if (mi < 0.0)
+    {
+      mi = MiOfRb (m_sinr[rb], mcs);
+    }
+  return mi;
+}
+
+
+double 
+LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
+  
+  double MI;
+  double MIsum = 0.0;
+  Values::const_iterator sinrBegin = sinr.ConstValuesBegin ();
+  int nRb = sinr.ConstValuesEnd () - sinrBegin;
+  
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      NS_ASSERT_MSG (map[i] >= 0 && map[i] < nRb, "RB " << map[i] << " out of the " << nRb << " RBs of the SINR");
+      double sinrLin = sinrBegin[map[i]];
+      MI = MiOfRb (sinrLin, mcs);
+      NS_LOG_LOGIC (" RB " << map[i] << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
       MIsum += MI;
     }
   MI = MIsum / map.size ();
@@ -407,6 +456,20 @@ LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, ui
   return MI;
 }
 
+double 
+LteMiErrorModel::Mib (LteMiPerRb& mi, const std::vector<int>& map, uint8_t mcs)
+{
+  NS_LOG_FUNCTION (&mi << &map << (uint32_t) mcs);
+  double MIsum = 0.0;
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      MIsum += mi.GetMi (map[i], mcs);
+    }
+  double MI = MIsum / map.size ();
+  NS_LOG_LOGIC (" MI = " << MI);
+  return MI;
+}
+
 
 double 
 LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
@@ -460,11 +523,10 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
   NS_LOG_FUNCTION (sinr);
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  Values::iterator sinrIt = sinrCopy.ValuesBegin ();
+  Values::const_iterator sinrIt = sinr.ConstValuesBegin ();
   uint16_t rb = 0;
-  NS_ASSERT (sinrIt!=sinrCopy.ValuesEnd ());
-  while (sinrIt!=sinrCopy.ValuesEnd ())
+  NS_ASSERT (sinrIt!=sinr.ConstValuesEnd ());
+  while (sinrIt!=sinr.ConstValuesEnd ())
     {
       double sinrLin = *sinrIt;
       if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
@@ -546,11 +608,22 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
 
 
 TbStats_t
-LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory)
+LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+  return GetTbStats (Mib (sinr, map, mcs), size, mcs, miHistory);
+}
+
+TbStats_t
+LteMiErrorModel::GetTbDecodificationStats (LteMiPerRb& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
+{
+  NS_LOG_FUNCTION (&mi << &map << (uint32_t) size << (uint32_t) mcs);
+  return GetTbStats (Mib (mi, map, mcs), size, mcs, miHistory);
+}
 
-  double tbMi = Mib(sinr, map, mcs);
+TbStats_t
+LteMiErrorModel::GetTbStats (double tbMi, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
+{
   double MI = 0.0;
   double Reff = 0.0;
   NS_ASSERT (mcs < 29);
@@ -733,6 +806,68 @@ LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std:
 }
 
 
+LteMiErrorModelCache::LteMiErrorModelCache ()
+  : m_resolution (0.0)
+{
+}
+
+void
+LteMiErrorModelCache::SetResolution (double resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  m_resolution = resolution;
+  m_stats.clear ();
+}
+
+double
+LteMiErrorModelCache::GetResolution (void) const
+{
+  return m_resolution;
+}
+
+TbStats_t
+LteMiErrorModelCache::GetTbDecodificationStats (LteMiPerRb& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs)
+{
+  NS_LOG_FUNCTION (this << &mi << &map << (uint32_t) size << (uint32_t) mcs);
+  HarqProcessInfoList_t noHistory;
+  if (m_resolution <= 0.0)
+    {
+      return LteMiErrorModel::GetTbDecodificationStats (mi, map, size, mcs, noHistory);
+    }
+  // bound the memory used when the channel is not static after all
+  static const uint32_t maxEntries = 100000;
+  if (m_stats.size () >= maxEntries)
+    {
+      NS_LOG_LOGIC ("cache full, flushed");
+      m_stats.clear ();
+    }
+  m_key.clear ();
+  m_key.push_back (size);
+  m_key.push_back (mcs);
+  for (uint32_t i = 0; i < map.size (); i++)
+    {
+      double sinr = mi.GetSinr (map[i]);
+      // no signal gets its own interval
+      int32_t q = std::numeric_limits<int32_t>::min ();
+      if (sinr > 0.0)
+        {
+          q = static_cast<int32_t> (std::floor (10 * std::log10 (sinr) / m_resolution));
+        }
+      m_key.push_back (map[i]);
+      m_key.push_back (q);
+    }
+  std::map<Key_t, TbStats_t>::iterator it = m_stats.find (m_key);
+  if (it != m_stats.end ())
+    {
+      NS_LOG_LOGIC ("cached TBLER " << it->second.tbler);
+      return it->second;
+    }
+  TbStats_t stats = LteMiErrorModel::GetTbDecodificationStats (mi, map, size, mcs, noHistory);
+  m_stats.insert (std::make_pair (m_key, stats));
+  return stats;
+}
+
+
   
 
 } // namespace ns3
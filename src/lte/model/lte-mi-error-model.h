@@ -34,6 +34,7 @@
 
 
 #include <list>
+#include <map>
 #include <vector>
 #include <ns3/ptr.h>
 #include <stdint.h>
@@ -63,6 +64,43 @@ struct TbStats_t
 };
   
 
+/**
+ * The mutual information of the RBs of a subframe, for the SINR perceived
+ * in the subframe.
+ *
+ * The MI of a RB for a modulation is looked up in the MI map the first
+ * time a TB with this modulation spans the RB, then it is reused by the
+ * other TBs and MCSs evaluated against the same SINR.  The MIs are kept
+ * in one contiguous vector per modulation, and the vectors keep their
+ * storage from one subframe to the next.
+ */
+class LteMiPerRb
+{
+public:
+  LteMiPerRb ();
+
+  /**
+   * \brief set the SINR of the subframe, and forget the MIs of the previous one
+   * \param sinr the perceived sinrs in the whole bandwidth
+   */
+  void SetSinr (const SpectrumValue& sinr);
+  /**
+   * \param rb the index of the RB
+   * \return the SINR of the RB, in linear units
+   */
+  double GetSinr (int rb) const;
+  /**
+   * \param rb the index of the RB
+   * \param mcs the MCS of the TB
+   * \return the MI of the RB for the modulation of the MCS
+   */
+  double GetMi (int rb, uint8_t mcs);
+
+private:
+  std::vector<double> m_sinr;  ///< the SINR of the RBs
+  std::vector<double> m_mi[3]; ///< the MI of the RBs for QPSK, 16-QAM and 64-QAM, negative if not looked up yet
+};
+
 
 /**
  * This class provides the BLER estimation based on mutual information metrics
@@ -80,6 +118,14 @@ public:
    * \return the mmib
    */
   static double Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs);
+  /**
+   * \brief find the mmib of the specified TB, reusing the MIs of its RBs
+   * \param mi the MI of the RBs of the subframe
+   * \param map the actives RBs for the TB
+   * \param mcs the MCS of the TB
+   * \return the mmib
+   */
+  static double Mib (LteMiPerRb& mi, const std::vector<int>& map, uint8_t mcs);
   /** 
    * \brief map the mmib (mean mutual information per bit) for different MCS
    * \param mib mean mutual information per bit of a code-block
@@ -98,7 +144,18 @@ public:
    * \param miHistory  MI of past transmissions (in case of retx)
    * \return the TB error rate and MI
    */
-  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory);
+  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
+  /**
+   * \brief run the error-model algorithm for the specified TB, reusing the
+   * MIs of its RBs; meant for the TBs received in the same subframe
+   * \param mi the MI of the RBs of the subframe
+   * \param map the actives RBs for the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory  MI of past transmissions (in case of retx)
+   * \return the TB error rate and MI
+   */
+  static TbStats_t GetTbDecodificationStats (LteMiPerRb& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
   
   /** 
   * \brief run the error-model algorithm for the specified PCFICH+PDCCH channels
@@ -107,11 +164,61 @@ public:
   */  
   static double GetPcfichPdcchError (const SpectrumValue& sinr);
 
+private:
+  /**
+   * \brief run the error-model algorithm for the specified TB, once its mmib is known
+   * \param tbMi the mmib of the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \param miHistory  MI of past transmissions (in case of retx)
+   * \return the TB error rate and MI
+   */
+  static TbStats_t GetTbStats (double tbMi, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
+};
+
+
+/**
+ * A cache of the decodification statistics of the first transmissions of
+ * the TBs, for static channels.
+ *
+ * The TBs of the same size and MCS, spanning the same RBs, whose SINRs
+ * fall in the same intervals of the resolution (in dB) share the
+ * statistics of the first of them evaluated.  The statistics are thus
+ * approximated within the resolution, so the cache is disabled unless a
+ * positive resolution is set.
+ */
+class LteMiErrorModelCache
+{
+public:
+  LteMiErrorModelCache ();
 
-//private:
+  /**
+   * \param resolution the width of the SINR intervals, in dB; 0 disables the cache
+   */
+  void SetResolution (double resolution);
+  /**
+   * \return the width of the SINR intervals, in dB
+   */
+  double GetResolution (void) const;
 
+  /**
+   * \brief run the error-model algorithm for the first transmission of the
+   * specified TB, unless the statistics of a similar TB are cached
+   * \param mi the MI of the RBs of the subframe
+   * \param map the actives RBs for the TB
+   * \param size the size in bytes of the TB
+   * \param mcs the MCS of the TB
+   * \return the TB error rate and MI
+   */
+  TbStats_t GetTbDecodificationStats (LteMiPerRb& mi, const std::vector<int>& map, uint16_t size, uint8_t mcs);
 
+private:
+  /// the TB size, the MCS, then the RBs and their quantized SINR
+  typedef std::vector<int32_t> Key_t;
 
+  double m_resolution;                 ///< the width of the SINR intervals, in dB
+  std::map<Key_t, TbStats_t> m_stats;  ///< the statistics of the TBs evaluated
+  Key_t m_key;                         ///< the key of the TB being evaluated, kept to reuse its storage
 };
 
 
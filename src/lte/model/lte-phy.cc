@@ -23,6 +23,7 @@
 #include <ns3/object-factory.h>
 #include <ns3/log.h>
 #include <cmath>
+#include <algorithm>
 #include <ns3/simulator.h>
 #include "ns3/spectrum-error-model.h"
 #include "lte-phy.h"
@@ -194,19 +195,16 @@ LtePhy::SetMacPdu (Ptr<Packet> p)
 Ptr<PacketBurst>
 LtePhy::GetPacketBurst (void)
 {
+  Ptr<PacketBurst> ret;
   if (m_packetBurstQueue.at (0)->GetSize () > 0)
     {
-      Ptr<PacketBurst> ret = m_packetBurstQueue.at (0)->Copy ();
-      m_packetBurstQueue.erase (m_packetBurstQueue.begin ());
-      m_packetBurstQueue.push_back (CreateObject <PacketBurst> ());
-      return (ret);
-    }
-  else
-    {
-      m_packetBurstQueue.erase (m_packetBurstQueue.begin ());
-      m_packetBurstQueue.push_back (CreateObject <PacketBurst> ());
-      return (0);
+      ret = m_packetBurstQueue.at (0)->Copy ();
+      m_packetBurstQueue.at (0) = CreateObject <PacketBurst> ();
     }
+  // the head of the queue, now empty, becomes its tail: an idle TTI
+  // allocates nothing
+  std::rotate (m_packetBurstQueue.begin (), m_packetBurstQueue.begin () + 1, m_packetBurstQueue.end ());
+  return (ret);
 }
 
 
@@ -222,22 +220,11 @@ std::list<Ptr<LteControlMessage> >
 LtePhy::GetControlMessages (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_controlMessagesQueue.at (0).size () > 0)
-    {
-      std::list<Ptr<LteControlMessage> > ret = m_controlMessagesQueue.at (0);
-      m_controlMessagesQueue.erase (m_controlMessagesQueue.begin ());
-      std::list<Ptr<LteControlMessage> > newlist;
-      m_controlMessagesQueue.push_back (newlist);
-      return (ret);
-    }
-  else
-    {
-      m_controlMessagesQueue.erase (m_controlMessagesQueue.begin ());
-      std::list<Ptr<LteControlMessage> > newlist;
-      m_controlMessagesQueue.push_back (newlist);
-      std::list<Ptr<LteControlMessage> > emptylist;
-      return (emptylist);
-    }
+  std::list<Ptr<LteControlMessage> > ret;
+  ret.swap (m_controlMessagesQueue.at (0));
+  // the head of the queue, now empty, becomes its tail
+  std::rotate (m_controlMessagesQueue.begin (), m_controlMessagesQueue.begin () + 1, m_controlMessagesQueue.end ());
+  return (ret);
 }
 
 
@@ -223,6 +223,15 @@ LteSpectrumPhy::GetTypeId (void)
                     BooleanValue (true),
                     MakeBooleanAccessor (&LteSpectrumPhy::m_ctrlErrorModelEnabled),
                     MakeBooleanChecker ())
+    .AddAttribute ("DataErrorModelCacheResolution",
+                   "The SINR resolution (dB) of the cache of the error model of data, for static channels: "
+                   "the first transmissions of TBs of the same size and MCS, on the same RBs, with SINRs "
+                   "in the same intervals of this width share the same error rate.  0 disables the cache "
+                   "[by default is disabled].",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&LteSpectrumPhy::SetDataErrorModelCacheResolution,
+                                       &LteSpectrumPhy::GetDataErrorModelCacheResolution),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("DlPhyReception",
                      "DL reception PHY layer statistics.",
                      MakeTraceSourceAccessor (&LteSpectrumPhy::m_dlPhyReception),
@@ -947,6 +956,10 @@ LteSpectrumPhy::EndRxData ()
   NS_LOG_DEBUG (this << " txMode " << (uint16_t)m_transmissionMode << " gain " << m_txModeGain.at (m_transmissionMode));
   NS_ASSERT (m_transmissionMode < m_txModeGain.size ());
   m_sinrPerceived *= m_txModeGain.at (m_transmissionMode);
+  if ((m_dataErrorModelEnabled)&&(m_rxPacketBurstList.size ()>0))
+    {
+      m_miPerRb.SetSinr (m_sinrPerceived);
+    }
   
   while (itTb!=m_expectedTbs.end ())
     {
@@ -967,7 +980,15 @@ LteSpectrumPhy::EndRxData ()
                   harqInfoList = m_harqPhyModule->GetHarqProcessInfoUl ((*itTb).first.m_rnti, ulHarqId);
                 }
             }
-          TbStats_t tbStats = LteMiErrorModel::GetTbDecodificationStats (m_sinrPerceived, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList);
+          TbStats_t tbStats;
+          if (harqInfoList.empty ())
+            {
+              tbStats = m_miErrorModelCache.GetTbDecodificationStats (m_miPerRb, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs);
+            }
+          else
+            {
+              tbStats = LteMiErrorModel::GetTbDecodificationStats (m_miPerRb, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList);
+            }
           (*itTb).second.mi = tbStats.mi;
           (*itTb).second.corrupt = m_random->GetValue () > tbStats.tbler ? false : true;
           NS_LOG_DEBUG (this << "RNTI " << (*itTb).first.m_rnti << " size " << (*itTb).second.size << " mcs " << (uint32_t)(*itTb).second.mcs << " bitmap " << (*itTb).second.rbBitmap.size () << " layer " << (uint16_t)(*itTb).first.m_layer << " TBLER " << tbStats.tbler << " corrupted " << (*itTb).second.corrupt);
@@ -1262,6 +1283,19 @@ LteSpectrumPhy::SetTxModeGain (uint8_t txMode, double gain)
   }
 }
 
+void
+LteSpectrumPhy::SetDataErrorModelCacheResolution (double resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  m_miErrorModelCache.SetResolution (resolution);
+}
+
+double
+LteSpectrumPhy::GetDataErrorModelCacheResolution (void) const
+{
+  return m_miErrorModelCache.GetResolution ();
+}
+
 int64_t
 LteSpectrumPhy::AssignStreams (int64_t stream)
 {
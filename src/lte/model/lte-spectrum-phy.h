@@ -41,6 +41,7 @@
 #include <ns3/ff-mac-common.h>
 #include <ns3/lte-harq-phy.h>
 #include <ns3/lte-common.h>
+#include <ns3/lte-mi-error-model.h>
 
 namespace ns3 {
 
@@ -429,6 +430,14 @@ private:
   void EndRxUlSrs ();
   
   void SetTxModeGain (uint8_t txMode, double gain);
+  /**
+   * \param resolution the SINR resolution of the cache of TB statistics, in dB
+   */
+  void SetDataErrorModelCacheResolution (double resolution);
+  /**
+   * \return the SINR resolution of the cache of TB statistics, in dB
+   */
+  double GetDataErrorModelCacheResolution (void) const;
   
 
   Ptr<MobilityModel> m_mobility;
@@ -470,6 +479,8 @@ private:
   
   expectedTbs_t m_expectedTbs;
   SpectrumValue m_sinrPerceived;
+  LteMiPerRb m_miPerRb; // the MI of the RBs, shared by the TBs of a subframe
+  LteMiErrorModelCache m_miErrorModelCache; // the TB statistics cached for static channels
 
   /// Provides uniform random variables.
   Ptr<UniformRandomVariable> m_random;
@@ -25,6 +25,7 @@
 #include <ns3/node.h>
 #include <cfloat>
 #include <cmath>
+#include <algorithm>
 #include <ns3/simulator.h>
 #include <ns3/double.h>
 #include "lte-ue-phy.h"
@@ -178,6 +179,7 @@ void
 LteUePhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
+  m_txPsd = 0;
   delete m_uePhySapProvider;
   delete m_ueCphySapProvider;
   LtePhy::DoDispose ();
@@ -429,8 +431,15 @@ LteUePhy::SetSubChannelsForTransmission (std::vector <int> mask)
 
   m_subChannelsForTransmission = mask;
 
-  Ptr<SpectrumValue> txPsd = CreateTxPowerSpectralDensity ();
-  m_uplinkSpectrumPhy->SetTxPowerSpectralDensity (txPsd);
+  // the mask is set every subframe, and is empty while the UE is idle:
+  // reuse the PSD as long as the mask and the power are the same
+  if (m_txPsd == 0 || mask != m_txPsdMask || m_txPower != m_txPsdPower)
+    {
+      m_txPsd = CreateTxPowerSpectralDensity ();
+      m_txPsdMask = mask;
+      m_txPsdPower = m_txPower;
+    }
+  m_uplinkSpectrumPhy->SetTxPowerSpectralDensity (m_txPsd);
 }
 
 
@@ -1086,15 +1095,14 @@ LteUePhy::SubframeIndication (uint32_t frameNo, uint32_t subframeNo)
   if (m_ulConfigured)
     {
       // update uplink transmission mask according to previous UL-CQIs
-      std::vector <int> rbMask = m_subChannelsForTransmissionQueue.at (0);
-      SetSubChannelsForTransmission (m_subChannelsForTransmissionQueue.at (0));
+      std::vector <int> rbMask;
+      rbMask.swap (m_subChannelsForTransmissionQueue.at (0));
+      SetSubChannelsForTransmission (rbMask);
 
-      // shift the queue
-      for (uint8_t i = 1; i < m_macChTtiDelay; i++)
-        {
-          m_subChannelsForTransmissionQueue.at (i-1) = m_subChannelsForTransmissionQueue.at (i);
-        }
-      m_subChannelsForTransmissionQueue.at (m_macChTtiDelay-1).clear ();
+      // shift the queue: its head, now empty, becomes its tail
+      std::rotate (m_subChannelsForTransmissionQueue.begin (),
+                   m_subChannelsForTransmissionQueue.begin () + 1,
+                   m_subChannelsForTransmissionQueue.end ());
 
       if (m_srsConfigured && (m_srsStartTime <= Simulator::Now ()))
         {
@@ -1298,6 +1306,7 @@ LteUePhy::DoConfigureUplink (uint16_t ulEarfcn, uint8_t ulBandwidth)
   m_ulEarfcn = ulEarfcn;
   m_ulBandwidth = ulBandwidth;
   m_ulConfigured = true;
+  m_txPsd = 0;
 }
 
 void
@@ -328,6 +328,12 @@ private:
 
   /// A list of sub channels to use in TX.
   std::vector <int> m_subChannelsForTransmission;
+  /// The PSD of the transmissions, reused while the mask and power are the same.
+  Ptr<SpectrumValue> m_txPsd;
+  /// The mask of m_txPsd.
+  std::vector <int> m_txPsdMask;
+  /// The power of m_txPsd, in dBm.
+  double m_txPsdPower;
   /// A list of sub channels to use in RX.
   std::vector <int> m_subChannelsForReception;
 
@@ -259,6 +259,16 @@ private:
 
   std::map <uint16_t,uint8_t> m_uesTxMode; // txMode of the UEs
 
+  /// A UE which may be allocated RBGs in a DL subframe
+  struct DlCandidate
+  {
+    std::map <uint16_t, pfsFlowPerf_t>::iterator flow; //!< the DL statistics of the UE
+    const SbMeasResult_s *sbMeasResult; //!< the subband CQIs of the UE, or 0 if none
+    int nLayer; //!< the number of layers of the UE, or 0 if its transmission mode is unknown
+  };
+  /// The candidates of the current DL subframe, kept to reuse their storage
+  std::vector <DlCandidate> m_dlCandidates;
+
   // HARQ attributes
   /**
   * m_harqOn when false inhibit te HARQ mechanisms (by default active)
@@ -28,14 +28,201 @@
 #include <ns3/double.h>
 #include "ns3/uinteger.h"
 #include <fstream>
+#include <cstring>
 #include <ns3/simulator.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/abort.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("TraceFadingLossModel");
 
 NS_OBJECT_ENSURE_REGISTERED (TraceFadingLossModel);
-  
+
+/// The first characters of a binary fading trace
+static const char FADING_TRACE_MAGIC[8] = { 'N', 'S', '3', 'F', 'A', 'D', '0', '1' };
+/// The integer telling the byte order of a binary fading trace
+static const uint32_t FADING_TRACE_BYTE_ORDER = 0x01020304;
+
+/// The header of a binary fading trace
+struct FadingTraceHeader
+{
+  char magic[8];        ///< FADING_TRACE_MAGIC
+  uint32_t byteOrder;   ///< FADING_TRACE_BYTE_ORDER
+  uint32_t rbNum;       ///< the number of RBs
+  uint32_t samplesNum;  ///< the number of samples per RB
+  uint32_t padding;     ///< aligns the samples
+};
+
+
+/**
+ * The samples of a fading trace, loaded once per process and shared
+ * read-only by the TraceFadingLossModels using the trace.
+ *
+ * A binary trace is memory mapped; a text trace is read into memory.
+ */
+class TraceFadingSamples : public SimpleRefCount<TraceFadingSamples>
+{
+public:
+  /**
+   * \param fileName the name of the trace file
+   * \param rbNum the number of RBs used
+   * \param samplesNum the number of samples per RB used
+   * \return the samples of the trace, loaded if no model uses them yet
+   */
+  static Ptr<const TraceFadingSamples> Get (std::string fileName, uint8_t rbNum, uint32_t samplesNum);
+
+  ~TraceFadingSamples ();
+
+  /**
+   * \param rb the RB
+   * \param sample the index of the sample
+   * \return the fading of the RB, in dB
+   */
+  double GetValue (uint32_t rb, uint32_t sample) const
+  {
+    NS_ASSERT (rb < m_rbNum && sample < m_samplesNum);
+    return m_samples[rb * m_stride + sample];
+  }
+
+private:
+  /// The file name, number of RBs and number of samples of a trace
+  typedef std::pair<std::string, std::pair<uint32_t, uint32_t> > Key_t;
+  /// The traces loaded, by file name, number of RBs and number of samples
+  typedef std::map<Key_t, const TraceFadingSamples *> Registry_t;
+
+  /**
+   * \return the traces loaded
+   */
+  static Registry_t & GetRegistry (void);
+
+  /**
+   * \param key the trace to load
+   */
+  TraceFadingSamples (const Key_t &key);
+  /**
+   * \brief map the binary trace, if the file is one
+   * \param fileName the name of the trace file
+   * \return true if the file is a binary trace
+   */
+  bool Map (std::string fileName);
+  /**
+   * \brief read the text trace
+   * \param fileName the name of the trace file
+   */
+  void Read (std::string fileName);
+
+  Key_t m_key;                   ///< the trace
+  uint32_t m_rbNum;              ///< the number of RBs used
+  uint32_t m_samplesNum;         ///< the number of samples per RB used
+  uint32_t m_stride;             ///< the number of samples per RB in the trace
+  const double *m_samples;       ///< the samples
+  std::vector<double> m_text;    ///< the samples of a text trace
+  void *m_map;                   ///< the mapping of a binary trace
+  size_t m_mapSize;              ///< the size of the mapping
+};
+
+TraceFadingSamples::Registry_t &
+TraceFadingSamples::GetRegistry (void)
+{
+  static Registry_t registry;
+  return registry;
+}
+
+Ptr<const TraceFadingSamples>
+TraceFadingSamples::Get (std::string fileName, uint8_t rbNum, uint32_t samplesNum)
+{
+  Key_t key = std::make_pair (fileName, std::make_pair (rbNum, samplesNum));
+  Registry_t::iterator it = GetRegistry ().find (key);
+  if (it != GetRegistry ().end ())
+    {
+      return Ptr<const TraceFadingSamples> (it->second);
+    }
+  Ptr<const TraceFadingSamples> samples = Ptr<const TraceFadingSamples> (new TraceFadingSamples (key), false);
+  GetRegistry ().insert (std::make_pair (key, PeekPointer (samples)));
+  return samples;
+}
+
+TraceFadingSamples::TraceFadingSamples (const Key_t &key)
+  : m_key (key),
+    m_rbNum (key.second.first),
+    m_samplesNum (key.second.second),
+    m_stride (key.second.second),
+    m_samples (0),
+    m_map (0),
+    m_mapSize (0)
+{
+  if (!Map (key.first))
+    {
+      Read (key.first);
+    }
+}
+
+TraceFadingSamples::~TraceFadingSamples ()
+{
+  GetRegistry ().erase (m_key);
+  if (m_map != 0)
+    {
+      munmap (m_map, m_mapSize);
+    }
+}
+
+bool
+TraceFadingSamples::Map (std::string fileName)
+{
+  int fd = open (fileName.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+  FadingTraceHeader header;
+  struct stat st;
+  if (fstat (fd, &st) != 0
+      || read (fd, &header, sizeof (header)) != sizeof (header)
+      || std::memcmp (header.magic, FADING_TRACE_MAGIC, sizeof (FADING_TRACE_MAGIC)) != 0)
+    {
+      close (fd);
+      return false;
+    }
+  NS_ABORT_MSG_IF (header.byteOrder != FADING_TRACE_BYTE_ORDER,
+                   "Fading trace " << fileName << " was converted on a host of another byte order");
+  NS_ABORT_MSG_IF (header.rbNum < m_rbNum || header.samplesNum < m_samplesNum,
+                   "Fading trace " << fileName << " has " << header.rbNum << " RBs of " << header.samplesNum
+                   << " samples, not " << m_rbNum << " RBs of " << m_samplesNum << " samples");
+  m_mapSize = sizeof (header) + static_cast<size_t> (header.rbNum) * header.samplesNum * sizeof (double);
+  NS_ABORT_MSG_IF (static_cast<size_t> (st.st_size) < m_mapSize, "Fading trace " << fileName << " is truncated");
+  m_map = mmap (0, m_mapSize, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (m_map == MAP_FAILED, "Fading trace " << fileName << " could not be mapped");
+  m_samples = reinterpret_cast<const double *> (static_cast<const char *> (m_map) + sizeof (header));
+  m_stride = header.samplesNum;
+  NS_LOG_INFO ("mapped binary fading trace " << fileName);
+  return true;
+}
+
+void
+TraceFadingSamples::Read (std::string fileName)
+{
+  std::ifstream ifTraceFile;
+  ifTraceFile.open (fileName.c_str (), std::ifstream::in);
+  if (!ifTraceFile.good ())
+    {
+      NS_LOG_INFO (this << " File: " << fileName);
+      NS_ASSERT_MSG(ifTraceFile.good (), " Fading trace file not found");
+    }
+  m_text.resize (m_rbNum * m_samplesNum);
+  for (uint32_t i = 0; i < m_text.size (); i++)
+    {
+      ifTraceFile >> m_text[i];
+    }
+  m_samples = &m_text[0];
+  NS_LOG_INFO ("read text fading trace " << fileName);
+}
+
 
 
 TraceFadingLossModel::TraceFadingLossModel ()
@@ -48,9 +235,17 @@ TraceFadingLossModel::TraceFadingLossModel ()
 
 TraceFadingLossModel::~TraceFadingLossModel ()
 {
-  m_fadingTrace.clear ();
-  m_windowOffsetsMap.clear ();
-  m_startVariableMap.clear ();
+  m_fadingTrace = 0;
+  m_channelRealizations.clear ();
+}
+
+size_t
+TraceFadingLossModel::ChannelRealizationIdHash::operator() (const ChannelRealizationId_t &id) const
+{
+  size_t a = reinterpret_cast<size_t> (PeekPointer (id.first));
+  size_t b = reinterpret_cast<size_t> (PeekPointer (id.second));
+  // the objects are aligned, so the low bits of their addresses are zero
+  return (a >> 4) * 31 + (b >> 4);
 }
 
 
@@ -120,30 +315,42 @@ void
 TraceFadingLossModel::LoadTrace ()
 {
   NS_LOG_FUNCTION (this << "Loading Fading Trace " << m_traceFile);
-  std::ifstream ifTraceFile;
-  ifTraceFile.open (m_traceFile.c_str (), std::ifstream::in);
-  m_fadingTrace.clear ();
-  if (!ifTraceFile.good ())
+  m_fadingTrace = TraceFadingSamples::Get (m_traceFile, m_rbNum, m_samplesNum);
+  m_timeGranularity = m_traceLength.GetMilliSeconds () / m_samplesNum;
+  m_lastWindowUpdate = Simulator::Now ();
+}
+
+bool
+TraceFadingLossModel::ConvertTrace (std::string textFile, std::string binaryFile, uint8_t rbNum, uint32_t samplesNum)
+{
+  NS_LOG_FUNCTION (textFile << binaryFile << (uint32_t) rbNum << samplesNum);
+  std::ifstream in (textFile.c_str ());
+  std::ofstream out (binaryFile.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!in.good () || !out.good ())
     {
-      NS_LOG_INFO (this << " File: " << m_traceFile);
-      NS_ASSERT_MSG(ifTraceFile.good (), " Fading trace file not found");
+      return false;
     }
-
-//   NS_LOG_INFO (this << " length " << m_traceLength.GetSeconds ());
-//   NS_LOG_INFO (this << " RB " << (uint32_t)m_rbNum << " samples " << m_samplesNum);
-  for (uint32_t i = 0; i < m_rbNum; i++)
+  FadingTraceHeader header;
+  std::memcpy (header.magic, FADING_TRACE_MAGIC, sizeof (FADING_TRACE_MAGIC));
+  header.byteOrder = FADING_TRACE_BYTE_ORDER;
+  header.rbNum = rbNum;
+  header.samplesNum = samplesNum;
+  header.padding = 0;
+  out.write (reinterpret_cast<const char *> (&header), sizeof (header));
+  std::vector<double> samples (samplesNum);
+  for (uint32_t i = 0; i < rbNum; i++)
     {
-      FadingTraceSample rbTimeFadingTrace;
-      for (uint32_t j = 0; j < m_samplesNum; j++)
+      for (uint32_t j = 0; j < samplesNum; j++)
         {
-          double sample;
-          ifTraceFile >> sample;
-          rbTimeFadingTrace.push_back (sample);
+          in >> samples[j];
         }
-      m_fadingTrace.push_back (rbTimeFadingTrace);
+      if (in.fail ())
+        {
+          return false;
+        }
+      out.write (reinterpret_cast<const char *> (&samples[0]), samplesNum * sizeof (double));
     }
-  m_timeGranularity = m_traceLength.GetMilliSeconds () / m_samplesNum;
-  m_lastWindowUpdate = Simulator::Now ();
+  return out.good ();
 }
 
 
@@ -155,28 +362,25 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
 {
   NS_LOG_FUNCTION (this << *txPsd << a << b);
   
-  std::map <ChannelRealizationId_t, int >::iterator itOff;
   ChannelRealizationId_t mobilityPair = std::make_pair (a,b);
-  itOff = m_windowOffsetsMap.find (mobilityPair);
-  if (itOff!=m_windowOffsetsMap.end ())
+  ChannelRealizationMap_t::iterator itOff = m_channelRealizations.find (mobilityPair);
+  if (itOff!=m_channelRealizations.end ())
     {
       if (Simulator::Now ().GetSeconds () >= m_lastWindowUpdate.GetSeconds () + m_windowSize.GetSeconds ())
         {
           // update all the offsets
           NS_LOG_INFO ("Fading Windows Updated");
-          std::map <ChannelRealizationId_t, int >::iterator itOff2;
-          for (itOff2 = m_windowOffsetsMap.begin (); itOff2 != m_windowOffsetsMap.end (); itOff2++)
+          ChannelRealizationMap_t::iterator itOff2;
+          for (itOff2 = m_channelRealizations.begin (); itOff2 != m_channelRealizations.end (); itOff2++)
             {
-              std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> >::iterator itVar;
-              itVar = m_startVariableMap.find ((*itOff2).first);
-              (*itOff2).second = (*itVar).second->GetValue ();
+              (*itOff2).second.windowOffset = (*itOff2).second.startVariable->GetValue ();
             }
           m_lastWindowUpdate = Simulator::Now ();
         }
     }
   else
     {
-      NS_LOG_LOGIC (this << "insert new channel realization, m_windowOffsetMap.size () = " << m_windowOffsetsMap.size ());
+      NS_LOG_LOGIC (this << "insert new channel realization, m_channelRealizations.size () = " << m_channelRealizations.size ());
       Ptr<UniformRandomVariable> startV = CreateObject<UniformRandomVariable> ();
       startV->SetAttribute ("Min", DoubleValue (1.0));
       startV->SetAttribute ("Max", DoubleValue ((m_traceLength.GetSeconds () - m_windowSize.GetSeconds ()) * 1000.0));
@@ -186,9 +390,10 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
           startV->SetStream (m_currentStream);
           m_currentStream += 1;
         }
-      ChannelRealizationId_t mobilityPair = std::make_pair (a,b);
-      m_startVariableMap.insert (std::pair<ChannelRealizationId_t,Ptr<UniformRandomVariable> > (mobilityPair, startV));
-      m_windowOffsetsMap.insert (std::pair<ChannelRealizationId_t,int> (mobilityPair, startV->GetValue ()));
+      ChannelRealization realization;
+      realization.windowOffset = startV->GetValue ();
+      realization.startVariable = startV;
+      itOff = m_channelRealizations.insert (std::make_pair (mobilityPair, realization)).first;
     }
 
   
@@ -201,18 +406,18 @@ TraceFadingLossModel::DoCalcRxPowerSpectralDensity (
   //double speed = std::sqrt (std::pow (aSpeedVector.x-bSpeedVector.x,2) + std::pow (aSpeedVector.y-bSpeedVector.y,2));
 
   NS_LOG_LOGIC (this << *rxPsd);
-  NS_ASSERT (!m_fadingTrace.empty ());
+  NS_ASSERT (m_fadingTrace != 0);
   int now_ms = static_cast<int> (Simulator::Now ().GetMilliSeconds () * m_timeGranularity);
   int lastUpdate_ms = static_cast<int> (m_lastWindowUpdate.GetMilliSeconds () * m_timeGranularity);
-  int index = ((*itOff).second + now_ms - lastUpdate_ms) % m_samplesNum;
+  int index = ((*itOff).second.windowOffset + now_ms - lastUpdate_ms) % m_samplesNum;
   int subChannel = 0;
   while (vit != rxPsd->ValuesEnd ())
     {
       NS_ASSERT (subChannel < 100);
       if (*vit != 0.)
         {
-          double fading = m_fadingTrace.at (subChannel).at (index);
-          NS_LOG_INFO (this << " FADING now " << now_ms << " offset " << (*itOff).second << " id " << index << " fading " << fading);
+          double fading = m_fadingTrace->GetValue (subChannel, index);
+          NS_LOG_INFO (this << " FADING now " << now_ms << " offset " << (*itOff).second.windowOffset << " id " << index << " fading " << fading);
           double power = *vit; // in Watt/Hz
           power = 10 * std::log10 (180000 * power); // in dB
 
@@ -241,15 +446,16 @@ TraceFadingLossModel::AssignStreams (int64_t stream)
   m_streamsAssigned = true;
   m_currentStream = stream;
   m_lastStream = stream + m_streamSetSize - 1;
-  std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> >::iterator itVar;
-  itVar = m_startVariableMap.begin ();
+  ChannelRealizationMap_t::iterator itVar;
+  itVar = m_channelRealizations.begin ();
   // the following loop is for eventually pre-existing ChannelRealization instances
   // note that more instances are expected to be created at run time
-  while (itVar!=m_startVariableMap.end ())
+  while (itVar!=m_channelRealizations.end ())
     {
       NS_ASSERT_MSG (m_currentStream <= m_lastStream, "not enough streams, consider increasing the StreamSetSize attribute");
-      (*itVar).second->SetStream (m_currentStream);
+      (*itVar).second.startVariable->SetStream (m_currentStream);
       m_currentStream += 1;
+      itVar++;
     }
   return m_streamSetSize;
 }
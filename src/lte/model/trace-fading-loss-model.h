@@ -29,17 +29,32 @@
 #include <map>
 #include "ns3/random-variable-stream.h"
 #include <ns3/nstime.h>
+#include <ns3/sgi-hashmap.h>
 
 namespace ns3 {
 
 
 class MobilityModel;
+class TraceFadingSamples;
 
 
 /**
  * \ingroup lte
  *
  * \brief fading loss model based on precalculated fading traces
+ *
+ * The trace file is either the text trace generated by
+ * fading_trace_generator.m, or its binary conversion (see ConvertTrace),
+ * which is memory mapped read-only: its pages are then shared by all the
+ * processes simulating with the trace, and loaded on demand.  In both
+ * cases, the samples of a trace are loaded once per process, and shared
+ * by all the instances of the model using it.
+ *
+ * The binary format is a header of 24 bytes, holding the characters
+ * "NS3FAD01", the integer 0x01020304 (to check the byte order), the
+ * number of RBs and the number of samples per RB, as 32-bit integers,
+ * followed by the samples of each RB in turn, as doubles, in the byte
+ * order of the host which converted the trace.
  */
 class TraceFadingLossModel : public SpectrumPropagationLossModel
 {
@@ -66,6 +81,16 @@ public:
   */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Convert a text fading trace into the binary format
+   * \param textFile the name of the text trace
+   * \param binaryFile the name of the binary trace written
+   * \param rbNum the number of RBs of the trace
+   * \param samplesNum the number of samples per RB of the trace
+   * \return true if the trace was converted
+   */
+  static bool ConvertTrace (std::string textFile, std::string binaryFile, uint8_t rbNum, uint32_t samplesNum);
+
   
 private:
   /**
@@ -94,25 +119,32 @@ private:
   void LoadTrace ();
 
 
-   
-  mutable std::map <ChannelRealizationId_t, int > m_windowOffsetsMap;
-  
-  mutable std::map <ChannelRealizationId_t, Ptr<UniformRandomVariable> > m_startVariableMap;
-  
-  /**
-   * Vector with fading samples in time domain (for a fixed RB)
-   */
-  typedef std::vector<double> FadingTraceSample;
-  /**
-   * Vector collecting the time fading traces in the frequency domain (per RB)
-   */
-  typedef std::vector<FadingTraceSample> FadingTrace;
 
+  /// Hash of the couple of mobility models of a channel realization
+  struct ChannelRealizationIdHash : public std::unary_function<ChannelRealizationId_t, size_t>
+  {
+    /**
+     * \param id the channel realization
+     * \return the hash of the channel realization
+     */
+    size_t operator() (const ChannelRealizationId_t &id) const;
+  };
+
+  /// The state of a channel realization
+  struct ChannelRealization
+  {
+    int windowOffset;  ///< the offset of the current window in the trace
+    Ptr<UniformRandomVariable> startVariable;  ///< draws the offsets of the windows
+  };
+
+  /// The channel realizations, found in constant time for each signal
+  typedef sgi::hash_map<ChannelRealizationId_t, ChannelRealization, ChannelRealizationIdHash> ChannelRealizationMap_t;
+
+  mutable ChannelRealizationMap_t m_channelRealizations;
 
-  
   std::string m_traceFile;
   
-  FadingTrace m_fadingTrace;
+  Ptr<const TraceFadingSamples> m_fadingTrace;
 
   
   Time m_traceLength;
@@ -0,0 +1,146 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "ns3/test.h"
+#include "ns3/log.h"
+
+#include "ns3/lte-mi-error-model.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestMiErrorModel");
+
+/**
+ * Check that the TB statistics computed from the MIs of the RBs shared by
+ * the TBs of a subframe are those computed from the SINR, and that the
+ * cache of TB statistics reuses them within its resolution only.
+ */
+class LteMiErrorModelTestCase : public TestCase
+{
+public:
+  LteMiErrorModelTestCase ();
+  virtual ~LteMiErrorModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LteMiErrorModelTestCase::LteMiErrorModelTestCase ()
+  : TestCase ("TB statistics from the MIs of the RBs and cached")
+{
+}
+
+LteMiErrorModelTestCase::~LteMiErrorModelTestCase ()
+{
+}
+
+void
+LteMiErrorModelTestCase::DoRun (void)
+{
+  std::vector<double> freqs;
+  for (uint32_t rb = 0; rb < 25; rb++)
+    {
+      freqs.push_back (2.1e9 + rb * 180e3);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+  SpectrumValue sinr (model);
+  for (uint32_t rb = 0; rb < 25; rb++)
+    {
+      // from -4.5 dB to 19.5 dB, away from the bounds of the intervals of the cache
+      sinr[rb] = std::pow (10.0, (rb - 4.5) / 10.0);
+    }
+
+  LteMiPerRb mi;
+  mi.SetSinr (sinr);
+  HarqProcessInfoList_t noHistory;
+  for (uint8_t mcs = 0; mcs <= 28; mcs += 4)
+    {
+      for (uint32_t first = 0; first < 25; first += 6)
+        {
+          std::vector<int> map;
+          for (uint32_t rb = first; rb < 25 && rb < first + 8; rb++)
+            {
+              map.push_back (rb);
+            }
+          TbStats_t expected = LteMiErrorModel::GetTbDecodificationStats (sinr, map, 300, mcs, noHistory);
+          TbStats_t stats = LteMiErrorModel::GetTbDecodificationStats (mi, map, 300, mcs, noHistory);
+          NS_TEST_EXPECT_MSG_EQ (stats.tbler, expected.tbler, "Wrong TBLER for MCS " << (uint16_t) mcs);
+          NS_TEST_EXPECT_MSG_EQ (stats.mi, expected.mi, "Wrong MI for MCS " << (uint16_t) mcs);
+        }
+    }
+
+  // the same SINR, then a SINR within and out of the resolution
+  LteMiErrorModelCache cache;
+  cache.SetResolution (1.0);
+  std::vector<int> map;
+  for (uint32_t rb = 10; rb < 14; rb++)
+    {
+      map.push_back (rb);
+    }
+  TbStats_t first = cache.GetTbDecodificationStats (mi, map, 200, 12);
+  TbStats_t expected = LteMiErrorModel::GetTbDecodificationStats (sinr, map, 200, 12, noHistory);
+  NS_TEST_EXPECT_MSG_EQ (first.mi, expected.mi, "The first TB should be evaluated");
+  TbStats_t again = cache.GetTbDecodificationStats (mi, map, 200, 12);
+  NS_TEST_EXPECT_MSG_EQ (again.mi, first.mi, "The same TB should be cached");
+
+  SpectrumValue close = sinr;
+  for (uint32_t rb = 10; rb < 14; rb++)
+    {
+      // 5.5 to 8.5 dB, raised by 0.2 dB
+      close[rb] *= std::pow (10.0, 0.02);
+    }
+  mi.SetSinr (close);
+  TbStats_t cached = cache.GetTbDecodificationStats (mi, map, 200, 12);
+  NS_TEST_EXPECT_MSG_EQ (cached.mi, first.mi, "A TB with close SINRs should share the statistics");
+
+  SpectrumValue far = sinr;
+  for (uint32_t rb = 10; rb < 14; rb++)
+    {
+      far[rb] *= 2.0;
+    }
+  mi.SetSinr (far);
+  TbStats_t evaluated = cache.GetTbDecodificationStats (mi, map, 200, 12);
+  expected = LteMiErrorModel::GetTbDecodificationStats (far, map, 200, 12, noHistory);
+  NS_TEST_EXPECT_MSG_EQ (evaluated.mi, expected.mi, "A TB with other SINRs should be evaluated");
+
+  // disabled, the cache evaluates every TB
+  cache.SetResolution (0.0);
+  mi.SetSinr (close);
+  TbStats_t uncached = cache.GetTbDecodificationStats (mi, map, 200, 12);
+  expected = LteMiErrorModel::GetTbDecodificationStats (close, map, 200, 12, noHistory);
+  NS_TEST_EXPECT_MSG_EQ (uncached.mi, expected.mi, "A disabled cache should evaluate the TB");
+}
+
+
+/**
+ * Test suite of the LteMiErrorModel
+ */
+class LteMiErrorModelTestSuite : public TestSuite
+{
+public:
+  LteMiErrorModelTestSuite ();
+};
+
+static LteMiErrorModelTestSuite g_lteMiErrorModelTestSuite;
+
+LteMiErrorModelTestSuite::LteMiErrorModelTestSuite ()
+  : TestSuite ("lte-mi-error-model", UNIT)
+{
+  NS_LOG_FUNCTION (this);
+
+  AddTestCase (new LteMiErrorModelTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,178 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/position-allocator.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/lte-helper.h"
+#include "ns3/radio-environment-map-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestRadioEnvironmentMap");
+
+/**
+ * Check that a small Radio Environment Map computed directly, with one and
+ * with several threads, is the one generated by simulating the listening
+ * points, and that a loss model drawing random values gives the same map
+ * whatever the number of threads.
+ */
+class LteRadioEnvironmentMapTestCase : public TestCase
+{
+public:
+  LteRadioEnvironmentMapTestCase ();
+  virtual ~LteRadioEnvironmentMapTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Generate the map of three eNBs.
+   *
+   * \param directComputation the `DirectComputation` attribute of the map
+   * \param threads the `Threads` attribute of the map
+   * \param randomLoss whether the path loss draws random values
+   * \param resolution the number of points along each axis
+   * \return the content of the map file
+   */
+  std::string Generate (bool directComputation, uint32_t threads, bool randomLoss,
+                        uint16_t resolution);
+};
+
+LteRadioEnvironmentMapTestCase::LteRadioEnvironmentMapTestCase ()
+  : TestCase ("REM computed directly by one and several threads")
+{
+}
+
+LteRadioEnvironmentMapTestCase::~LteRadioEnvironmentMapTestCase ()
+{
+}
+
+std::string
+LteRadioEnvironmentMapTestCase::Generate (bool directComputation, uint32_t threads, bool randomLoss,
+                                          uint16_t resolution)
+{
+  Ptr<LteHelper> lteHelper = CreateObject<LteHelper> ();
+  if (randomLoss)
+    {
+      lteHelper->SetPathlossModelType ("ns3::RandomPropagationLossModel");
+      lteHelper->SetPathlossModelAttribute ("Variable", StringValue ("ns3::UniformRandomVariable[Min=60|Max=90]"));
+    }
+  lteHelper->SetEnbAntennaModelType ("ns3::CosineAntennaModel");
+
+  NodeContainer enbNodes;
+  enbNodes.Create (3);
+  Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator> ();
+  positions->Add (Vector (0.0, 0.0, 30.0));
+  positions->Add (Vector (400.0, 50.0, 30.0));
+  positions->Add (Vector (150.0, 350.0, 30.0));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positions);
+  mobility.Install (enbNodes);
+  lteHelper->InstallEnbDevice (enbNodes);
+
+  if (randomLoss)
+    {
+      Ptr<SpectrumChannel> channel = Config::LookupMatches ("/ChannelList/0").Get (0)->GetObject<SpectrumChannel> ();
+      channel->GetPropagationLossModel ()->AssignStreams (1);
+    }
+
+  std::string fileName = CreateTempDirFilename ("rem.out");
+  Ptr<RadioEnvironmentMapHelper> remHelper = CreateObject<RadioEnvironmentMapHelper> ();
+  remHelper->SetAttribute ("ChannelPath", StringValue ("/ChannelList/0"));
+  remHelper->SetAttribute ("OutputFile", StringValue (fileName));
+  remHelper->SetAttribute ("XMin", DoubleValue (-100.0));
+  remHelper->SetAttribute ("XMax", DoubleValue (500.0));
+  remHelper->SetAttribute ("XRes", UintegerValue (resolution));
+  remHelper->SetAttribute ("YMin", DoubleValue (-100.0));
+  remHelper->SetAttribute ("YMax", DoubleValue (450.0));
+  remHelper->SetAttribute ("YRes", UintegerValue (resolution));
+  // three blocks of columns
+  remHelper->SetAttribute ("MaxPointsPerIteration", UintegerValue (resolution * resolution / 3));
+  remHelper->SetAttribute ("DirectComputation", BooleanValue (directComputation));
+  remHelper->SetAttribute ("Threads", UintegerValue (threads));
+  remHelper->Install ();
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream file (fileName.c_str ());
+  std::ostringstream content;
+  content << file.rdbuf ();
+  return content.str ();
+}
+
+void
+LteRadioEnvironmentMapTestCase::DoRun (void)
+{
+  std::string simulated = Generate (false, 1, false, 12);
+  uint32_t lines = 0;
+  for (std::string::const_iterator it = simulated.begin (); it != simulated.end (); ++it)
+    {
+      lines += (*it == '\n');
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines, 12 * 12, "Wrong number of points in the map");
+
+  std::string direct = Generate (true, 1, false, 12);
+  NS_TEST_EXPECT_MSG_EQ (direct, simulated, "The map computed by one thread differs");
+  for (uint32_t threads = 2; threads <= 8; threads *= 2)
+    {
+      direct = Generate (true, threads, false, 12);
+      NS_TEST_EXPECT_MSG_EQ (direct, simulated, "The map computed by " << threads << " threads differs");
+    }
+
+  // computed by a single thread whatever the Threads attribute; the map
+  // is large enough for several threads to draw the values concurrently
+  std::string random = Generate (true, 1, true, 200);
+  NS_TEST_EXPECT_MSG_NE (random, direct, "The random loss model was not used");
+  for (uint32_t threads = 2; threads <= 8; threads *= 2)
+    {
+      direct = Generate (true, threads, true, 200);
+      NS_TEST_EXPECT_MSG_EQ (direct, random, "The map with random losses differs with " << threads << " threads");
+    }
+}
+
+
+/**
+ * Test suite of the RadioEnvironmentMapHelper
+ */
+class LteRadioEnvironmentMapTestSuite : public TestSuite
+{
+public:
+  LteRadioEnvironmentMapTestSuite ();
+};
+
+static LteRadioEnvironmentMapTestSuite g_lteRadioEnvironmentMapTestSuite;
+
+LteRadioEnvironmentMapTestSuite::LteRadioEnvironmentMapTestSuite ()
+  : TestSuite ("lte-radio-environment-map", SYSTEM)
+{
+  AddTestCase (new LteRadioEnvironmentMapTestCase, TestCase::QUICK);
+}
@@ -0,0 +1,148 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/constant-position-mobility-model.h"
+
+#include "ns3/trace-fading-loss-model.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LteTestTraceFading");
+
+/**
+ * Check that a TraceFadingLossModel applies the same fading with a text
+ * trace and with its binary conversion.
+ */
+class LteTraceFadingTestCase : public TestCase
+{
+public:
+  LteTraceFadingTestCase ();
+  virtual ~LteTraceFadingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param fileName the name of the trace
+   * \return a fading model using the trace, 4 RBs of 100 samples
+   */
+  Ptr<TraceFadingLossModel> CreateModel (std::string fileName);
+};
+
+LteTraceFadingTestCase::LteTraceFadingTestCase ()
+  : TestCase ("Fading of the text and binary traces")
+{
+}
+
+LteTraceFadingTestCase::~LteTraceFadingTestCase ()
+{
+}
+
+Ptr<TraceFadingLossModel>
+LteTraceFadingTestCase::CreateModel (std::string fileName)
+{
+  Ptr<TraceFadingLossModel> model = CreateObject<TraceFadingLossModel> ();
+  model->SetAttribute ("TraceFilename", StringValue (fileName));
+  model->SetAttribute ("TraceLength", TimeValue (MilliSeconds (100)));
+  model->SetAttribute ("SamplesNum", UintegerValue (100));
+  model->SetAttribute ("WindowSize", TimeValue (MilliSeconds (50)));
+  model->SetAttribute ("RbNum", UintegerValue (4));
+  model->AssignStreams (1);
+  model->Initialize ();
+  return model;
+}
+
+void
+LteTraceFadingTestCase::DoRun (void)
+{
+  std::string textFile = CreateTempDirFilename ("fading.fad");
+  std::string binaryFile = CreateTempDirFilename ("fading.bin");
+  std::ofstream out (textFile.c_str ());
+  for (uint32_t rb = 0; rb < 4; rb++)
+    {
+      for (uint32_t i = 0; i < 100; i++)
+        {
+          out << -0.1 * ((rb * 37 + i * 11) % 200) << " ";
+        }
+      out << std::endl;
+    }
+  out.close ();
+  NS_TEST_ASSERT_MSG_EQ (TraceFadingLossModel::ConvertTrace (textFile, binaryFile, 4, 100), true,
+                         "The trace should be converted");
+  NS_TEST_EXPECT_MSG_EQ (TraceFadingLossModel::ConvertTrace (textFile, binaryFile, 5, 100), false,
+                         "A trace too short should not be converted");
+  NS_TEST_ASSERT_MSG_EQ (TraceFadingLossModel::ConvertTrace (textFile, binaryFile, 4, 100), true,
+                         "The trace should be converted");
+
+  Ptr<TraceFadingLossModel> text = CreateModel (textFile);
+  Ptr<TraceFadingLossModel> binary = CreateModel (binaryFile);
+  // a second model on the same trace shares its samples
+  Ptr<TraceFadingLossModel> shared = CreateModel (binaryFile);
+
+  std::vector<double> freqs;
+  for (uint32_t rb = 0; rb < 4; rb++)
+    {
+      freqs.push_back (2.1e9 + rb * 180e3);
+    }
+  Ptr<SpectrumValue> txPsd = Create<SpectrumValue> (Create<SpectrumModel> (freqs));
+  (*txPsd) = 1e-10;
+  Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+
+  Ptr<SpectrumValue> textRxPsd = text->CalcRxPowerSpectralDensity (txPsd, a, b);
+  Ptr<SpectrumValue> binaryRxPsd = binary->CalcRxPowerSpectralDensity (txPsd, a, b);
+  Ptr<SpectrumValue> sharedRxPsd = shared->CalcRxPowerSpectralDensity (txPsd, a, b);
+  for (uint32_t rb = 0; rb < 4; rb++)
+    {
+      NS_TEST_EXPECT_MSG_LT ((*textRxPsd)[rb], (*txPsd)[rb] * 1.0001, "The fading should be a loss");
+      NS_TEST_EXPECT_MSG_EQ ((*binaryRxPsd)[rb], (*textRxPsd)[rb], "Wrong fading of RB " << rb);
+      NS_TEST_EXPECT_MSG_EQ ((*sharedRxPsd)[rb], (*textRxPsd)[rb], "Wrong fading of RB " << rb);
+    }
+  // the link is found again
+  binaryRxPsd = binary->CalcRxPowerSpectralDensity (txPsd, a, b);
+  NS_TEST_EXPECT_MSG_EQ ((*binaryRxPsd)[0], (*textRxPsd)[0], "The link should keep its window");
+
+  text->Dispose ();
+  binary->Dispose ();
+  shared->Dispose ();
+  Simulator::Destroy ();
+}
+
+
+/**
+ * Test suite of the TraceFadingLossModel
+ */
+class LteTraceFadingTestSuite : public TestSuite
+{
+public:
+  LteTraceFadingTestSuite ();
+};
+
+static LteTraceFadingTestSuite g_lteTraceFadingTestSuite;
+
+LteTraceFadingTestSuite::LteTraceFadingTestSuite ()
+  : TestSuite ("lte-trace-fading", UNIT)
+{
+  NS_LOG_FUNCTION (this);
+
+  AddTestCase (new LteTraceFadingTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spatial-index.h"
+#include "mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/callback.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SpatialIndex");
+
+SpatialIndex::SpatialIndex (double cellSize)
+  : m_cellSize (cellSize),
+    m_maxSpeed (0),
+    m_lastRefresh (Seconds (0))
+{
+  NS_LOG_FUNCTION (this << cellSize);
+  NS_ASSERT_MSG (cellSize > 0, "The cells of a SpatialIndex must have a positive size");
+}
+
+SpatialIndex::~SpatialIndex ()
+{
+  NS_LOG_FUNCTION (this);
+  const MobilityModel *last = 0;
+  for (std::multimap<const MobilityModel *, uint32_t>::const_iterator i = m_mobilityObjects.begin ();
+       i != m_mobilityObjects.end (); ++i)
+    {
+      if (i->first != last)
+        {
+          Ptr<MobilityModel> mobility = m_objects[i->second].mobility;
+          mobility->TraceDisconnectWithoutContext ("CourseChange",
+                                                   MakeCallback (&SpatialIndex::CourseChanged, this));
+          last = i->first;
+        }
+    }
+}
+
+SpatialIndex::Cell
+SpatialIndex::GetCell (const Vector &position) const
+{
+  return Cell ((int64_t)std::floor (position.x / m_cellSize),
+               (int64_t)std::floor (position.y / m_cellSize));
+}
+
+uint32_t
+SpatialIndex::Add (Ptr<MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  NS_ASSERT (mobility != 0);
+  uint32_t id = m_objects.size ();
+  Object object;
+  object.mobility = mobility;
+  object.cell = GetCell (mobility->GetPosition ());
+  object.moving = false;
+  m_objects.push_back (object);
+  m_cells[object.cell].push_back (id);
+  Bin (id);
+
+  if (m_mobilityObjects.find (PeekPointer (mobility)) == m_mobilityObjects.end ())
+    {
+      mobility->TraceConnectWithoutContext ("CourseChange",
+                                            MakeCallback (&SpatialIndex::CourseChanged, this));
+    }
+  m_mobilityObjects.insert (std::make_pair (PeekPointer (mobility), id));
+  return id;
+}
+
+uint32_t
+SpatialIndex::GetN (void) const
+{
+  return m_objects.size ();
+}
+
+void
+SpatialIndex::Bin (uint32_t id)
+{
+  Object &object = m_objects[id];
+  Cell cell = GetCell (object.mobility->GetPosition ());
+  if (cell != object.cell)
+    {
+      std::vector<uint32_t> &ids = m_cells[object.cell];
+      std::vector<uint32_t>::iterator i = std::find (ids.begin (), ids.end (), id);
+      NS_ASSERT (i != ids.end ());
+      *i = ids.back ();
+      ids.pop_back ();
+      if (ids.empty ())
+        {
+          m_cells.erase (object.cell);
+        }
+      m_cells[cell].push_back (id);
+      object.cell = cell;
+    }
+  Vector velocity = object.mobility->GetVelocity ();
+  double speed = std::sqrt (velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z);
+  object.moving = speed > 0;
+  m_maxSpeed = std::max (m_maxSpeed, speed);
+}
+
+void
+SpatialIndex::CourseChanged (Ptr<const MobilityModel> mobility)
+{
+  m_courseChanged.push_back (PeekPointer (mobility));
+}
+
+void
+SpatialIndex::Refresh (void)
+{
+  for (std::vector<const MobilityModel *>::const_iterator i = m_courseChanged.begin ();
+       i != m_courseChanged.end (); ++i)
+    {
+      std::pair<std::multimap<const MobilityModel *, uint32_t>::const_iterator,
+                std::multimap<const MobilityModel *, uint32_t>::const_iterator> range;
+      range = m_mobilityObjects.equal_range (*i);
+      for (std::multimap<const MobilityModel *, uint32_t>::const_iterator j = range.first;
+           j != range.second; ++j)
+        {
+          Bin (j->second);
+        }
+    }
+  m_courseChanged.clear ();
+
+  double drift = m_maxSpeed * (Simulator::Now () - m_lastRefresh).GetSeconds ();
+  if (drift > m_cellSize / 2)
+    {
+      NS_LOG_LOGIC ("binning moving objects, drift=" << drift);
+      m_maxSpeed = 0;
+      for (uint32_t id = 0; id < m_objects.size (); id++)
+        {
+          if (m_objects[id].moving)
+            {
+              Bin (id);
+            }
+        }
+      m_lastRefresh = Simulator::Now ();
+    }
+}
+
+void
+SpatialIndex::GetObjectsInRange (const Vector &position, double range, std::vector<uint32_t> &ids)
+{
+  NS_LOG_FUNCTION (this << position << range);
+  Refresh ();
+  ids.clear ();
+
+  // objects binned at m_lastRefresh or later may have moved since
+  range += m_maxSpeed * (Simulator::Now () - m_lastRefresh).GetSeconds ();
+  Cell low = GetCell (Vector (position.x - range, position.y - range, 0));
+  Cell high = GetCell (Vector (position.x + range, position.y + range, 0));
+  double nCells = ((double)high.first - low.first + 1) * ((double)high.second - low.second + 1);
+  if (nCells > m_cells.size ())
+    {
+      for (CellMap::const_iterator i = m_cells.begin (); i != m_cells.end (); ++i)
+        {
+          if (i->first.first >= low.first && i->first.first <= high.first
+              && i->first.second >= low.second && i->first.second <= high.second)
+            {
+              ids.insert (ids.end (), i->second.begin (), i->second.end ());
+            }
+        }
+    }
+  else
+    {
+      for (int64_t x = low.first; x <= high.first; x++)
+        {
+          for (int64_t y = low.second; y <= high.second; y++)
+            {
+              CellMap::const_iterator i = m_cells.find (Cell (x, y));
+              if (i != m_cells.end ())
+                {
+                  ids.insert (ids.end (), i->second.begin (), i->second.end ());
+                }
+            }
+        }
+    }
+  std::sort (ids.begin (), ids.end ());
+}
+
+} // namespace ns3
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "ns3/ptr.h"
+#include "ns3/non-copyable.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include <stdint.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ * \brief a grid index over the positions of a set of mobility models
+ *
+ * The index partitions the xy plane in square cells and records the
+ * cell of each mobility model added to it.  It is meant to quickly
+ * find the few objects which may be close to a position, for example
+ * the receivers within range of a transmitter.
+ *
+ * The index is refreshed lazily: the CourseChange notifications of the
+ * mobility models only mark them for update, and they are moved to
+ * their new cell by the next query.  Mobility models in motion are not
+ * moved continuously: instead, queries are extended by the largest
+ * distance such a model may have covered since it was last binned, and
+ * all moving models are binned again when this distance exceeds half
+ * a cell.  This assumes that the speed of a mobility model only changes
+ * along with a CourseChange notification.
+ *
+ * Queries return a superset of the objects within range, which the
+ * caller is expected to filter with the exact distance.
+ */
+class SpatialIndex : private NonCopyable
+{
+public:
+  /**
+   * \param cellSize the length of the side of the grid cells, in meters
+   */
+  SpatialIndex (double cellSize);
+  ~SpatialIndex ();
+
+  /**
+   * \param mobility the mobility model to add to the index
+   * \returns the identifier of the new object, which is the number of
+   *          objects added before it
+   *
+   * The same mobility model may be added several times, in which case
+   * each of the objects returned moves with it.
+   */
+  uint32_t Add (Ptr<MobilityModel> mobility);
+  /**
+   * \returns the number of objects added to the index
+   */
+  uint32_t GetN (void) const;
+  /**
+   * \param position the center of the query
+   * \param range the range of the query, in meters
+   * \param ids the identifiers of the objects which may be closer than
+   *        range to position, in increasing order
+   */
+  void GetObjectsInRange (const Vector &position, double range, std::vector<uint32_t> &ids);
+
+private:
+  /// Coordinates of a grid cell
+  typedef std::pair<int64_t, int64_t> Cell;
+  /// Container: grid cell, identifiers of the objects in the cell
+  typedef std::map<Cell, std::vector<uint32_t> > CellMap;
+
+  /// An object of the index
+  struct Object
+  {
+    Ptr<MobilityModel> mobility; //!< the mobility model of the object
+    Cell cell;                   //!< the cell the object is binned in
+    bool moving;                 //!< whether the object was moving when binned
+  };
+
+  /**
+   * \param position a position
+   * \returns the cell holding the position
+   */
+  Cell GetCell (const Vector &position) const;
+  /**
+   * Move an object to the cell of the current position of its mobility
+   * model.
+   *
+   * \param id the identifier of the object
+   */
+  void Bin (uint32_t id);
+  /**
+   * Bin the objects whose course changed and, if needed, all the
+   * moving objects.
+   */
+  void Refresh (void);
+  /**
+   * Mark the objects of a mobility model for update.
+   *
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility);
+
+  double m_cellSize;                //!< length of the side of the cells
+  std::vector<Object> m_objects;    //!< the objects, by identifier
+  CellMap m_cells;                  //!< the objects binned in each cell
+  /// the objects of each mobility model
+  std::multimap<const MobilityModel *, uint32_t> m_mobilityObjects;
+  /// the mobility models whose course changed since the last query
+  std::vector<const MobilityModel *> m_courseChanged;
+  double m_maxSpeed;                //!< largest speed of the moving objects
+  Time m_lastRefresh;               //!< last time all moving objects were binned
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_INDEX_H */
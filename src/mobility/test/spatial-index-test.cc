@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/simulator.h"
+#include "ns3/spatial-index.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include <algorithm>
+
+using namespace ns3;
+
+/**
+ * Check that the objects returned by SpatialIndex::GetObjectsInRange
+ * include all the objects within range, while objects move, jump and
+ * change course.
+ */
+class SpatialIndexTestCase : public TestCase
+{
+public:
+  SpatialIndexTestCase ();
+  virtual ~SpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Compare the result of queries around each object with brute force
+  void Check (void);
+  /// Change the course of some of the objects
+  void ChangeCourses (void);
+
+  SpatialIndex *m_index;                            //!< the index under test
+  std::vector<Ptr<MobilityModel> > m_mobilities;    //!< the mobility model of each object
+  Ptr<UniformRandomVariable> m_random;              //!< random positions and velocities
+  double m_range;                                   //!< range of the queries
+  uint32_t m_nChecks;                               //!< number of queries checked
+};
+
+SpatialIndexTestCase::SpatialIndexTestCase ()
+  : TestCase ("Check the objects in range returned by a SpatialIndex"),
+    m_index (0),
+    m_range (150),
+    m_nChecks (0)
+{
+}
+
+SpatialIndexTestCase::~SpatialIndexTestCase ()
+{
+}
+
+void
+SpatialIndexTestCase::Check (void)
+{
+  std::vector<uint32_t> ids;
+  for (uint32_t i = 0; i < m_mobilities.size (); i++)
+    {
+      m_index->GetObjectsInRange (m_mobilities[i]->GetPosition (), m_range, ids);
+      NS_TEST_ASSERT_MSG_EQ (std::is_sorted (ids.begin (), ids.end ()), true, "Objects should be sorted");
+      NS_TEST_ASSERT_MSG_LT (ids.size (), m_mobilities.size () / 2, "The index should cull most objects");
+      for (uint32_t j = 0; j < m_mobilities.size (); j++)
+        {
+          if (m_mobilities[i]->GetDistanceFrom (m_mobilities[j]) <= m_range)
+            {
+              NS_TEST_ASSERT_MSG_EQ (std::binary_search (ids.begin (), ids.end (), j), true,
+                                     "Object " << j << " in range of object " << i << " is missing at " << Simulator::Now ());
+            }
+        }
+      m_nChecks++;
+    }
+}
+
+void
+SpatialIndexTestCase::ChangeCourses (void)
+{
+  for (uint32_t i = 0; i < m_mobilities.size (); i += 3)
+    {
+      Ptr<ConstantVelocityMobilityModel> cv = DynamicCast<ConstantVelocityMobilityModel> (m_mobilities[i]);
+      if (cv)
+        {
+          cv->SetVelocity (Vector (m_random->GetValue (-40, 40), m_random->GetValue (-40, 40), 0));
+        }
+      else
+        {
+          m_mobilities[i]->SetPosition (Vector (m_random->GetValue (0, 2000), m_random->GetValue (0, 2000), 0));
+        }
+    }
+}
+
+void
+SpatialIndexTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+  m_index = new SpatialIndex (100);
+
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Ptr<MobilityModel> mobility;
+      if (i % 2)
+        {
+          Ptr<ConstantVelocityMobilityModel> cv = CreateObject<ConstantVelocityMobilityModel> ();
+          cv->SetVelocity (Vector (m_random->GetValue (-30, 30), m_random->GetValue (-30, 30), 0));
+          mobility = cv;
+        }
+      else
+        {
+          mobility = CreateObject<ConstantPositionMobilityModel> ();
+        }
+      mobility->SetPosition (Vector (m_random->GetValue (0, 2000), m_random->GetValue (0, 2000), 0));
+      m_mobilities.push_back (mobility);
+      NS_TEST_ASSERT_MSG_EQ (m_index->Add (mobility), i, "Identifiers should be allocated in sequence");
+    }
+
+  double times[] = { 0, 0.5, 1, 2.5, 4, 10, 10.5, 30, 31, 60 };
+  for (uint32_t i = 0; i < sizeof (times) / sizeof (times[0]); i++)
+    {
+      Simulator::Schedule (Seconds (times[i]), &SpatialIndexTestCase::Check, this);
+    }
+  Simulator::Schedule (Seconds (10.2), &SpatialIndexTestCase::ChangeCourses, this);
+  Simulator::Schedule (Seconds (30.7), &SpatialIndexTestCase::ChangeCourses, this);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nChecks, 200 * sizeof (times) / sizeof (times[0]), "Some checks did not run");
+
+  delete m_index;
+  m_index = 0;
+  m_mobilities.clear ();
+  Simulator::Destroy ();
+}
+
+static struct SpatialIndexTestSuite : public TestSuite
+{
+  SpatialIndexTestSuite () : TestSuite ("spatial-index", UNIT)
+  {
+    AddTestCase (new SpatialIndexTestCase (), TestCase::QUICK);
+  }
+} g_spatialIndexTestSuite;
@@ -39,6 +39,10 @@
  *
  * One packet is sent from each left leaf node.  The packet sinks on the
  * right leaf nodes output logging information when they receive the packet.
+ *
+ * With --multithreaded, the two halves run in two threads of a single
+ * process, with the MultithreadedSimulatorImpl, and MPI is not needed.
+ * Nix-vector routing cannot be used with threads: global routing is.
  */
 
 #include "ns3/core-module.h"
@@ -63,29 +67,43 @@ NS_LOG_COMPONENT_DEFINE ("SimpleDistributed");
 int
 main (int argc, char *argv[])
 {
-#ifdef NS3_MPI
-
   bool nix = true;
   bool nullmsg = false;
   bool tracing = false;
+  bool multithreaded = false;
 
   // Parse command line
   CommandLine cmd;
   cmd.AddValue ("nix", "Enable the use of nix-vector or global routing", nix);
   cmd.AddValue ("nullmsg", "Enable the use of null-message synchronization", nullmsg);
   cmd.AddValue ("tracing", "Enable pcap tracing", tracing);
+  cmd.AddValue ("multithreaded", "Run the two halves in two threads instead of two MPI processes", multithreaded);
   cmd.Parse (argc, argv);
 
-  // Distributed simulation setup; by default use granted time window algorithm.
-  if(nullmsg) 
+  if (multithreaded)
     {
       GlobalValue::Bind ("SimulatorImplementationType",
-                         StringValue ("ns3::NullMessageSimulatorImpl"));
-    } 
-  else 
+                         StringValue ("ns3::MultithreadedSimulatorImpl"));
+      GlobalValue::Bind ("SimulatorThreads", UintegerValue (2));
+      nix = false;
+    }
+  else
     {
-      GlobalValue::Bind ("SimulatorImplementationType",
-                         StringValue ("ns3::DistributedSimulatorImpl"));
+#ifdef NS3_MPI
+      // Distributed simulation setup; by default use granted time window algorithm.
+      if(nullmsg) 
+        {
+          GlobalValue::Bind ("SimulatorImplementationType",
+                             StringValue ("ns3::NullMessageSimulatorImpl"));
+        } 
+      else 
+        {
+          GlobalValue::Bind ("SimulatorImplementationType",
+                             StringValue ("ns3::DistributedSimulatorImpl"));
+        }
+#else
+      NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
     }
 
   // Enable parallel simulator with the command line arguments
@@ -216,13 +234,13 @@ main (int argc, char *argv[])
 
   if (tracing == true)
     {
-      if (systemId == 0)
+      if (multithreaded || systemId == 0)
         {
           routerLink.EnablePcap("router-left", routerDevices, true);
           leafLink.EnablePcap("leaf-left", leftLeafDevices, true);
         }
       
-      if (systemId == 1)
+      if (multithreaded || systemId == 1)
         {
           routerLink.EnablePcap("router-right", routerDevices, true);
           leafLink.EnablePcap("leaf-right", rightLeafDevices, true);
@@ -231,7 +249,7 @@ main (int argc, char *argv[])
 
   // Create a packet sink on the right leafs to receive packets from left leafs
   uint16_t port = 50000;
-  if (systemId == 1)
+  if (multithreaded || systemId == 1)
     {
       Address sinkLocalAddress (InetSocketAddress (Ipv4Address::GetAny (), port));
       PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", sinkLocalAddress);
@@ -245,7 +263,7 @@ main (int argc, char *argv[])
     }
 
   // Create the OnOff applications to send
-  if (systemId == 0)
+  if (multithreaded || systemId == 0)
     {
       OnOffHelper clientHelper ("ns3::UdpSocketFactory", Address ());
       clientHelper.SetAttribute
@@ -271,7 +289,4 @@ main (int argc, char *argv[])
   // Exit the MPI execution environment
   MpiInterface::Disable ();
   return 0;
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
 }
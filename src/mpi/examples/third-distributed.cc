@@ -14,6 +14,9 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <sstream>
+
 #include "ns3/core-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/network-module.h"
@@ -41,6 +44,16 @@
 //                   point-to-point  |    |    |    |
 //                                   ================
 //                                     LAN 10.1.2.0
+//
+// With 2N logical processors, N copies of this network are simulated,
+// the k-th copy on ranks 2k and 2k+1, with addresses 10.(k+1).x.0.
+// Setting packets and interval such that several packets cross the
+// p2p link within its delay exercises the batching of the packets sent
+// to a rank.
+//
+// With --multithreaded, the logical processors are the threads of a
+// single process, with the MultithreadedSimulatorImpl, and MPI is not
+// needed; --SimulatorThreads sets their number.
 
 using namespace ns3;
 
@@ -54,6 +67,9 @@ main (int argc, char *argv[])
   uint32_t nWifi = 3;
   bool tracing = false;
   bool nullmsg = false;
+  bool multithreaded = false;
+  uint32_t packets = 1;
+  double interval = 1.0;
 
   CommandLine cmd;
   cmd.AddValue ("nCsma", "Number of \"extra\" CSMA nodes/devices", nCsma);
@@ -61,6 +77,9 @@ main (int argc, char *argv[])
   cmd.AddValue ("verbose", "Tell echo applications to log if true", verbose);
   cmd.AddValue ("tracing", "Enable pcap tracing", tracing);
   cmd.AddValue ("nullmsg", "Enable the use of null-message synchronization", nullmsg);
+  cmd.AddValue ("multithreaded", "Run the logical processors in threads instead of MPI processes", multithreaded);
+  cmd.AddValue ("packets", "Number of packets sent by each echo client", packets);
+  cmd.AddValue ("interval", "Interval between the packets sent, in seconds", interval);
 
   cmd.Parse (argc,argv);
 
@@ -83,187 +102,208 @@ main (int argc, char *argv[])
   uint32_t systemId = 0;
   uint32_t systemCount = 1;
 
-#ifdef NS3_MPI
-
-  // Distributed simulation setup; by default use granted time window algorithm.
-  if(nullmsg) 
-    {
-      GlobalValue::Bind ("SimulatorImplementationType",
-                         StringValue ("ns3::NullMessageSimulatorImpl"));
-    } 
-  else 
+  if (multithreaded)
     {
+      // All the logical processors are in this process: it sets up
+      // all of them.
       GlobalValue::Bind ("SimulatorImplementationType",
-                         StringValue ("ns3::DistributedSimulatorImpl"));
+                         StringValue ("ns3::MultithreadedSimulatorImpl"));
+      MpiInterface::Enable (&argc, &argv);
+      systemCount = MpiInterface::GetSize ();
     }
+  else
+    {
+#ifdef NS3_MPI
+      // Distributed simulation setup; by default use granted time window algorithm.
+      if(nullmsg) 
+        {
+          GlobalValue::Bind ("SimulatorImplementationType",
+                             StringValue ("ns3::NullMessageSimulatorImpl"));
+        } 
+      else 
+        {
+          GlobalValue::Bind ("SimulatorImplementationType",
+                             StringValue ("ns3::DistributedSimulatorImpl"));
+        }
 
-  MpiInterface::Enable (&argc, &argv);
+      MpiInterface::Enable (&argc, &argv);
 
-  systemId = MpiInterface::GetSystemId ();
-  systemCount = MpiInterface::GetSize ();
+      systemId = MpiInterface::GetSystemId ();
+      systemCount = MpiInterface::GetSize ();
+#endif // NS3_MPI
+    }
 
   // Check for valid distributed parameters.
-  // Must have 2 and only 2 Logical Processors (LPs)
-  if (systemCount != 2)
+  // Must have an even number of Logical Processors (LPs)
+  if (MpiInterface::IsEnabled () && (systemCount < 2 || systemCount % 2 != 0))
     {
-      std::cout << "This simulation requires 2 and only 2 logical processors." << std::endl;
+      std::cout << "This simulation requires an even number of logical processors." << std::endl;
       return 1;
     }
 
-#endif // NS3_MPI
-
-  // System id of Wifi side
-  uint32_t systemWifi = 0;
-  
-  // System id of CSMA side
-  uint32_t systemCsma = systemCount - 1;
-  
-  NodeContainer p2pNodes;
-  Ptr<Node> p2pNode1 = CreateObject<Node> (systemWifi); // Create node with rank 0
-  Ptr<Node> p2pNode2 = CreateObject<Node> (systemCsma); // Create node with rank 1
-  p2pNodes.Add (p2pNode1);
-  p2pNodes.Add (p2pNode2);
-
-  PointToPointHelper pointToPoint;
-  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
-  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
-
-  NetDeviceContainer p2pDevices;
-  p2pDevices = pointToPoint.Install (p2pNodes);
-
-  NodeContainer csmaNodes;
-  csmaNodes.Add (p2pNodes.Get (1));
-  csmaNodes.Create (nCsma, systemCsma);  // Create csma nodes with rank 1
-
-  CsmaHelper csma;
-  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
-  csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (6560)));
-
-  NetDeviceContainer csmaDevices;
-  csmaDevices = csma.Install (csmaNodes);
-
-  NodeContainer wifiStaNodes;
-  wifiStaNodes.Create (nWifi, systemWifi); // Create wifi nodes with rank 0
-  NodeContainer wifiApNode = p2pNodes.Get (0);
-
-  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
-  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
-  phy.SetChannel (channel.Create ());
-
-  WifiHelper wifi;
-  wifi.SetRemoteStationManager ("ns3::AarfWifiManager");
-
-  WifiMacHelper mac;
-  Ssid ssid = Ssid ("ns-3-ssid");
-  mac.SetType ("ns3::StaWifiMac",
-               "Ssid", SsidValue (ssid),
-               "ActiveProbing", BooleanValue (false));
-
-  NetDeviceContainer staDevices;
-  staDevices = wifi.Install (phy, mac, wifiStaNodes);
-
-  mac.SetType ("ns3::ApWifiMac",
-               "Ssid", SsidValue (ssid));
-
-  NetDeviceContainer apDevices;
-  apDevices = wifi.Install (phy, mac, wifiApNode);
-
-  MobilityHelper mobility;
-
-  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
-                                 "MinX", DoubleValue (0.0),
-                                 "MinY", DoubleValue (0.0),
-                                 "DeltaX", DoubleValue (5.0),
-                                 "DeltaY", DoubleValue (10.0),
-                                 "GridWidth", UintegerValue (3),
-                                 "LayoutType", StringValue ("RowFirst"));
-
-  mobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
-                             "Bounds", RectangleValue (Rectangle (-50, 50, -50, 50)));
-  mobility.Install (wifiStaNodes);
-
-  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
-  mobility.Install (wifiApNode);
-
-  InternetStackHelper stack;
-  stack.Install (csmaNodes);
-  stack.Install (wifiApNode);
-  stack.Install (wifiStaNodes);
-
-  Ipv4AddressHelper address;
-
-  address.SetBase ("10.1.1.0", "255.255.255.0");
-  Ipv4InterfaceContainer p2pInterfaces;
-  p2pInterfaces = address.Assign (p2pDevices);
-
-  address.SetBase ("10.1.2.0", "255.255.255.0");
-  Ipv4InterfaceContainer csmaInterfaces;
-  csmaInterfaces = address.Assign (csmaDevices);
-
-  address.SetBase ("10.1.3.0", "255.255.255.0");
-  address.Assign (staDevices);
-  address.Assign (apDevices);
-
-  // If this rank is systemCsma, 
-  // it should contain the server application, 
-  // since it is on one of the csma nodes
-  if (systemId == systemCsma)
-    {
-      UdpEchoServerHelper echoServer (9);
-
-      ApplicationContainer serverApps = echoServer.Install (csmaNodes.Get (nCsma));
-      serverApps.Start (Seconds (1.0));
-      serverApps.Stop (Seconds (10.0));
-    }
-
-  // If this rank is systemWifi
-  // it should contain the client application, 
-  // since it is on one of the wifi nodes
-  if (systemId == systemWifi)
+  uint32_t nCopies = std::max<uint32_t> (1, systemCount / 2);
+  for (uint32_t copy = 0; copy < nCopies; ++copy)
     {
-      UdpEchoClientHelper echoClient (csmaInterfaces.GetAddress (nCsma), 9);
-      echoClient.SetAttribute ("MaxPackets", UintegerValue (1));
-      echoClient.SetAttribute ("Interval", TimeValue (Seconds (1.0)));
-      echoClient.SetAttribute ("PacketSize", UintegerValue (1024));
-
-      ApplicationContainer clientApps = 
-        echoClient.Install (wifiStaNodes.Get (nWifi - 1));
-      clientApps.Start (Seconds (2.0));
-      clientApps.Stop (Seconds (10.0));
-    }
- 
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+      // System id of Wifi side
+      uint32_t systemWifi = 2 * copy;
+
+      // System id of CSMA side
+      uint32_t systemCsma = (systemCount > 1) ? 2 * copy + 1 : 0;
+
+      NodeContainer p2pNodes;
+      Ptr<Node> p2pNode1 = CreateObject<Node> (systemWifi); // Create node on the wifi side
+      Ptr<Node> p2pNode2 = CreateObject<Node> (systemCsma); // Create node on the csma side
+      p2pNodes.Add (p2pNode1);
+      p2pNodes.Add (p2pNode2);
+
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+      pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+      NetDeviceContainer p2pDevices;
+      p2pDevices = pointToPoint.Install (p2pNodes);
+
+      NodeContainer csmaNodes;
+      csmaNodes.Add (p2pNodes.Get (1));
+      csmaNodes.Create (nCsma, systemCsma);  // Create csma nodes on the csma side
+
+      CsmaHelper csma;
+      csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+      csma.SetChannelAttribute ("Delay", TimeValue (NanoSeconds (6560)));
+
+      NetDeviceContainer csmaDevices;
+      csmaDevices = csma.Install (csmaNodes);
+
+      NodeContainer wifiStaNodes;
+      wifiStaNodes.Create (nWifi, systemWifi); // Create wifi nodes on the wifi side
+      NodeContainer wifiApNode = p2pNodes.Get (0);
+
+      YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+      YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+      phy.SetChannel (channel.Create ());
+
+      WifiHelper wifi;
+      wifi.SetRemoteStationManager ("ns3::AarfWifiManager");
+
+      WifiMacHelper mac;
+      Ssid ssid = Ssid ("ns-3-ssid");
+      mac.SetType ("ns3::StaWifiMac",
+                   "Ssid", SsidValue (ssid),
+                   "ActiveProbing", BooleanValue (false));
+
+      NetDeviceContainer staDevices;
+      staDevices = wifi.Install (phy, mac, wifiStaNodes);
+
+      mac.SetType ("ns3::ApWifiMac",
+                   "Ssid", SsidValue (ssid));
+
+      NetDeviceContainer apDevices;
+      apDevices = wifi.Install (phy, mac, wifiApNode);
+
+      MobilityHelper mobility;
+
+      mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                     "MinX", DoubleValue (0.0),
+                                     "MinY", DoubleValue (0.0),
+                                     "DeltaX", DoubleValue (5.0),
+                                     "DeltaY", DoubleValue (10.0),
+                                     "GridWidth", UintegerValue (3),
+                                     "LayoutType", StringValue ("RowFirst"));
+
+      mobility.SetMobilityModel ("ns3::RandomWalk2dMobilityModel",
+                                 "Bounds", RectangleValue (Rectangle (-50, 50, -50, 50)));
+      mobility.Install (wifiStaNodes);
+
+      mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+      mobility.Install (wifiApNode);
+
+      InternetStackHelper stack;
+      stack.Install (csmaNodes);
+      stack.Install (wifiApNode);
+      stack.Install (wifiStaNodes);
+
+      Ipv4AddressHelper address;
+      std::ostringstream network;
+
+      network << "10." << copy + 1 << ".1.0";
+      address.SetBase (network.str ().c_str (), "255.255.255.0");
+      Ipv4InterfaceContainer p2pInterfaces;
+      p2pInterfaces = address.Assign (p2pDevices);
+
+      network.str ("");
+      network << "10." << copy + 1 << ".2.0";
+      address.SetBase (network.str ().c_str (), "255.255.255.0");
+      Ipv4InterfaceContainer csmaInterfaces;
+      csmaInterfaces = address.Assign (csmaDevices);
+
+      network.str ("");
+      network << "10." << copy + 1 << ".3.0";
+      address.SetBase (network.str ().c_str (), "255.255.255.0");
+      address.Assign (staDevices);
+      address.Assign (apDevices);
+
+      // If this rank is systemCsma, 
+      // it should contain the server application, 
+      // since it is on one of the csma nodes
+      if (multithreaded || systemId == systemCsma)
+        {
+          UdpEchoServerHelper echoServer (9);
 
-  Simulator::Stop (Seconds (10.0));
+          ApplicationContainer serverApps = echoServer.Install (csmaNodes.Get (nCsma));
+          serverApps.Start (Seconds (1.0));
+          serverApps.Stop (Seconds (10.0));
+        }
 
-  if (tracing == true)
-    {
-      // Depending on the system Id (rank), the pcap information 
-      // traced will be different.  For example, the ethernet pcap
-      // will be empty for rank0, since these nodes are placed on 
-      // on rank 1.  All ethernet traffic will take place on rank 1.
-      // Similar differences are seen in the p2p and wireless pcaps.
-      if (systemId == systemWifi)
+      // If this rank is systemWifi
+      // it should contain the client application, 
+      // since it is on one of the wifi nodes
+      if (multithreaded || systemId == systemWifi)
         {
-          pointToPoint.EnablePcapAll ("third-distributed-wifi");
-          phy.EnablePcap ("third-distributed-wifi", apDevices.Get (0));
-          csma.EnablePcap ("third-distributed-wifi", csmaDevices.Get (0), true);
+          UdpEchoClientHelper echoClient (csmaInterfaces.GetAddress (nCsma), 9);
+          echoClient.SetAttribute ("MaxPackets", UintegerValue (packets));
+          echoClient.SetAttribute ("Interval", TimeValue (Seconds (interval)));
+          echoClient.SetAttribute ("PacketSize", UintegerValue (1024));
+
+          ApplicationContainer clientApps = 
+            echoClient.Install (wifiStaNodes.Get (nWifi - 1));
+          clientApps.Start (Seconds (2.0));
+          clientApps.Stop (Seconds (10.0));
         }
-      else // systemCsma
+
+      if (tracing == true)
         {
-          pointToPoint.EnablePcapAll ("third-distributed-csma");
-          phy.EnablePcap ("third-distributed-csma", apDevices.Get (0));
-          csma.EnablePcap ("third-distributed-csma", csmaDevices.Get (0), true);
+          // Depending on the system Id (rank), the pcap information 
+          // traced will be different.  For example, the ethernet pcap
+          // will be empty for rank0, since these nodes are placed on 
+          // on rank 1.  All ethernet traffic will take place on rank 1.
+          // Similar differences are seen in the p2p and wireless pcaps.
+          if (multithreaded || systemId == systemWifi)
+            {
+              pointToPoint.EnablePcap ("third-distributed-wifi", p2pDevices);
+              phy.EnablePcap ("third-distributed-wifi", apDevices.Get (0));
+              csma.EnablePcap ("third-distributed-wifi", csmaDevices.Get (0), true);
+            }
+          if ((multithreaded || systemId == systemCsma) && systemCsma != systemWifi)
+            {
+              pointToPoint.EnablePcap ("third-distributed-csma", p2pDevices);
+              phy.EnablePcap ("third-distributed-csma", apDevices.Get (0));
+              csma.EnablePcap ("third-distributed-csma", csmaDevices.Get (0), true);
+            }
         }
     }
 
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Simulator::Stop (Seconds (10.0));
+
   Simulator::Run ();
   Simulator::Destroy ();
 
-#ifdef NS3_MPI
   // Exit the MPI execution environment
-  MpiInterface::Disable ();
-#endif
+  if (MpiInterface::IsEnabled ())
+    {
+      MpiInterface::Disable ();
+    }
   
   return 0;
 }
@@ -0,0 +1,403 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "partition-helper.h"
+
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PartitionHelper");
+
+/** The largest number of passes moving the nodes between partitions. */
+static const uint32_t MAX_REFINE_PASSES = 16;
+
+namespace {
+
+/** A declared link, between node indexes. */
+struct Edge
+{
+  uint32_t a;     //!< The index of the first node.
+  uint32_t b;     //!< The index of the second node.
+  Time delay;     //!< The delay of the link.
+  double cost;    //!< The cost of cutting the link.
+};
+
+/**
+ * Order the links by increasing delay, then by declaration order.
+ */
+class EdgeDelayLess
+{
+public:
+  /**
+   * \param edges The links.
+   */
+  EdgeDelayLess (const std::vector<Edge> &edges)
+    : m_edges (edges)
+  {
+  }
+  /**
+   * \param i The index of a link.
+   * \param j The index of another link.
+   * \returns \c true if link \p i comes first.
+   */
+  bool operator () (uint32_t i, uint32_t j) const
+  {
+    if (m_edges[i].delay != m_edges[j].delay)
+      {
+        return m_edges[i].delay < m_edges[j].delay;
+      }
+    return i < j;
+  }
+private:
+  const std::vector<Edge> &m_edges; //!< The links.
+};
+
+/**
+ * Find the representative of a group of nodes, compressing the path.
+ * \param [in,out] parents The parent of each node.
+ * \param [in] i A node.
+ * \returns The representative of the group of the node.
+ */
+uint32_t
+FindGroup (std::vector<uint32_t> &parents, uint32_t i)
+{
+  while (parents[i] != i)
+    {
+      parents[i] = parents[parents[i]];
+      i = parents[i];
+    }
+  return i;
+}
+
+} // anonymous namespace
+
+PartitionHelper::PartitionHelper ()
+  : m_imbalance (0.1),
+    m_cutLinks (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PartitionHelper::SetImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  NS_ABORT_MSG_IF (imbalance < 0, "The imbalance must not be negative");
+  m_imbalance = imbalance;
+}
+
+void
+PartitionHelper::SetCost (Ptr<Node> node, double cost)
+{
+  NS_LOG_FUNCTION (this << node << cost);
+  NS_ABORT_MSG_IF (cost <= 0, "The cost of a node must be positive");
+  m_costs[node->GetId ()] = cost;
+}
+
+void
+PartitionHelper::AddLink (Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+  NS_LOG_FUNCTION (this << a << b << delay);
+  Link link;
+  link.a = a;
+  link.b = b;
+  link.delay = delay;
+  m_links.push_back (link);
+}
+
+void
+PartitionHelper::Assign (NodeContainer nodes, uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << nodes.GetN () << systemCount);
+  NS_ABORT_MSG_IF (systemCount == 0, "There must be at least one partition");
+
+  uint32_t n = nodes.GetN ();
+  std::map<uint32_t, uint32_t> indexes;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      indexes[nodes.Get (i)->GetId ()] = i;
+    }
+
+  // The links, and the loads of the nodes: their numbers of links, as
+  // their devices are not installed yet, unless a cost is given.
+  std::vector<Edge> edges;
+  std::vector<double> loads (n, 0);
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      std::map<uint32_t, uint32_t>::const_iterator a = indexes.find (i->a->GetId ());
+      std::map<uint32_t, uint32_t>::const_iterator b = indexes.find (i->b->GetId ());
+      NS_ABORT_MSG_IF (a == indexes.end () || b == indexes.end (),
+                       "Link between nodes " << i->a->GetId () << " and " << i->b->GetId ()
+                       << ", which are not all partitioned");
+      loads[a->second]++;
+      loads[b->second]++;
+      if (a->second == b->second)
+        {
+          continue;
+        }
+      Edge edge;
+      edge.a = a->second;
+      edge.b = b->second;
+      edge.delay = i->delay;
+      // Cutting a link of half the delay costs twice as much.
+      edge.cost = 1.0 / std::max<int64_t> (i->delay.GetTimeStep (), 1);
+      edges.push_back (edge);
+    }
+  double total = 0;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      std::map<uint32_t, double>::const_iterator cost = m_costs.find (nodes.Get (i)->GetId ());
+      if (cost != m_costs.end ())
+        {
+          loads[i] = cost->second;
+        }
+      else if (loads[i] == 0)
+        {
+          loads[i] = 1;
+        }
+      total += loads[i];
+    }
+  double mean = total / systemCount;
+  double capacity = mean * (1 + m_imbalance);
+
+  // Group the nodes joined by the links of the smallest delays, as long
+  // as no group gets more than the mean load.
+  std::vector<uint32_t> order (edges.size ());
+  for (uint32_t i = 0; i < order.size (); ++i)
+    {
+      order[i] = i;
+    }
+  std::sort (order.begin (), order.end (), EdgeDelayLess (edges));
+  std::vector<uint32_t> groups (n);
+  std::vector<double> groupLoads (loads);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      groups[i] = i;
+    }
+  for (std::vector<uint32_t>::const_iterator i = order.begin (); i != order.end (); ++i)
+    {
+      uint32_t a = FindGroup (groups, edges[*i].a);
+      uint32_t b = FindGroup (groups, edges[*i].b);
+      if (a == b || groupLoads[a] + groupLoads[b] > mean)
+        {
+          continue;
+        }
+      if (b < a)
+        {
+          std::swap (a, b);
+        }
+      groups[b] = a;
+      groupLoads[a] += groupLoads[b];
+    }
+
+  // Give the groups, heaviest first, to the least loaded partitions.
+  std::vector<std::pair<double, uint32_t> > sorted;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      if (FindGroup (groups, i) == i)
+        {
+          sorted.push_back (std::make_pair (-groupLoads[i], i));
+        }
+    }
+  std::sort (sorted.begin (), sorted.end ());
+  std::vector<double> partitionLoads (systemCount, 0);
+  std::vector<uint32_t> partitionNodes (systemCount, 0);
+  std::vector<uint32_t> groupPartitions (n, 0);
+  for (std::vector<std::pair<double, uint32_t> >::const_iterator i = sorted.begin (); i != sorted.end (); ++i)
+    {
+      uint32_t p = std::min_element (partitionLoads.begin (), partitionLoads.end ()) - partitionLoads.begin ();
+      groupPartitions[i->second] = p;
+      partitionLoads[p] -= i->first;
+    }
+  std::vector<uint32_t> partitions (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      partitions[i] = groupPartitions[FindGroup (groups, i)];
+      partitionNodes[partitions[i]]++;
+    }
+
+  // Move the nodes to the partitions of their neighbors while this
+  // lowers the cost of the cut links, keeps the loads balanced and
+  // cuts no link of a delay smaller than the lookahead.
+  std::vector<std::vector<uint32_t> > neighbors (n);
+  Time lookAhead = Time::Max ();
+  for (uint32_t i = 0; i < edges.size (); ++i)
+    {
+      neighbors[edges[i].a].push_back (i);
+      neighbors[edges[i].b].push_back (i);
+      if (partitions[edges[i].a] != partitions[edges[i].b])
+        {
+          lookAhead = std::min (lookAhead, edges[i].delay);
+        }
+    }
+  std::vector<double> gains (systemCount);
+  for (uint32_t pass = 0; pass < MAX_REFINE_PASSES; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          uint32_t from = partitions[i];
+          if (partitionNodes[from] == 1)
+            {
+              continue;
+            }
+          std::fill (gains.begin (), gains.end (), 0);
+          bool cutsShortLink = false;
+          for (std::vector<uint32_t>::const_iterator j = neighbors[i].begin (); j != neighbors[i].end (); ++j)
+            {
+              const Edge &edge = edges[*j];
+              uint32_t p = partitions[edge.a == i ? edge.b : edge.a];
+              gains[p] += edge.cost;
+              cutsShortLink |= p == from && edge.delay < lookAhead;
+            }
+          if (cutsShortLink)
+            {
+              continue;
+            }
+          uint32_t to = from;
+          for (uint32_t p = 0; p < systemCount; ++p)
+            {
+              if (p != from && gains[p] > gains[to] * (1 + 1e-9)
+                  && partitionLoads[p] + loads[i] <= capacity)
+                {
+                  to = p;
+                }
+            }
+          if (to != from)
+            {
+              partitions[i] = to;
+              partitionLoads[from] -= loads[i];
+              partitionLoads[to] += loads[i];
+              partitionNodes[from]--;
+              partitionNodes[to]++;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+
+  m_partitions.clear ();
+  for (uint32_t p = 0; p < systemCount; ++p)
+    {
+      Partition partition;
+      partition.nodes = partitionNodes[p];
+      partition.load = partitionLoads[p];
+      partition.cutLinks = 0;
+      partition.lookAhead = Time::Max ();
+      m_partitions.push_back (partition);
+    }
+  m_cutLinks = 0;
+  for (std::vector<Edge>::const_iterator i = edges.begin (); i != edges.end (); ++i)
+    {
+      uint32_t a = partitions[i->a];
+      uint32_t b = partitions[i->b];
+      if (a == b)
+        {
+          continue;
+        }
+      m_cutLinks++;
+      m_partitions[a].cutLinks++;
+      m_partitions[b].cutLinks++;
+      m_partitions[a].lookAhead = std::min (m_partitions[a].lookAhead, i->delay);
+      m_partitions[b].lookAhead = std::min (m_partitions[b].lookAhead, i->delay);
+    }
+
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      NS_LOG_LOGIC ("node " << nodes.Get (i)->GetId () << " in partition " << partitions[i]);
+      nodes.Get (i)->SetAttribute ("SystemId", UintegerValue (partitions[i]));
+    }
+}
+
+Time
+PartitionHelper::GetLookAhead (void) const
+{
+  Time lookAhead = Time::Max ();
+  for (std::vector<Partition>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      lookAhead = std::min (lookAhead, i->lookAhead);
+    }
+  return lookAhead;
+}
+
+Time
+PartitionHelper::GetLookAhead (uint32_t systemId) const
+{
+  NS_ASSERT (systemId < m_partitions.size ());
+  return m_partitions[systemId].lookAhead;
+}
+
+double
+PartitionHelper::GetLoad (uint32_t systemId) const
+{
+  NS_ASSERT (systemId < m_partitions.size ());
+  return m_partitions[systemId].load;
+}
+
+double
+PartitionHelper::GetLoadBalance (void) const
+{
+  double total = 0;
+  double largest = 0;
+  for (std::vector<Partition>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      total += i->load;
+      largest = std::max (largest, i->load);
+    }
+  if (total == 0)
+    {
+      return 1;
+    }
+  return largest * m_partitions.size () / total;
+}
+
+void
+PartitionHelper::Report (std::ostream &os) const
+{
+  os << m_partitions.size () << " partitions, " << m_cutLinks << " cut links, lookahead ";
+  if (GetLookAhead () == Time::Max ())
+    {
+      os << "unbounded";
+    }
+  else
+    {
+      os << GetLookAhead ().GetSeconds () << "s";
+    }
+  os << ", load balance " << GetLoadBalance () << std::endl;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      const Partition &p = m_partitions[i];
+      os << "  system " << i << ": " << p.nodes << " nodes, load " << p.load
+         << ", " << p.cutLinks << " cut links";
+      if (p.lookAhead != Time::Max ())
+        {
+          os << ", lookahead " << p.lookAhead.GetSeconds () << "s";
+        }
+      os << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_PARTITION_HELPER_H
+#define NS3_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Assign the system ids of the nodes of a distributed simulation.
+ *
+ * The links of the topology are declared with AddLink before they are
+ * installed, since the point-to-point helper needs the system ids of
+ * the nodes to choose between local and remote channels.  Assign then
+ * splits the nodes into partitions of balanced loads, the load of a
+ * node being its number of links, or the cost given with SetCost, and
+ * cuts the links of the largest delays first, so that the lookahead,
+ * the smallest delay of the links between two partitions, is as large
+ * as possible.
+ *
+ * \code
+ *   PartitionHelper partition;
+ *   partition.AddLink (nodes.Get (0), nodes.Get (1), MilliSeconds (10));
+ *   ...
+ *   partition.Assign (nodes, MpiInterface::GetSize ());
+ *   partition.Report (std::cout);
+ * \endcode
+ *
+ * The partition only depends on the declared links, costs and nodes:
+ * all the ranks of an MPI simulation compute the same one.
+ */
+class PartitionHelper
+{
+public:
+  /** Construct a PartitionHelper. */
+  PartitionHelper ();
+
+  /**
+   * Set the load above the mean load which a partition may have.
+   * \param imbalance The fraction of the mean load, 0.1 by default.
+   */
+  void SetImbalance (double imbalance);
+  /**
+   * Set the load of a node, instead of its number of links.
+   * \param node The node.
+   * \param cost The load of the node, relative to those of the others.
+   */
+  void SetCost (Ptr<Node> node, double cost);
+  /**
+   * Declare a link which will be installed between two nodes.
+   * \param a The first node.
+   * \param b The second node.
+   * \param delay The delay of the link.
+   */
+  void AddLink (Ptr<Node> a, Ptr<Node> b, Time delay);
+  /**
+   * Split the nodes into partitions, and set their SystemId attributes.
+   * The declared links must be between nodes of the container.
+   * \param nodes The nodes to partition.
+   * \param systemCount The number of partitions.
+   */
+  void Assign (NodeContainer nodes, uint32_t systemCount);
+
+  /**
+   * \returns The smallest delay of the links between two partitions,
+   *          or Time::Max () if no link is cut.
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \param systemId A partition.
+   * \returns The smallest delay of the cut links of a partition, or
+   *          Time::Max () if none of its links is cut.
+   */
+  Time GetLookAhead (uint32_t systemId) const;
+  /**
+   * \param systemId A partition.
+   * \returns The sum of the loads of the nodes of a partition.
+   */
+  double GetLoad (uint32_t systemId) const;
+  /**
+   * \returns The largest load of a partition divided by the mean load.
+   */
+  double GetLoadBalance (void) const;
+  /**
+   * Print the lookahead, the load and the cut links of each partition.
+   * \param os The output stream.
+   */
+  void Report (std::ostream &os) const;
+
+private:
+  /** A declared link. */
+  struct Link
+  {
+    Ptr<Node> a;       //!< The first node.
+    Ptr<Node> b;       //!< The second node.
+    Time delay;        //!< The delay of the link.
+  };
+
+  /** A partition, as computed by Assign. */
+  struct Partition
+  {
+    uint32_t nodes;    //!< The number of nodes.
+    double load;       //!< The sum of the loads of the nodes.
+    uint32_t cutLinks; //!< The number of links to another partition.
+    Time lookAhead;    //!< The smallest delay of these links.
+  };
+
+  double m_imbalance;                   //!< Allowed load above the mean.
+  std::map<uint32_t, double> m_costs;   //!< The costs, by node id.
+  std::vector<Link> m_links;            //!< The declared links.
+  std::vector<Partition> m_partitions;  //!< The last computed partitions.
+  uint32_t m_cutLinks;                  //!< The number of cut links.
+};
+
+} // namespace ns3
+
+#endif /* NS3_PARTITION_HELPER_H */
@@ -28,9 +28,12 @@
 #include "ns3/node-container.h"
 #include "ns3/ptr.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
+#include <algorithm>
 #include <cmath>
 
 #ifdef NS3_MPI
@@ -85,6 +88,32 @@ DistributedSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Mpi")
     .AddConstructor<DistributedSimulatorImpl> ()
+    .AddAttribute ("AdaptiveWindow",
+                   "Whether the time window of a rank is bounded by the next event "
+                   "of each other rank plus the delay of the remote channels from it, "
+                   "rather than by the earliest next event plus the lookahead.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DistributedSimulatorImpl::m_adaptiveWindow),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Windows",
+                   "The number of synchronizations of this rank with the others.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DistributedSimulatorImpl::m_windows),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("SyncTime",
+                   "The wall-clock time this rank spent synchronizing with the others.",
+                   TypeId::ATTR_GET,
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DistributedSimulatorImpl::m_syncTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("IdleTime",
+                   "The wall-clock time this rank spent in the synchronizations "
+                   "after which it had no event to run.",
+                   TypeId::ATTR_GET,
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DistributedSimulatorImpl::m_idleTime),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -118,6 +147,8 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_events = 0;
+  m_adaptiveWindow = false;
+  m_windows = 0;
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl ()
@@ -178,6 +209,10 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
         }
       // else it was already set by SetLookAhead
 
+      // The smallest delay of the remote channels to each rank.
+      std::vector<int64_t> row (m_systemCount, GetMaximumSimulationTime ().GetTimeStep ());
+      int64_t maxLookAhead = m_lookAhead.GetTimeStep ();
+
       NodeContainer c = NodeContainer::GetGlobal ();
       for (NodeContainer::Iterator iter = c.Begin (); iter != c.End (); ++iter)
         {
@@ -227,8 +262,12 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
                 {
                   m_lookAhead = delay.Get ();
                 }
+              int64_t &pair = row[remoteNode->GetSystemId ()];
+              pair = std::min (pair, std::min (delay.Get ().GetTimeStep (), maxLookAhead));
             }
         }
+
+      CalculatePairLookAheads (row);
     }
 
   // m_lookAhead is now set
@@ -281,6 +320,54 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
 #endif
 }
 
+void
+DistributedSimulatorImpl::CalculatePairLookAheads (const std::vector<int64_t> &row)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  // Gather the delays between all the ranks
+  uint32_t n = m_systemCount;
+  std::vector<int64_t> delays (n * n);
+  MPI_Allgather (const_cast<int64_t *> (&row[0]), n, MPI_INT64_T,
+                 &delays[0], n, MPI_INT64_T, MPI_COMM_WORLD);
+
+  // An event may reach a rank through other ranks: the lookahead from
+  // a rank to another is the length of the shortest path between them,
+  // which is a cycle from a rank to itself.
+  const int64_t infinity = GetMaximumSimulationTime ().GetTimeStep ();
+  for (uint32_t k = 0; k < n; ++k)
+    {
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          int64_t ik = delays[i * n + k];
+          if (ik == infinity)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < n; ++j)
+            {
+              int64_t kj = delays[k * n + j];
+              if (kj < infinity - ik && ik + kj < delays[i * n + j])
+                {
+                  delays[i * n + j] = ik + kj;
+                }
+            }
+        }
+    }
+
+  m_pairLookAheads.resize (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_pairLookAheads[i] = delays[i * n + m_myId];
+      NS_LOG_LOGIC ("lookahead from rank " << i << " to rank " << m_myId << ": " << m_pairLookAheads[i]);
+    }
+#else
+  NS_UNUSED (row);
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
 void
 DistributedSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
 {
@@ -385,7 +472,10 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
-          // First receive any pending messages
+          double syncStart = MPI_Wtime ();
+          // First send the packets batched during the window
+          GrantedTimeWindowMpiInterface::FlushSendBuffers ();
+          // Then receive any pending messages
           GrantedTimeWindowMpiInterface::ReceiveMessages ();
           // reset next time
           nextTime = Next ();
@@ -420,7 +510,24 @@ DistributedSimulatorImpl::Run (void)
               // If lookahead is infinite then granted time should be as well.
               // Covers the edge case if all the tasks have no inter tasks
               // links, prevents overflow of granted time.
-              if (m_lookAhead == GetMaximumSimulationTime ())
+              if (m_adaptiveWindow && !m_pairLookAheads.empty ())
+                {
+                  // The earliest time at which an event of a rank, this
+                  // one included, could reach this rank.
+                  int64_t infinity = GetMaximumSimulationTime ().GetTimeStep ();
+                  int64_t granted = infinity;
+                  for (uint32_t i = 0; i < m_systemCount; ++i)
+                    {
+                      int64_t next = m_pLBTS[i].GetSmallestTime ().GetTimeStep ();
+                      int64_t lookAhead = m_pairLookAheads[i];
+                      if (lookAhead < infinity && next < infinity - lookAhead)
+                        {
+                          granted = std::min (granted, next + lookAhead);
+                        }
+                    }
+                  m_grantedTime = TimeStep (granted);
+                }
+              else if (m_lookAhead == GetMaximumSimulationTime ())
                 {
                   m_grantedTime = GetMaximumSimulationTime ();
                 }
@@ -430,6 +537,14 @@ DistributedSimulatorImpl::Run (void)
                   m_grantedTime = smallestTime + m_lookAhead;
                 }
             }
+
+          m_windows++;
+          Time syncTime = Seconds (MPI_Wtime () - syncStart);
+          m_syncTime += syncTime;
+          if (nextTime > m_grantedTime || IsLocalFinished ())
+            {
+              m_idleTime += syncTime;
+            }
         }
 
       // Execute next event if it is within the current time window.
@@ -443,6 +558,9 @@ DistributedSimulatorImpl::Run (void)
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
   NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_LOG_INFO ("rank " << m_myId << ": " << m_windows << " windows, "
+               << m_syncTime.GetSeconds () << "s synchronizing, "
+               << m_idleTime.GetSeconds () << "s idle");
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
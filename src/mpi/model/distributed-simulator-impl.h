@@ -24,8 +24,10 @@
 #include "ns3/scheduler.h"
 #include "ns3/event-impl.h"
 #include "ns3/ptr.h"
+#include "ns3/nstime.h"
 
 #include <list>
+#include <vector>
 
 namespace ns3 {
 
@@ -97,6 +99,18 @@ private:
  * \ingroup mpi
  *
  * \brief Distributed simulator implementation using lookahead
+ *
+ * By default, the time window granted to a rank ends at the earliest
+ * next event of all the ranks plus the lookahead, the smallest delay of
+ * its remote point-to-point channels.  With the AdaptiveWindow attribute,
+ * the lookahead between each pair of ranks is derived from the remote
+ * channels between them, and the window of a rank ends at the earliest
+ * time at which an event of another rank could reach it, given the next
+ * event of each rank: a quiet rank, or one far away in the topology, no
+ * longer bounds the windows of the others.
+ *
+ * The Windows, SyncTime and IdleTime attributes count the
+ * synchronizations of this rank and the wall-clock time they took.
  */
 class DistributedSimulatorImpl : public SimulatorImpl
 {
@@ -130,6 +144,13 @@ public:
 private:
   virtual void DoDispose (void);
   void CalculateLookAhead (void);
+  /**
+   * Compute the smallest delay after which an event of each rank can
+   * reach this one, through the remote channels between the ranks.
+   * \param [in] row The smallest delay of the remote channels from this
+   *             rank to each rank, in time steps.
+   */
+  void CalculatePairLookAheads (const std::vector<int64_t> &row);
   bool IsLocalFinished (void) const;
 
   void ProcessOneEvent (void);
@@ -155,6 +176,16 @@ private:
   Time         m_grantedTime; // Last LBTS
   static Time  m_lookAhead;   // Lookahead value
 
+  bool         m_adaptiveWindow; // Use the lookahead of each pair of ranks
+  /**
+   * The smallest delay after which an event of each rank can reach
+   * this one, in time steps.
+   */
+  std::vector<int64_t> m_pairLookAheads;
+  uint64_t     m_windows;     // Number of synchronizations
+  Time         m_syncTime;    // Wall-clock time spent synchronizing
+  Time         m_idleTime;    // Wall-clock time spent without events to run
+
 };
 
 } // namespace ns3
@@ -23,6 +23,7 @@
 #include <iostream>
 #include <iomanip>
 #include <list>
+#include <cstring>
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-receiver.h"
@@ -35,6 +36,7 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -82,12 +84,30 @@ bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
 std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
+std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_freeTx;
+std::vector<std::list<SentBuffer> > GrantedTimeWindowMpiInterface::m_batchTx;
+std::vector<uint32_t> GrantedTimeWindowMpiInterface::m_batchSize;
 
 #ifdef NS3_MPI
 MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
 char**       GrantedTimeWindowMpiInterface::m_pRxBuffers;
+
+// Completed receives, as returned by MPI_Testsome
+static std::vector<int> g_rxIndices;
+static std::vector<MPI_Status> g_rxStatuses;
 #endif
 
+/**
+ * Header of each packet batched in a message: the packet follows it.
+ */
+struct BatchedPacketHeader
+{
+  uint64_t time;  //!< the receive time, in time steps
+  uint32_t node;  //!< the destination node
+  uint32_t dev;   //!< the destination device
+  uint32_t size;  //!< the size of the serialized packet
+};
+
 TypeId 
 GrantedTimeWindowMpiInterface::GetTypeId (void)
 {
@@ -112,6 +132,11 @@ GrantedTimeWindowMpiInterface::Destroy ()
   delete [] m_requests;
 
   m_pendingTx.clear ();
+  m_freeTx.clear ();
+  m_batchTx.clear ();
+  m_batchSize.clear ();
+  g_rxIndices.clear ();
+  g_rxStatuses.clear ();
 #endif
 }
 
@@ -149,6 +174,12 @@ GrantedTimeWindowMpiInterface::GetSize ()
   return m_size;
 }
 
+bool
+GrantedTimeWindowMpiInterface::IsLocal (uint32_t systemId)
+{
+  return systemId == GetSystemId ();
+}
+
 bool
 GrantedTimeWindowMpiInterface::IsEnabled ()
 {
@@ -182,6 +213,10 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
       MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
                  MPI_COMM_WORLD, &m_requests[i]);
     }
+  m_batchTx.resize (m_size);
+  m_batchSize.resize (m_size, 0);
+  g_rxIndices.resize (m_size);
+  g_rxStatuses.resize (m_size);
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
@@ -193,35 +228,83 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
-
   uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
-  // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
+  uint32_t recordSize = sizeof (BatchedPacketHeader) + serializedSize;
+  NS_ABORT_MSG_IF (recordSize > MAX_MPI_MSG_SIZE, "Packet of " << serializedSize << " bytes too large for MPI");
 
   // Find the system id for the destination node
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
+  // Batch the packet with the others sent to the same rank during the
+  // granted time window, in a buffer of a completed send if any
+  if (m_batchSize[nodeSysId] + recordSize > MAX_MPI_MSG_SIZE)
+    {
+      Flush (nodeSysId);
+    }
+  std::list<SentBuffer> &batch = m_batchTx[nodeSysId];
+  if (batch.empty ())
+    {
+      if (m_freeTx.empty ())
+        {
+          m_freeTx.push_back (SentBuffer ());
+          m_freeTx.back ().SetBuffer (new uint8_t[MAX_MPI_MSG_SIZE]);
+        }
+      batch.splice (batch.end (), m_freeTx, m_freeTx.begin ());
+    }
+  uint8_t* buffer = batch.front ().GetBuffer () + m_batchSize[nodeSysId];
+
+  // Add the time, dest node and dest device
+  BatchedPacketHeader header;
+  header.time = rxTime.GetInteger ();
+  header.node = node;
+  header.dev = dev;
+  header.size = serializedSize;
+  std::memcpy (buffer, &header, sizeof (header));
+  // Serialize the packet
+  p->Serialize (buffer + sizeof (header), serializedSize);
+  m_batchSize[nodeSysId] += recordSize;
   m_txCount++;
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
 }
 
+void
+GrantedTimeWindowMpiInterface::Flush (uint32_t rank)
+{
+  NS_LOG_FUNCTION (rank << m_batchSize[rank]);
+
+#ifdef NS3_MPI
+  std::list<SentBuffer> &batch = m_batchTx[rank];
+  if (batch.empty ())
+    {
+      return;
+    }
+  MPI_Isend (reinterpret_cast<void *> (batch.front ().GetBuffer ()), m_batchSize[rank], MPI_CHAR, rank,
+             0, MPI_COMM_WORLD, batch.front ().GetRequest ());
+  m_pendingTx.splice (m_pendingTx.end (), batch);
+  m_batchSize[rank] = 0;
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+void
+GrantedTimeWindowMpiInterface::FlushSendBuffers ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+#ifdef NS3_MPI
+  for (uint32_t rank = 0; rank < m_batchTx.size (); ++rank)
+    {
+      Flush (rank);
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
 void
 GrantedTimeWindowMpiInterface::ReceiveMessages ()
 { 
@@ -231,55 +314,62 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
   // Poll the non-block reads to see if data arrived
   while (true)
     {
-      int flag = 0;
-      int index = 0;
-      MPI_Status status;
+      int count = 0;
 
-      MPI_Testany (MpiInterface::GetSize (), m_requests, &index, &flag, &status);
-      if (!flag)
+      MPI_Testsome (MpiInterface::GetSize (), m_requests, &count, &g_rxIndices[0], &g_rxStatuses[0]);
+      if (count == 0 || count == MPI_UNDEFINED)
         {
           break;        // No more messages
         }
-      int count;
-      MPI_Get_count (&status, MPI_CHAR, &count);
-      m_rxCount++; // Count this receive
-
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
-
-      Time rxTime (time);
-
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
-
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
-
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
+      for (int k = 0; k < count; ++k)
         {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          int index = g_rxIndices[k];
+          int size;
+          MPI_Get_count (&g_rxStatuses[k], MPI_CHAR, &size);
+
+          // Each message holds a batch of packets, deserialized in turn
+          const uint8_t* record = reinterpret_cast<uint8_t *> (m_pRxBuffers[index]);
+          const uint8_t* end = record + size;
+          while (record < end)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              m_rxCount++; // Count this receive
+
+              // Get the meta data first
+              BatchedPacketHeader header;
+              std::memcpy (&header, record, sizeof (header));
+              record += sizeof (header);
+              NS_ASSERT (record + header.size <= end);
+
+              Time rxTime (header.time);
+
+              Ptr<Packet> p = Create<Packet> (record, header.size, true);
+              record += header.size;
+
+              // Find the correct node/device to schedule receive event
+              Ptr<Node> pNode = NodeList::GetNode (header.node);
+              Ptr<MpiReceiver> pMpiRec = 0;
+              uint32_t nDevices = pNode->GetNDevices ();
+              for (uint32_t i = 0; i < nDevices; ++i)
+                {
+                  Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+                  if (pThisDev->GetIfIndex () == header.dev)
+                    {
+                      pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                      break;
+                    }
+                }
+
+              NS_ASSERT (pNode && pMpiRec);
+
+              // Schedule the rx event
+              Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                              &MpiReceiver::Receive, pMpiRec, p);
             }
-        }
 
-      NS_ASSERT (pNode && pMpiRec);
-
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
-
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+          // Re-queue the next read
+          MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
+                     MPI_COMM_WORLD, &m_requests[index]);
+        }
     }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -301,8 +391,8 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
       std::list<SentBuffer>::iterator current = i; // Save current for erasing
       i++;                                    // Advance to next
       if (flag)
-        { // This message is complete
-          m_pendingTx.erase (current);
+        { // This message is complete, its buffer can be reused
+          m_freeTx.splice (m_freeTx.end (), m_pendingTx, current);
         }
     }
 #else
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -41,9 +42,10 @@ namespace ns3 {
 
 /**
  * maximum MPI message size for easy
- * buffer creation
+ * buffer creation.  The packets sent to a rank are batched in messages
+ * of at most this size.
  */
-const uint32_t MAX_MPI_MSG_SIZE = 2000;
+const uint32_t MAX_MPI_MSG_SIZE = 65536;
 
 /**
  * \ingroup mpi
@@ -51,7 +53,8 @@ const uint32_t MAX_MPI_MSG_SIZE = 2000;
  * \brief Tracks non-blocking sends
  *
  * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
+ * sends that have been posted, and of the buffers which can be reused
+ * once their send completed.
  */
 class SentBuffer
 {
@@ -105,6 +108,11 @@ public:
    * \return MPI size (number of systems)
    */
   virtual uint32_t GetSize ();
+  /**
+   * \param systemId a system id
+   * \return true if systemId is the MPI rank of this process
+   */
+  virtual bool IsLocal (uint32_t systemId);
   /**
    * \return true if using MPI
    */
@@ -131,6 +139,10 @@ public:
    * Serialize and send a packet to the specified node and net device
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Send the packets batched for each rank
+   */
+  static void FlushSendBuffers ();
   /**
    * Check for received messages complete
    */
@@ -168,6 +180,22 @@ private:
 
   // List of pending non-blocking sends
   static std::list<SentBuffer> m_pendingTx;
+
+  // Buffers of completed sends, to reuse
+  static std::list<SentBuffer> m_freeTx;
+
+  // Buffer of the packets batched for each rank, if any
+  static std::vector<std::list<SentBuffer> > m_batchTx;
+
+  // Number of bytes batched for each rank
+  static std::vector<uint32_t> m_batchSize;
+
+  /**
+   * \param rank the rank to send to
+   *
+   * Send the packets batched for a rank
+   */
+  static void Flush (uint32_t rank);
 };
 
 } // namespace ns3
@@ -66,6 +66,14 @@ public:
    * When running a sequential simulation this will return a size of 1.
    */
   static uint32_t GetSize ();
+  /**
+   * \param systemId a system id
+   * \return true if the nodes of this system id are simulated by this
+   *         process, so that it must set up their routes and applications
+   *
+   * When running a sequential simulation, only system id 0 is local.
+   */
+  static bool IsLocal (uint32_t systemId);
   /**
    * \return true if parallel communication is enabled
    */
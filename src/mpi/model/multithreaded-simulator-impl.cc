@@ -0,0 +1,816 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+#include "mpi-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/core-config.h"
+#include "ns3/simulator.h"
+#include "ns3/channel.h"
+#include "ns3/channel-list.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
+#include <algorithm>
+#include <thread>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/** The largest timestamp, that of GetMaximumSimulationTime (). */
+static const uint64_t MAXIMUM_TS = 0x7fffffffffffffffULL;
+/** The number of events an inbox holds before its overflow list is used. */
+static const uint32_t INBOX_SIZE = 4096;
+/** The number of polls of a barrier before the waiting thread yields. */
+static const uint32_t BARRIER_SPINS = 1000;
+
+thread_local MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+
+bool
+MultithreadedSimulatorImpl::InboxEvent::operator < (const InboxEvent &o) const
+{
+  if (timestamp != o.timestamp)
+    {
+      return timestamp < o.timestamp;
+    }
+  if (source != o.source)
+    {
+      return source < o.source;
+    }
+  return sequence < o.sequence;
+}
+
+MultithreadedSimulatorImpl::Partition::Partition (MultithreadedSimulatorImpl *simulator,
+                                                  uint32_t partitionId)
+  : simulator (simulator),
+    id (partitionId),
+    events (0),
+    // uids are allocated from 4.
+    // uid 0 is "invalid" events
+    // uid 1 is "now" events
+    // uid 2 is "destroy" events
+    uid (4),
+    currentUid (0),
+    currentTs (0),
+    currentContext (Simulator::NO_CONTEXT),
+    unscheduledEvents (0),
+    nextTs (MAXIMUM_TS),
+    windowEnd (MAXIMUM_TS),
+    stopTs (MAXIMUM_TS),
+    stopped (false),
+    sent (0),
+    packetUid (0),
+    inbox (INBOX_SIZE)
+{
+}
+
+void
+MultithreadedSimulatorImpl::Partition::Run (void)
+{
+  // Each Run () starts a new thread: it continues the packet uids of
+  // the previous thread of this partition.
+  Packet::SetUidCounter (packetUid);
+  simulator->RunPartition (this);
+  packetUid = Packet::GetUidCounter ();
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_running (false),
+    m_stop (false),
+    m_stopTs (MAXIMUM_TS),
+    m_maxLookAhead (TimeStep (MAXIMUM_TS)),
+    m_lookAhead (MAXIMUM_TS),
+    m_barrierWaiting (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_partitions.push_back (new Partition (this, 0));
+  m_global = new Partition (this, 0);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      while (!p->events->IsEmpty ())
+        {
+          Scheduler::Event next = p->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      p->events = 0;
+      InboxEvent ev;
+      while (p->inbox.TryPop (ev))
+        {
+          ev.event->Unref ();
+        }
+      for (std::list<InboxEvent>::iterator j = p->overflow.begin (); j != p->overflow.end (); ++j)
+        {
+          j->event->Unref ();
+        }
+      delete p;
+    }
+  m_partitions.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        // The destroy events may schedule or remove other destroy
+        // events: do not hold the lock while they run.
+        CriticalSection cs (m_destroyEventsMutex);
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+
+  if (MpiInterface::IsEnabled ())
+    {
+      MpiInterface::Destroy ();
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (void) const
+{
+  if (m_current != 0)
+    {
+      return m_current;
+    }
+  NS_ASSERT_MSG (!m_running, "The simulator is used by a thread which runs no partition");
+  return m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context < m_nodePartitions.size ())
+    {
+      return m_partitions[m_nodePartitions[context]];
+    }
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return m_global;
+    }
+  return GetPartition ();
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  // Outside of Run (), all the uids come from the global events, so
+  // that those which Prepare () moves to a partition remain distinct.
+  Partition *uids = m_running ? p : m_global;
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = uids->uid;
+  uids->uid++;
+  p->unscheduledEvents++;
+  p->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+void
+MultithreadedSimulatorImpl::Prepare (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t nPartitions = MpiInterface::IsEnabled () ? MpiInterface::GetSize () : 1;
+#ifndef HAVE_PTHREAD_H
+  NS_ABORT_MSG_IF (nPartitions > 1, "MultithreadedSimulatorImpl needs threads to run "
+                   << nPartitions << " partitions");
+#endif
+  while (m_partitions.size () < nPartitions)
+    {
+      Partition *p = new Partition (this, m_partitions.size ());
+      p->events = m_schedulerFactory.Create<Scheduler> ();
+      p->currentTs = m_global->currentTs;
+      m_partitions.push_back (p);
+    }
+
+  m_nodePartitions.clear ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      uint32_t systemId = (*i)->GetSystemId ();
+      NS_ABORT_MSG_IF (systemId >= m_partitions.size (),
+                       "Node " << (*i)->GetId () << " has system id " << systemId
+                       << " but the simulation has " << m_partitions.size () << " partitions");
+      m_nodePartitions.push_back (systemId);
+    }
+
+  // The events scheduled for the nodes before their partitions were
+  // known are with the global events: move them to their partitions.
+  Ptr<Scheduler> events = m_schedulerFactory.Create<Scheduler> ();
+  while (!m_global->events->IsEmpty ())
+    {
+      Scheduler::Event next = m_global->events->RemoveNext ();
+      Partition *p = GetPartition (next.key.m_context);
+      if (p == m_global)
+        {
+          events->Insert (next);
+        }
+      else
+        {
+          p->events->Insert (next);
+          m_global->unscheduledEvents--;
+          p->unscheduledEvents++;
+        }
+    }
+  m_global->events = events;
+
+  // The partitions allocate uids from the largest one allocated so far.
+  uint32_t uid = m_global->uid;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      uid = std::max (uid, m_partitions[i]->uid);
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      m_partitions[i]->uid = uid;
+    }
+  m_global->uid = uid;
+
+  // The lookahead is the smallest delay of the channels between two
+  // partitions, all of which must be remote channels.
+  m_lookAhead = m_maxLookAhead.GetTimeStep ();
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); ++i)
+    {
+      Ptr<Channel> channel = *i;
+      bool crossing = false;
+      bool remote = channel->GetNDevices () > 0;
+      for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = channel->GetDevice (j);
+          crossing |= device->GetNode ()->GetSystemId () != channel->GetDevice (0)->GetNode ()->GetSystemId ();
+          remote &= device->GetObject<MpiReceiver> () != 0;
+        }
+      if (!crossing)
+        {
+          continue;
+        }
+      NS_ABORT_MSG_UNLESS (remote, "Channel " << channel->GetId ()
+                           << " connects the nodes of different partitions but is not a remote channel");
+      TimeValue delay;
+      NS_ABORT_MSG_UNLESS (channel->GetAttributeFailSafe ("Delay", delay),
+                           "Remote channel " << channel->GetId () << " has no delay");
+      if (static_cast<uint64_t> (delay.Get ().GetTimeStep ()) < m_lookAhead)
+        {
+          m_lookAhead = delay.Get ().GetTimeStep ();
+        }
+    }
+  NS_ABORT_MSG_IF (m_lookAhead == 0, "The remote channels between partitions must have a positive delay");
+  NS_LOG_LOGIC ("lookahead " << m_lookAhead << " with " << m_partitions.size () << " partitions");
+}
+
+void
+MultithreadedSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
+{
+  NS_LOG_FUNCTION (this << lookAhead);
+  if (lookAhead > TimeStep (0))
+    {
+      m_maxLookAhead = lookAhead;
+    }
+  else
+    {
+      NS_LOG_WARN ("attempted to set lookahead to a negative time: " << lookAhead);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+
+  m_schedulerFactory = schedulerFactory;
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*i)->events != 0)
+        {
+          while (!(*i)->events->IsEmpty ())
+            {
+              Scheduler::Event next = (*i)->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *p)
+{
+  Scheduler::Event next = p->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= p->currentTs);
+  p->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts << " in partition " << p->id);
+  p->currentTs = next.key.m_ts;
+  p->currentContext = next.key.m_context;
+  p->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessInbox (Partition *p)
+{
+  InboxEvent ev;
+  p->received.clear ();
+  while (p->inbox.TryPop (ev))
+    {
+      p->received.push_back (ev);
+    }
+  {
+    CriticalSection cs (p->overflowMutex);
+    p->received.insert (p->received.end (), p->overflow.begin (), p->overflow.end ());
+    p->overflow.clear ();
+  }
+  if (p->received.empty ())
+    {
+      return;
+    }
+
+  // The inbox order depends on the timing of the threads: the uids
+  // must not.
+  std::sort (p->received.begin (), p->received.end ());
+  for (std::vector<InboxEvent>::const_iterator i = p->received.begin (); i != p->received.end (); ++i)
+    {
+      NS_ASSERT (i->timestamp >= p->currentTs);
+      Scheduler::Event next;
+      next.impl = i->event;
+      next.key.m_ts = i->timestamp;
+      next.key.m_context = i->context;
+      next.key.m_uid = p->uid;
+      p->uid++;
+      p->unscheduledEvents++;
+      p->events->Insert (next);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t generation = m_barrierGeneration.load (std::memory_order_acquire);
+  if (m_barrierWaiting.fetch_add (1, std::memory_order_acq_rel) + 1 == m_partitions.size ())
+    {
+      m_barrierWaiting.store (0, std::memory_order_relaxed);
+      m_barrierGeneration.fetch_add (1, std::memory_order_release);
+      return;
+    }
+  uint32_t spins = 0;
+  while (m_barrierGeneration.load (std::memory_order_acquire) == generation)
+    {
+      if (spins < BARRIER_SPINS)
+        {
+          spins++;
+        }
+      else
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (Partition *p)
+{
+  NS_LOG_FUNCTION (this << p->id);
+
+  m_current = p;
+  while (true)
+    {
+      // No partition runs events between the end of a window and the
+      // next barrier: the inboxes and the stop requests are stable.
+      bool stop = m_stop.load (std::memory_order_relaxed);
+      p->stopTs = m_stopTs.load (std::memory_order_relaxed);
+      ProcessInbox (p);
+      p->nextTs = p->events->IsEmpty () ? MAXIMUM_TS : p->events->PeekNext ().key.m_ts;
+      if (p->id == 0)
+        {
+          ProcessInbox (m_global);
+          m_global->nextTs = m_global->events->IsEmpty () ? MAXIMUM_TS : m_global->events->PeekNext ().key.m_ts;
+        }
+      Barrier ();
+
+      uint64_t next = MAXIMUM_TS;
+      for (uint32_t i = 0; i < m_partitions.size (); ++i)
+        {
+          next = std::min (next, m_partitions[i]->nextTs);
+        }
+      uint64_t globalTs = m_global->nextTs;
+      if (stop || std::min (next, globalTs) >= p->stopTs)
+        {
+          break;
+        }
+
+      if (globalTs <= next)
+        {
+          // The global events may access the nodes of any partition:
+          // they run alone, and insert the events they schedule for a
+          // node directly in its partition.
+          if (p->id == 0)
+            {
+              m_current = m_global;
+              while (!m_global->stopped && !m_global->events->IsEmpty ()
+                     && m_global->events->PeekNext ().key.m_ts == globalTs)
+                {
+                  ProcessOneEvent (m_global);
+                }
+              m_current = p;
+            }
+        }
+      else
+        {
+          // No event of another partition can reach this one before the
+          // earliest event plus the lookahead, and no event may run
+          // after the next global event.
+          p->windowEnd = (m_lookAhead >= MAXIMUM_TS - next) ? MAXIMUM_TS : next + m_lookAhead;
+          p->windowEnd = std::min (p->windowEnd, globalTs);
+          while (!p->stopped && !p->events->IsEmpty ())
+            {
+              uint64_t ts = p->events->PeekNext ().key.m_ts;
+              if (ts >= p->windowEnd || ts >= p->stopTs)
+                {
+                  break;
+                }
+              ProcessOneEvent (p);
+            }
+        }
+      Barrier ();
+    }
+  m_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Prepare ();
+  m_stop = false;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      m_partitions[i]->stopped = false;
+    }
+  m_global->stopped = false;
+  m_running = true;
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&Partition::Run, m_partitions[i]));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+#endif
+  RunPartition (m_partitions[0]);
+#ifdef HAVE_PTHREAD_H
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+#endif
+  m_running = false;
+
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  uint32_t uid = 0;
+  uint64_t next = MAXIMUM_TS;
+  uint64_t last = 0;
+  for (std::vector<Partition *>::const_iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      uid = std::max (uid, (*i)->uid);
+      last = std::max (last, (*i)->currentTs);
+      if (!(*i)->events->IsEmpty ())
+        {
+          next = std::min (next, (*i)->events->PeekNext ().key.m_ts);
+        }
+    }
+  uint64_t stopTs = m_stopTs;
+  bool stopReached = !m_stop && stopTs != MAXIMUM_TS && next >= stopTs;
+  for (std::vector<Partition *>::const_iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Partition *p = *i;
+      p->uid = uid;
+      if (stopReached)
+        {
+          // As if all the partitions had run the event stopping them.
+          p->currentTs = stopTs;
+          p->currentUid = 0;
+        }
+      // If the simulator stopped because there were no more events,
+      // then there should be no more events to run.
+      NS_ASSERT (!p->events->IsEmpty () || p->unscheduledEvents == 0);
+    }
+  if (stopReached)
+    {
+      m_stopTs = MAXIMUM_TS;
+    }
+  else
+    {
+      // The windows never pass a global event: Now () is the time of the
+      // last event run by any partition.
+      m_global->currentTs = last;
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return GetPartition ()->id;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::const_iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ()
+          && (*i)->events->PeekNext ().key.m_ts < m_stopTs)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_stop = true;
+  GetPartition ()->stopped = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+
+  Partition *p = GetPartition ();
+  uint64_t ts = p->currentTs + delay.GetTimeStep ();
+  uint64_t current = m_stopTs.load ();
+  while (ts < current && !m_stopTs.compare_exchange_weak (current, ts))
+    {
+    }
+  p->stopTs = std::min (p->stopTs, ts);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+
+  Partition *p = GetPartition ();
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (p->currentTs));
+  uint64_t ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  uint32_t uid = Insert (p, ts, p->currentContext, event);
+  return EventId (event, ts, p->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  Partition *current = GetPartition ();
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << current->currentTs << event);
+
+  Partition *p = GetPartition (context);
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  if (p == current || !m_running || current == m_global)
+    {
+      Insert (p, ts, context, event);
+      return;
+    }
+
+  NS_ABORT_MSG_IF (ts < current->windowEnd, "Event for context " << context << " of partition "
+                   << p->id << " scheduled by partition " << current->id << " within the lookahead");
+  InboxEvent ev;
+  ev.timestamp = ts;
+  ev.context = context;
+  ev.source = current->id;
+  ev.sequence = current->sent;
+  ev.event = event;
+  current->sent++;
+  if (!p->inbox.TryPush (ev))
+    {
+      CriticalSection cs (p->overflowMutex);
+      p->overflow.push_back (ev);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  Partition *p = GetPartition ();
+  uint32_t uid = Insert (p, p->currentTs, p->currentContext, event);
+  return EventId (event, p->currentTs, p->currentContext, uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  EventId id (Ptr<EventImpl> (event, false), GetPartition ()->currentTs, 0xffffffff, 2);
+  CriticalSection cs (m_destroyEventsMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  NS_ASSERT_MSG (!m_running || p == GetPartition () || GetPartition () == m_global,
+                 "Cannot remove an event of another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  p->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  p->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *p = GetPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p->currentTs
+      || (id.GetTs () == p->currentTs
+          && id.GetUid () <= p->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAXIMUM_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetPartition ()->currentContext;
+}
+
+} // namespace ns3
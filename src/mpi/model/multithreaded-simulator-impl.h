@@ -0,0 +1,229 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/mpsc-ring.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator implementation running the partitions of a
+ * simulation in the threads of a single process.
+ *
+ * The system id of a node selects the partition, and so the thread,
+ * running its events: the simulation is partitioned as for the
+ * DistributedSimulatorImpl, and the number of partitions is given by
+ * MpiInterface::GetSize () once the SharedMemoryInterface is enabled.
+ * Partition 0 runs in the thread calling Run ().
+ *
+ * The partitions are synchronized with barriers, in windows bounded by
+ * the lookahead, the smallest delay of the remote channels between two
+ * partitions.  An event scheduled with ScheduleWithContext () for a node
+ * of another partition goes through a lock-free inbox of that
+ * partition, and is inserted in its scheduler at the end of the window;
+ * the events received in a window are ordered by timestamp, sending
+ * partition and sending order, so that runs are repeatable.  Packets
+ * crossing a remote channel are copied, not serialized.
+ *
+ * The events without a context, such as those scheduled with
+ * Simulator::Schedule () while setting up the simulation, belong to no
+ * partition: they are global, and run in the thread calling Run () while
+ * the partitions wait, so that they may access any node.
+ *
+ * The other events must not access the objects of the nodes of another
+ * partition: only remote channels, and no wireless or shared medium
+ * channel, may connect two partitions, and on-demand routing protocols
+ * looking up all the nodes, such as nix-vector routing, cannot be used.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetMaximumLookAhead (const Time lookAhead);
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** An event sent to another partition. */
+  struct InboxEvent
+  {
+    uint64_t timestamp;  //!< Absolute event time.
+    uint32_t context;    //!< Event context.
+    uint32_t source;     //!< Partition which scheduled the event.
+    uint64_t sequence;   //!< Order of the event among those of its source.
+    EventImpl *event;    //!< The event.
+    /**
+     * Compare the times, then the sources and orders of two events.
+     * \param [in] o The other event.
+     * \returns \c true if this event comes first.
+     */
+    bool operator < (const InboxEvent &o) const;
+  };
+
+  /** The events, clock and inbox of a partition, or of the global events. */
+  struct Partition
+  {
+    /**
+     * Constructor.
+     * \param [in] simulator The simulator of this partition.
+     * \param [in] partitionId The partition index.
+     */
+    Partition (MultithreadedSimulatorImpl *simulator, uint32_t partitionId);
+    /**
+     * Run the windows of this partition, in a thread started by Run ()
+     * for the partitions other than the first one.
+     */
+    void Run (void);
+
+    MultithreadedSimulatorImpl *simulator; //!< The simulator.
+    uint32_t id;                 //!< The partition index.
+    Ptr<Scheduler> events;       //!< The events of this partition.
+    uint32_t uid;                //!< Next event uid.
+    uint32_t currentUid;         //!< Uid of the current event.
+    uint64_t currentTs;          //!< Timestamp of the current event.
+    uint32_t currentContext;     //!< Context of the current event.
+    /**
+     * The number of events that have been inserted but not yet
+     * scheduled, not counting the "destroy" events; this is used for
+     * validation.
+     */
+    int unscheduledEvents;
+    uint64_t nextTs;             //!< Next event time, at the window start.
+    uint64_t windowEnd;          //!< End of the current window, excluded.
+    uint64_t stopTs;             //!< Time at which this partition stops.
+    bool stopped;                //!< Set by Stop () in this partition.
+    uint64_t sent;               //!< Number of events sent to other partitions.
+    uint32_t packetUid;          //!< Packet uid counter, between two threads.
+    MpscRing<InboxEvent> inbox;  //!< Events sent by other partitions.
+    SystemMutex overflowMutex;   //!< Protects the overflow of the inbox.
+    std::list<InboxEvent> overflow;     //!< Events which did not fit in the inbox.
+    std::vector<InboxEvent> received;   //!< Events drained from the inbox.
+  };
+
+  /**
+   * Get the partition of the calling thread.  Before and after Run (),
+   * this is the partition of the global events.
+   * \returns The partition.
+   */
+  Partition *GetPartition (void) const;
+  /**
+   * Get the partition of the node of a context.
+   * \param [in] context The context.
+   * \returns The partition, that of the global events for
+   *          Simulator::NO_CONTEXT and that of the calling thread for
+   *          the other contexts which are not known nodes.
+   */
+  Partition *GetPartition (uint32_t context) const;
+  /**
+   * Insert an event in the scheduler of a partition, from the thread
+   * of this partition or while no other partition runs.
+   * \param [in] p The partition.
+   * \param [in] ts The event time.
+   * \param [in] context The event context.
+   * \param [in] event The event.
+   * \returns The event uid.
+   */
+  uint32_t Insert (Partition *p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Create the partitions, move the events scheduled for the nodes
+   * before Run () to their partitions and compute the lookahead.
+   */
+  void Prepare (void);
+  /**
+   * Run the windows of a partition.
+   * \param [in] p The partition.
+   */
+  void RunPartition (Partition *p);
+  /**
+   * Insert in the scheduler of a partition the events of its inbox,
+   * in a repeatable order.
+   * \param [in] p The partition.
+   */
+  void ProcessInbox (Partition *p);
+  /**
+   * Process the next event of a partition.
+   * \param [in] p The partition.
+   */
+  void ProcessOneEvent (Partition *p);
+  /** Wait until all the partitions reach this barrier. */
+  void Barrier (void);
+
+  /** The partition run by this thread, if any. */
+  static thread_local Partition *m_current;
+
+  typedef std::list<EventId> DestroyEvents;
+  DestroyEvents m_destroyEvents;
+  mutable SystemMutex m_destroyEventsMutex;
+
+  ObjectFactory m_schedulerFactory;
+  std::vector<Partition *> m_partitions;
+  /** The events without a context, run by the thread of partition 0. */
+  Partition *m_global;
+  /** The partition of each node, indexed by node id. */
+  std::vector<uint32_t> m_nodePartitions;
+  bool m_running;
+
+  std::atomic<bool> m_stop;
+  std::atomic<uint64_t> m_stopTs;
+
+  Time m_maxLookAhead;
+  uint64_t m_lookAhead;
+
+  std::atomic<uint32_t> m_barrierWaiting;
+  std::atomic<uint32_t> m_barrierGeneration;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -130,6 +130,12 @@ NullMessageMpiInterface::GetSize ()
   return g_size;
 }
 
+bool
+NullMessageMpiInterface::IsLocal (uint32_t systemId)
+{
+  return systemId == GetSystemId ();
+}
+
 bool
 NullMessageMpiInterface::IsEnabled ()
 {
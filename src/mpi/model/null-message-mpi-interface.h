@@ -104,6 +104,11 @@ public:
    * \return number of systems (MPI size)
    */
   virtual uint32_t GetSize ();
+  /**
+   * \param systemId a system id
+   * \return true if systemId is the MPI rank of this process
+   */
+  virtual bool IsLocal (uint32_t systemId);
   /**
    * \return true if interface is enabled
    */
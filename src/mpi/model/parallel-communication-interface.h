@@ -65,6 +65,11 @@ public:
    * \return number of parallel tasks
    */
   virtual uint32_t GetSize () = 0;
+  /**
+   * \param systemId a system id
+   * \return true if the nodes of this system id are simulated by this process
+   */
+  virtual bool IsLocal (uint32_t systemId) = 0;
   /**
    * \return true if parallel communication is enabled
    */
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "shared-memory-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/unused.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SharedMemoryInterface");
+
+/**
+ * \ingroup mpi
+ * The number of threads of a MultithreadedSimulatorImpl.
+ */
+static GlobalValue g_simulatorThreads = GlobalValue
+  ("SimulatorThreads",
+   "The number of threads of ns3::MultithreadedSimulatorImpl; the events "
+   "of the nodes of system id i run in the i-th thread",
+   UintegerValue (2),
+   MakeUintegerChecker<uint32_t> (1));
+
+uint32_t SharedMemoryInterface::m_size = 1;
+bool     SharedMemoryInterface::m_enabled = false;
+
+void
+SharedMemoryInterface::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+SharedMemoryInterface::GetSystemId ()
+{
+  return Simulator::GetSystemId ();
+}
+
+uint32_t
+SharedMemoryInterface::GetSize ()
+{
+  return m_size;
+}
+
+bool
+SharedMemoryInterface::IsLocal (uint32_t systemId)
+{
+  NS_UNUSED (systemId);
+  return true;
+}
+
+bool
+SharedMemoryInterface::IsEnabled ()
+{
+  return m_enabled;
+}
+
+void
+SharedMemoryInterface::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this << pargc << pargv);
+  NS_UNUSED (pargc);
+  NS_UNUSED (pargv);
+
+  UintegerValue threads;
+  g_simulatorThreads.GetValue (threads);
+  m_size = threads.Get ();
+  m_enabled = true;
+}
+
+void
+SharedMemoryInterface::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+  m_enabled = false;
+  m_size = 1;
+}
+
+void
+SharedMemoryInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
+
+  // The sender may still use its packet, and a copy made by
+  // Packet::Copy would share its buffer: the destination gets a copy
+  // of its own.
+  Simulator::ScheduleWithContext (node, rxTime - Simulator::Now (),
+                                  &SharedMemoryInterface::ReceivePacket,
+                                  node, dev, p->CreateFullCopy ());
+}
+
+void
+SharedMemoryInterface::ReceivePacket (uint32_t node, uint32_t dev, Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (node << dev << p);
+
+  // Find the correct device
+  Ptr<Node> pNode = NodeList::GetNode (node);
+  Ptr<MpiReceiver> pMpiRec = 0;
+  uint32_t nDevices = pNode->GetNDevices ();
+  for (uint32_t i = 0; i < nDevices; ++i)
+    {
+      Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+      if (pThisDev->GetIfIndex () == dev)
+        {
+          pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+          break;
+        }
+    }
+
+  NS_ASSERT (pNode && pMpiRec);
+  pMpiRec->Receive (p);
+}
+
+} // namespace ns3
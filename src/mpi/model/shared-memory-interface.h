@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_SHARED_MEMORY_INTERFACE_H
+#define NS3_SHARED_MEMORY_INTERFACE_H
+
+#include <stdint.h>
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include "parallel-communication-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Interface between the remote channels and the threads of a
+ * MultithreadedSimulatorImpl.
+ *
+ * All the nodes of the simulation live in this process: the system id
+ * of a node selects the thread, or partition, of the
+ * MultithreadedSimulatorImpl which runs its events.  The number of
+ * partitions is given by the "SimulatorThreads" global value when the
+ * interface is enabled.
+ *
+ * A packet sent over a remote channel is not serialized: the
+ * destination partition receives a copy of the packet which shares no
+ * data with the packet of the sender.
+ */
+class SharedMemoryInterface : public ParallelCommunicationInterface
+{
+public:
+  virtual void Destroy ();
+  /**
+   * \return the system id, or partition, of the calling thread
+   */
+  virtual uint32_t GetSystemId ();
+  /**
+   * \return the number of partitions
+   */
+  virtual uint32_t GetSize ();
+  /**
+   * \param systemId a system id
+   * \return true: all the partitions are in this process
+   */
+  virtual bool IsLocal (uint32_t systemId);
+  virtual bool IsEnabled ();
+  /**
+   * \param pargc number of command line arguments, unused
+   * \param pargv command line arguments, unused
+   *
+   * Sets the number of partitions from the "SimulatorThreads" global value
+   */
+  virtual void Enable (int* pargc, char*** pargv);
+  virtual void Disable ();
+  /**
+   * \param p packet to send
+   * \param rxTime received time at destination node
+   * \param node destination node
+   * \param dev destination device
+   *
+   * Schedule the reception of a copy of the packet by the destination
+   * node, in the partition of this node.
+   */
+  virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+
+private:
+  /**
+   * \param node destination node
+   * \param dev destination device
+   * \param p packet received
+   *
+   * Hand a packet to the MpiReceiver of its destination device, in the
+   * partition of the destination node.
+   */
+  static void ReceivePacket (uint32_t node, uint32_t dev, Ptr<Packet> p);
+
+  static uint32_t m_size;    //!< number of partitions
+  static bool     m_enabled; //!< true once Enable () has been called
+};
+
+} // namespace ns3
+
+#endif /* NS3_SHARED_MEMORY_INTERFACE_H */
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/mpi-interface.h"
+
+#include <set>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \brief Run a line of point-to-point links sequentially and in threads.
+ *
+ * Each node of the line sends packets on both of its links, and the
+ * nodes forward the packets they receive until they reach an end of the
+ * line.  The receptions of the nodes must be the same with the default
+ * simulator and with the MultithreadedSimulatorImpl, whatever the number
+ * of threads and from one run to the next, and the uids of the packets
+ * must be unique.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Simulate the line.
+   * \param [in] threads The number of threads, or 0 for the default
+   *             simulator.
+   * \param [in] pause Whether to stop the simulation in the middle
+   *             and run it again.
+   * \returns The receptions of the nodes.
+   */
+  std::string RunLine (uint32_t threads, bool pause);
+  /**
+   * Send a packet.
+   * \param [in] device The device sending the packet.
+   * \param [in] seq The sequence number of the packet on the device.
+   */
+  void Send (Ptr<NetDevice> device, uint8_t seq);
+  /**
+   * Record the reception of a packet and forward it along the line.
+   * \param [in] device The device receiving the packet.
+   * \param [in] packet The packet.
+   * \param [in] protocol The protocol number of the packet.
+   * \param [in] from The address of the sender.
+   * \param [in] to The destination address.
+   * \param [in] packetType The type of the packet.
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  /// The number of nodes of the line.
+  static const uint32_t N_NODES = 8;
+  std::string m_receptions[N_NODES];        //!< The receptions of each node.
+  std::vector<uint64_t> m_uids[N_NODES];    //!< The uids of the packets sent by each node.
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase ()
+  : TestCase ("Run a line of links with 1, 2 and 4 threads")
+{
+}
+
+void
+MultithreadedSimulatorTestCase::Send (Ptr<NetDevice> device, uint8_t seq)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  uint8_t data[3] = { static_cast<uint8_t> (node), static_cast<uint8_t> (device->GetIfIndex ()), seq };
+  Ptr<Packet> packet = Create<Packet> (data, sizeof (data));
+  packet->AddPaddingAtEnd (100 + (node * 37 + seq * 53) % 1000);
+  m_uids[node].push_back (packet->GetUid ());
+  device->Send (packet, device->GetBroadcast (), 0x0800);
+}
+
+void
+MultithreadedSimulatorTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                         const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  Ptr<Node> node = device->GetNode ();
+  uint8_t data[3];
+  packet->CopyData (data, sizeof (data));
+  std::ostringstream reception;
+  reception << Simulator::Now ().GetNanoSeconds () << " " << node->GetId ()
+            << " " << device->GetIfIndex () << " " << packet->GetSize ()
+            << " " << (uint32_t) data[0] << " " << (uint32_t) data[1] << " " << (uint32_t) data[2]
+            << std::endl;
+  m_receptions[node->GetId ()] += reception.str ();
+
+  if (node->GetNDevices () == 2)
+    {
+      Ptr<NetDevice> next = node->GetDevice (1 - device->GetIfIndex ());
+      next->Send (packet->Copy (), next->GetBroadcast (), protocol);
+    }
+}
+
+std::string
+MultithreadedSimulatorTestCase::RunLine (uint32_t threads, bool pause)
+{
+  StringValue simulatorType;
+  GlobalValue::GetValueByName ("SimulatorImplementationType", simulatorType);
+  if (threads > 0)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+      GlobalValue::Bind ("SimulatorThreads", UintegerValue (threads));
+      int argc = 0;
+      char **argv = 0;
+      MpiInterface::Enable (&argc, &argv);
+    }
+
+  // Consecutive nodes are in the same thread, so that some links are
+  // remote channels and some are not.
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      nodes.Add (CreateObject<Node> (i * threads / N_NODES));
+      m_receptions[i].clear ();
+      m_uids[i].clear ();
+    }
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  for (uint32_t i = 0; i + 1 < N_NODES; ++i)
+    {
+      std::ostringstream delay;
+      delay << 1 + i % 3 << "ms";
+      p2p.SetChannelAttribute ("Delay", StringValue (delay.str ()));
+      p2p.Install (nodes.Get (i), nodes.Get (i + 1));
+    }
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      node->RegisterProtocolHandler (MakeCallback (&MultithreadedSimulatorTestCase::Receive, this),
+                                     0x0800, 0);
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          for (uint8_t seq = 0; seq < 20; ++seq)
+            {
+              Time start = MicroSeconds (100000 + seq * (700 + 100 * i) + 50 * j);
+              Simulator::ScheduleWithContext (i, start, &MultithreadedSimulatorTestCase::Send,
+                                              this, node->GetDevice (j), seq);
+            }
+        }
+    }
+
+  if (pause)
+    {
+      Simulator::Stop (MilliSeconds (105));
+      Simulator::Run ();
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  if (threads > 0)
+    {
+      MpiInterface::Disable ();
+      GlobalValue::Bind ("SimulatorImplementationType", simulatorType);
+    }
+
+  std::string receptions;
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      receptions += m_receptions[i];
+    }
+  return receptions;
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  std::string sequential = RunLine (0, false);
+  NS_TEST_ASSERT_MSG_EQ (sequential.empty (), false, "No packet received");
+
+  for (uint32_t threads = 2; threads <= 4; threads *= 2)
+    {
+      for (uint32_t run = 0; run < 3; ++run)
+        {
+          std::string receptions = RunLine (threads, false);
+          NS_TEST_EXPECT_MSG_EQ (receptions, sequential, "Different receptions with " << threads
+                                 << " threads in run " << run);
+        }
+    }
+
+  // The threads of the second run continue the uids of those of the first.
+  std::string receptions = RunLine (4, true);
+  NS_TEST_EXPECT_MSG_EQ (receptions, sequential, "Different receptions with a pause");
+  std::set<uint64_t> uids;
+  uint32_t sent = 0;
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      uids.insert (m_uids[i].begin (), m_uids[i].end ());
+      sent += m_uids[i].size ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (uids.size (), sent, "Some packets have the same uid");
+}
+
+/**
+ * \ingroup mpi
+ * \brief The MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ();
+};
+
+MultithreadedSimulatorTestSuite::MultithreadedSimulatorTestSuite ()
+  : TestSuite ("mpi-multithreaded-simulator", SYSTEM)
+{
+  AddTestCase (new MultithreadedSimulatorTestCase, TestCase::QUICK);
+}
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< The test suite
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+#include "ns3/partition-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \brief Partition two star networks joined by a slow link, and a ring.
+ */
+class PartitionHelperTestCase : public TestCase
+{
+public:
+  PartitionHelperTestCase ();
+  virtual void DoRun (void);
+};
+
+PartitionHelperTestCase::PartitionHelperTestCase ()
+  : TestCase ("Partition the nodes with balanced loads and a large lookahead")
+{
+}
+
+void
+PartitionHelperTestCase::DoRun (void)
+{
+  // Two stars of 1 + 4 nodes with links of 1 ms, whose hubs are joined
+  // by a link of 10 ms: the hubs and their leaves must stay together.
+  NodeContainer nodes;
+  nodes.Create (10);
+  PartitionHelper stars;
+  for (uint32_t hub = 0; hub < 10; hub += 5)
+    {
+      for (uint32_t leaf = hub + 1; leaf < hub + 5; ++leaf)
+        {
+          stars.AddLink (nodes.Get (hub), nodes.Get (leaf), MilliSeconds (1));
+        }
+    }
+  stars.AddLink (nodes.Get (0), nodes.Get (5), MilliSeconds (10));
+  stars.Assign (nodes, 2);
+
+  NS_TEST_ASSERT_MSG_EQ (stars.GetLookAhead (), MilliSeconds (10), "Wrong lookahead");
+  NS_TEST_ASSERT_MSG_EQ (stars.GetLoadBalance (), 1, "Unbalanced stars");
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (i)->GetSystemId (), nodes.Get (i - i % 5)->GetSystemId (),
+                             "Node " << i << " is not with its hub");
+    }
+  NS_TEST_ASSERT_MSG_NE (nodes.Get (0)->GetSystemId (), nodes.Get (5)->GetSystemId (),
+                         "The hubs are in the same partition");
+
+  // A ring of 12 nodes whose links all have a 1 ms delay, but two of
+  // 5 ms: cutting these two gives halves of 6 nodes.  The nodes 0 and 1
+  // are more costly than the others.
+  NodeContainer ring;
+  ring.Create (12);
+  PartitionHelper rings;
+  for (uint32_t i = 0; i < 12; ++i)
+    {
+      rings.AddLink (ring.Get (i), ring.Get ((i + 1) % 12), (i % 6 == 5) ? MilliSeconds (5) : MilliSeconds (1));
+    }
+  rings.SetCost (ring.Get (0), 3);
+  rings.SetCost (ring.Get (1), 3);
+  rings.Assign (ring, 2);
+  NS_TEST_ASSERT_MSG_EQ (rings.GetLookAhead (), MilliSeconds (5), "Wrong ring lookahead");
+  NS_TEST_ASSERT_MSG_EQ (rings.GetLoad (0) + rings.GetLoad (1), 26, "Wrong ring loads");
+  NS_TEST_ASSERT_MSG_EQ (rings.GetLookAhead (0), MilliSeconds (5), "Wrong lookahead of partition 0");
+
+  rings.Assign (ring, 1);
+  NS_TEST_ASSERT_MSG_EQ (rings.GetLookAhead (), Time::Max (), "A single partition has no cut link");
+  for (uint32_t i = 0; i < 12; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (ring.Get (i)->GetSystemId (), 0, "Node " << i << " is not in partition 0");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi
+ * \brief The PartitionHelper test suite.
+ */
+class PartitionHelperTestSuite : public TestSuite
+{
+public:
+  PartitionHelperTestSuite ();
+};
+
+PartitionHelperTestSuite::PartitionHelperTestSuite ()
+  : TestSuite ("mpi-partition-helper", UNIT)
+{
+  AddTestCase (new PartitionHelperTestCase, TestCase::QUICK);
+}
+
+static PartitionHelperTestSuite g_partitionHelperTestSuite; //!< The test suite
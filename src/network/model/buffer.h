@@ -554,6 +554,17 @@ private:
    */
   Buffer CreateFragment (uint32_t start, uint32_t length) const;
 
+  /**
+   * \brief Create a full copy of the buffer, including
+   * all the internal structures.
+   *
+   * Unlike the copy constructor, the copy does not share the
+   * data of this buffer.
+   *
+   * \returns a copy of the buffer
+   */
+  Buffer CreateFullCopy (void) const;
+
   /**
    * \return an Iterator which points to the
    * start of this Buffer.
@@ -684,14 +695,6 @@ private:
     uint8_t m_data[1];
   };
 
-  /**
-   * \brief Create a full copy of the buffer, including
-   * all the internal structures.
-   *
-   * \returns a copy of the buffer
-   */
-  Buffer CreateFullCopy (void) const;
-
   /**
    * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
    */
@@ -764,9 +767,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value. It is kept per thread, like the free list below.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -790,6 +793,12 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
+  /*
+   * The free list is per thread, so that the threads of a parallel
+   * simulator can create and release buffers concurrently.  A buffer
+   * released by another thread than the one which created it simply
+   * goes into the free list of the releasing thread.
+   */
   /// Container for buffer data
   typedef std::vector<struct Buffer::Data*> FreeList;
   /// Local static destructor structure
@@ -797,9 +806,9 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static thread_local uint32_t g_maxSize; //!< Max observed data size
+  static thread_local FreeList *g_freeList; //!< Buffer data container
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
@@ -80,9 +80,13 @@ public:
 
   /**
    * \brief Get the node list object
+   *
+   * No reference is taken, so that the threads of a parallel simulator
+   * can look up their nodes concurrently.
+   *
    * \returns the node list
    */
-  static Ptr<NodeListPriv> Get (void);
+  static NodeListPriv *Get (void);
 
 private:
   /**
@@ -120,11 +124,11 @@ NodeListPriv::GetTypeId (void)
   return tid;
 }
 
-Ptr<NodeListPriv> 
+NodeListPriv *
 NodeListPriv::Get (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return *DoGet ();
+  return PeekPointer (*DoGet ());
 }
 Ptr<NodeListPriv> *
 NodeListPriv::DoGet (void)
@@ -143,7 +147,7 @@ void
 NodeListPriv::Delete (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  Config::UnregisterRootNamespaceObject (Get ());
+  Config::UnregisterRootNamespaceObject (*DoGet ());
   (*DoGet ()) = 0;
 }
 
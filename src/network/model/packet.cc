@@ -28,7 +28,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+thread_local uint32_t Packet::m_globalUid = 0;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -127,6 +127,36 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::CreateFullCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList byteTagList;
+  byteTagList.Add (m_byteTagList);
+  PacketMetadata metadata (m_metadata.GetUid (), 0);
+  metadata.AddAtEnd (m_metadata);
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (m_buffer.CreateFullCopy (), byteTagList,
+                                              PacketTagList (), metadata), false);
+  // the packet tags are shared by the copies of a packet, so each of
+  // them is added again to the copy
+  PacketTagIterator i = GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      PacketTagIterator::Item item = i.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+      copy->AddPacketTag (*tag);
+      delete tag;
+    }
+  if (m_nixVector != 0)
+    {
+      copy->SetNixVector (m_nixVector->Copy ());
+    }
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -545,6 +575,19 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+uint32_t
+Packet::GetUidCounter (void)
+{
+  return m_globalUid;
+}
+
+void
+Packet::SetUidCounter (uint32_t counter)
+{
+  NS_LOG_FUNCTION (counter);
+  m_globalUid = counter;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
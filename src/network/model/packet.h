@@ -424,6 +424,19 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares no dataset with the
+   * original packet.
+   *
+   * Unlike the copy returned by Copy (), the copy can be used by
+   * another thread than the original packet, such as a thread of a
+   * parallel simulator.  It keeps the uid, the tags, the metadata
+   * and the nix-vector of the original packet.
+   */
+  Ptr<Packet> CreateFullCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -502,6 +515,29 @@ public:
    */
   static void EnableChecking (void);
 
+  /**
+   * \brief Get the packet uid counter of the calling thread.
+   *
+   * The uid of a packet is the system id of its creator in the upper
+   * 32 bits, and the value of this counter in the lower 32 bits.
+   *
+   * \returns the lower 32 bits of the uid of the next packet created
+   * by the calling thread.
+   */
+  static uint32_t GetUidCounter (void);
+  /**
+   * \brief Set the packet uid counter of the calling thread.
+   *
+   * A parallel simulator running a partition in a new thread sets the
+   * counter to the value it had at the end of the previous thread of the
+   * partition, so that the partition does not allocate the same uids
+   * twice.
+   *
+   * \param [in] counter the lower 32 bits of the uid of the next packet
+   * created by the calling thread.
+   */
+  static void SetUidCounter (uint32_t counter);
+
   /**
    * \brief Returns number of bytes required for packet
    * serialization.
@@ -727,7 +763,7 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  static thread_local uint32_t m_globalUid; //!< Per-thread counter of packets Uid
 };
 
 /**
@@ -582,6 +582,33 @@ PacketTest::DoRun (void)
     tmp->AddPaddingAtEnd (50);
     CHECK (tmp, 1, E (25, 0, 50));
   }
+
+  /* Test CreateFullCopy: the copy has the same content, and sharing
+   * no data with the original, is modified independently.
+   */
+  {
+    Ptr<Packet> tmp = Create<Packet> (reinterpret_cast<const uint8_t*> ("hello"), 5);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<25> ());
+    tmp->AddPacketTag (ATestTag<3> (7));
+    Ptr<Packet> full = tmp->CreateFullCopy ();
+    NS_TEST_EXPECT_MSG_EQ (full->GetUid (), tmp->GetUid (), "Uid not copied");
+    CHECK (full, 1, E (25, 0, 15));
+    ATestTag<3> tag;
+    NS_TEST_EXPECT_MSG_EQ (full->RemovePacketTag (tag), true, "Packet tag not copied");
+    NS_TEST_EXPECT_MSG_EQ (tag.GetData (), 7, "Packet tag data not copied");
+    ATestHeader<10> h;
+    full->RemoveHeader (h);
+    NS_TEST_EXPECT_MSG_EQ (h.m_error, false, "Header not copied");
+    uint8_t buf[5];
+    full->CopyData (buf, 5);
+    NS_TEST_EXPECT_MSG_EQ (std::string (reinterpret_cast<const char *> (buf), 5), "hello", "Payload not copied");
+    full->AddByteTag (ATestTag<26> ());
+
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 15, "Original modified");
+    CHECK (tmp, 1, E (25, 0, 15));
+    NS_TEST_EXPECT_MSG_EQ (tmp->PeekPacketTag (tag), true, "Original packet tag removed");
+  }
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
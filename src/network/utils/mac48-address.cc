@@ -291,5 +291,17 @@ std::istream& operator>> (std::istream& is, Mac48Address & address)
   return is;
 }
 
+size_t
+Mac48AddressHash::operator() (Mac48Address const &x) const
+{
+  uint8_t buffer[6];
+  x.CopyTo (buffer);
+  uint64_t value = 0;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      value = (value << 8) | buffer[i];
+    }
+  return static_cast<size_t> (value);
+}
 
 } // namespace ns3
@@ -134,13 +134,13 @@ PointToPointChannel::GetDelay (void) const
   return m_delay;
 }
 
-Ptr<PointToPointNetDevice>
+const Ptr<PointToPointNetDevice> &
 PointToPointChannel::GetSource (uint32_t i) const
 {
   return m_link[i].m_src;
 }
 
-Ptr<PointToPointNetDevice>
+const Ptr<PointToPointNetDevice> &
 PointToPointChannel::GetDestination (uint32_t i) const
 {
   return m_link[i].m_dst;
@@ -69,7 +69,7 @@ public:
    * \brief Attach a given netdevice to this channel
    * \param device pointer to the netdevice to attach to the channel
    */
-  void Attach (Ptr<PointToPointNetDevice> device);
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
 
   /**
    * \brief Transmit a packet over this channel
@@ -101,6 +101,9 @@ public:
   virtual Ptr<NetDevice> GetDevice (uint32_t i) const;
 
 protected:
+  /** Each point to point link has exactly two net devices. */
+  static const int N_DEVICES = 2;
+
   /**
    * \brief Get the delay associated with this channel
    * \returns Time delay
@@ -119,7 +122,7 @@ protected:
    * \returns Ptr to PointToPointNetDevice source for the 
    * specified link
    */
-  Ptr<PointToPointNetDevice> GetSource (uint32_t i) const;
+  const Ptr<PointToPointNetDevice> &GetSource (uint32_t i) const;
 
   /**
    * \brief Get the net-device destination
@@ -127,7 +130,7 @@ protected:
    * \returns Ptr to PointToPointNetDevice destination for 
    * the specified link
    */
-  Ptr<PointToPointNetDevice> GetDestination (uint32_t i) const;
+  const Ptr<PointToPointNetDevice> &GetDestination (uint32_t i) const;
 
   /**
    * TracedCallback signature for packet transmission animation events.
@@ -146,9 +149,6 @@ protected:
      Time duration, Time lastBitTime);
                     
 private:
-  /** Each point to point link has exactly two net devices. */
-  static const int N_DEVICES = 2;
-
   Time          m_delay;    //!< Propagation delay
   int32_t       m_nDevices; //!< Devices of this channel
 
@@ -53,6 +53,21 @@ PointToPointRemoteChannel::~PointToPointRemoteChannel ()
 {
 }
 
+void
+PointToPointRemoteChannel::Attach (Ptr<PointToPointNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  PointToPointChannel::Attach (device);
+  if (GetNDevices () == static_cast<uint32_t> (N_DEVICES))
+    {
+      for (int i = 0; i < N_DEVICES; ++i)
+        {
+          m_dstNode[i] = GetDestination (i)->GetNode ()->GetId ();
+          m_dstIfIndex[i] = GetDestination (i)->GetIfIndex ();
+        }
+    }
+}
+
 bool
 PointToPointRemoteChannel::TransmitStart (
   Ptr<Packet> p,
@@ -65,15 +80,11 @@ PointToPointRemoteChannel::TransmitStart (
   IsInitialized ();
 
   uint32_t wire = src == GetSource (0) ? 0 : 1;
-  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
 
-#ifdef NS3_MPI
-  // Calculate the rxTime (absolute)
+  // Calculate the rxTime (absolute).  The interfaces which need MPI
+  // fail when it is not compiled in; the SharedMemoryInterface does not.
   Time rxTime = Simulator::Now () + txTime + GetDelay ();
-  MpiInterface::SendPacket (p, rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  MpiInterface::SendPacket (p, rxTime, m_dstNode[wire], m_dstIfIndex[wire]);
   return true;
 }
 
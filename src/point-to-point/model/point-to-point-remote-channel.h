@@ -68,6 +68,21 @@ public:
    */
   virtual bool TransmitStart (Ptr<Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Attach a given netdevice to this channel
+   *
+   * Once both devices are attached, record the node id and interface
+   * index of the destination of each link: the partition running a
+   * transmission must not use the objects of the remote node.
+   *
+   * \param device pointer to the netdevice to attach to the channel
+   */
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
+
+private:
+  uint32_t m_dstNode[N_DEVICES];    //!< Destination node id of each link
+  uint32_t m_dstIfIndex[N_DEVICES]; //!< Destination interface of each link
 };
 
 } // namespace ns3
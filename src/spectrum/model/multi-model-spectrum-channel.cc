@@ -27,6 +27,7 @@
 #include <ns3/node.h>
 #include <ns3/double.h>
 #include <ns3/mobility-model.h>
+#include <ns3/spatial-index.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-converter.h>
 #include <ns3/spectrum-propagation-loss-model.h>
@@ -82,6 +83,9 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_numDevices (0),
+    m_index (0),
+    m_nPrunedReceivers (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -95,6 +99,11 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  delete m_index;
+  m_index = 0;
+  m_indexedPhys.clear ();
+  m_unindexedPhys.clear ();
+  m_receiverPhys.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -119,6 +128,21 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "If strictly positive, the maximum distance in meters at which "
+                   "transmissions are passed to the receiving PHYs.  Receivers "
+                   "farther than this are found with a spatial index and skipped "
+                   "without evaluating the antenna and propagation models, which "
+                   "reduces the computational load of scenarios with many "
+                   "receivers spread over a large area.  Unlike MaxLossDb, this "
+                   "also applies when the loss is computed by a "
+                   "SpectrumPropagationLossModel.  It should be set to a distance "
+                   "beyond which the received signals are far below the "
+                   "sensitivity of the receivers.  By default, all the receivers "
+                   "are considered.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -134,6 +158,12 @@ MultiModelSpectrumChannel::GetTypeId (void)
                      "reported in this trace. ",
                      MakeTraceSourceAccessor (&MultiModelSpectrumChannel::m_pathLossTrace),
                      "ns3::SpectrumChannel::LossTracedCallback")
+    .AddTraceSource ("TxSigParams",
+                     "This trace is fired whenever a signal starts being "
+                     "transmitted on the channel, with the parameters of "
+                     "the signal, before any loss is applied.",
+                     MakeTraceSourceAccessor (&MultiModelSpectrumChannel::m_txSigParamsTrace),
+                     "ns3::SpectrumChannel::SignalParametersTracedCallback")
   ;
   return tid;
 }
@@ -152,6 +182,7 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
   SpectrumModelUid_t rxSpectrumModelUid = rxSpectrumModel->GetUid ();
 
   std::vector<Ptr<SpectrumPhy> >::const_iterator it;
+  bool known = false;
 
   // remove a previous entry of this phy if it exists
   // we need to scan for all rxSpectrumModel values since we don't
@@ -166,9 +197,15 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
         {
           rxInfoIterator->second.m_rxPhySet.erase (phyIt);
           --m_numDevices;
+          known = true;
           break; // there should be at most one entry
         }       
     }
+  if (!known)
+    {
+      // the phy is added to the spatial index once its position is known
+      m_unindexedPhys.push_back (phy);
+    }
 
   ++m_numDevices;
 
@@ -258,7 +295,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
   NS_ASSERT (txParams->txPhy);
   NS_ASSERT (txParams->psd);
-
+  m_txSigParamsTrace (txParams);
 
   Ptr<MobilityModel> txMobility = txParams->txPhy->GetMobility ();
   SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
@@ -272,6 +309,12 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  if (m_maxRange > 0 && txMobility)
+    {
+      StartTxInRange (txParams, txMobility, txInfoIteratorerator);
+      return;
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -279,20 +322,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
-      Ptr <SpectrumValue> convertedTxPowerSpectrum;
-      if (txSpectrumModelUid == rxSpectrumModelUid)
-        {
-          NS_LOG_LOGIC ("no spectrum conversion needed");
-          convertedTxPowerSpectrum = txParams->psd;
-        }
-      else
-        {
-          NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
-          SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIteratorerator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
-          NS_ASSERT (rxConverterIterator != txInfoIteratorerator->second.m_spectrumConverterMap.end ());
-          convertedTxPowerSpectrum = rxConverterIterator->second.Convert (txParams->psd);
-        }
-
+      Ptr <SpectrumValue> convertedTxPowerSpectrum = ConvertTxPowerSpectrum (txParams, txInfoIteratorerator, rxSpectrumModelUid);
 
       for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
            rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
@@ -303,72 +333,7 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
           if ((*rxPhyIterator) != txParams->txPhy)
             {
-              NS_LOG_LOGIC (" copying signal parameters " << txParams);
-              Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
-              rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
-              Time delay = MicroSeconds (0);
-
-              Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
-
-              if (txMobility && receiverMobility)
-                {
-                  double pathLossDb = 0;
-                  if (rxParams->txAntenna != 0)
-                    {
-                      Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
-                      double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
-                      NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
-                      pathLossDb -= txAntennaGain;
-                    }
-                  Ptr<AntennaModel> rxAntenna = (*rxPhyIterator)->GetRxAntenna ();
-                  if (rxAntenna != 0)
-                    {
-                      Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
-                      double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
-                      NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
-                      pathLossDb -= rxAntennaGain;
-                    }
-                  if (m_propagationLoss)
-                    {
-                      double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
-                      NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
-                      pathLossDb -= propagationGainDb;
-                    }                    
-                  NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
-                  m_pathLossTrace (txParams->txPhy, *rxPhyIterator, pathLossDb);
-                  if ( pathLossDb > m_maxLossDb)
-                    {
-                      // beyond range
-                      continue;
-                    }
-                  double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-                  *(rxParams->psd) *= pathGainLinear;              
-
-                  if (m_spectrumPropagationLoss)
-                    {
-                      rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
-                    }
-
-                  if (m_propagationDelay)
-                    {
-                      delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
-                    }
-                }
-
-              Ptr<NetDevice> netDev = (*rxPhyIterator)->GetDevice ();
-              if (netDev)
-                {
-                  // the receiver has a NetDevice, so we expect that it is attached to a Node
-                  uint32_t dstNode =  netDev->GetNode ()->GetId ();
-                  Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
-                                                  rxParams, *rxPhyIterator);
-                }
-              else
-                {
-                  // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
-                  Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
-                                       rxParams, *rxPhyIterator);
-                }
+              StartTxToReceiver (txParams, txMobility, convertedTxPowerSpectrum, *rxPhyIterator);
             }
         }
 
@@ -376,6 +341,153 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
 
 }
 
+void
+MultiModelSpectrumChannel::StartTxInRange (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                           TxSpectrumModelInfoMap_t::const_iterator txInfoIterator)
+{
+  NS_LOG_FUNCTION (this << txParams);
+
+  if (m_index == 0)
+    {
+      m_index = new SpatialIndex (m_maxRange);
+    }
+  // index the receivers whose position is known
+  for (std::vector<Ptr<SpectrumPhy> >::iterator it = m_unindexedPhys.begin (); it != m_unindexedPhys.end (); )
+    {
+      Ptr<MobilityModel> mobility = (*it)->GetMobility ();
+      if (mobility)
+        {
+          m_index->Add (mobility);
+          m_indexedPhys.push_back (*it);
+          it = m_unindexedPhys.erase (it);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+
+  m_index->GetObjectsInRange (txMobility->GetPosition (), m_maxRange, m_receivers);
+  m_receiverPhys.clear ();
+  for (std::vector<uint32_t>::const_iterator i = m_receivers.begin (); i != m_receivers.end (); ++i)
+    {
+      Ptr<SpectrumPhy> receiver = m_indexedPhys[*i];
+      if (txMobility->GetDistanceFrom (receiver->GetMobility ()) <= m_maxRange)
+        {
+          m_receiverPhys.push_back (receiver);
+        }
+    }
+  m_nPrunedReceivers += m_indexedPhys.size () - m_receiverPhys.size ();
+  // the receivers without a position cannot be out of range
+  m_receiverPhys.insert (m_receiverPhys.end (), m_unindexedPhys.begin (), m_unindexedPhys.end ());
+
+  std::map<SpectrumModelUid_t, Ptr <SpectrumValue> > convertedTxPowerSpectra;
+  for (std::vector<Ptr<SpectrumPhy> >::const_iterator i = m_receiverPhys.begin (); i != m_receiverPhys.end (); ++i)
+    {
+      if ((*i) == txParams->txPhy)
+        {
+          continue;
+        }
+      SpectrumModelUid_t rxSpectrumModelUid = (*i)->GetRxSpectrumModel ()->GetUid ();
+      Ptr <SpectrumValue> &convertedTxPowerSpectrum = convertedTxPowerSpectra[rxSpectrumModelUid];
+      if (convertedTxPowerSpectrum == 0)
+        {
+          convertedTxPowerSpectrum = ConvertTxPowerSpectrum (txParams, txInfoIterator, rxSpectrumModelUid);
+        }
+      StartTxToReceiver (txParams, txMobility, convertedTxPowerSpectrum, *i);
+    }
+}
+
+Ptr<SpectrumValue>
+MultiModelSpectrumChannel::ConvertTxPowerSpectrum (Ptr<SpectrumSignalParameters> txParams,
+                                                   TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+                                                   SpectrumModelUid_t rxSpectrumModelUid) const
+{
+  SpectrumModelUid_t txSpectrumModelUid = txParams->psd->GetSpectrumModelUid ();
+  if (txSpectrumModelUid == rxSpectrumModelUid)
+    {
+      NS_LOG_LOGIC ("no spectrum conversion needed");
+      return txParams->psd;
+    }
+  NS_LOG_LOGIC (" converting txPowerSpectrum SpectrumModelUids" << txSpectrumModelUid << " --> " << rxSpectrumModelUid);
+  SpectrumConverterMap_t::const_iterator rxConverterIterator = txInfoIterator->second.m_spectrumConverterMap.find (rxSpectrumModelUid);
+  NS_ASSERT_MSG (rxConverterIterator != txInfoIterator->second.m_spectrumConverterMap.end (),
+                 "SpectrumModel change was not notified to MultiModelSpectrumChannel (i.e., AddRx should be called again after model is changed)");
+  return rxConverterIterator->second.Convert (txParams->psd);
+}
+
+void
+MultiModelSpectrumChannel::StartTxToReceiver (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                                              Ptr<const SpectrumValue> convertedTxPowerSpectrum, Ptr<SpectrumPhy> receiver)
+{
+  NS_LOG_LOGIC (" copying signal parameters " << txParams);
+  Ptr<SpectrumSignalParameters> rxParams = txParams->Copy ();
+  rxParams->psd = Copy<SpectrumValue> (convertedTxPowerSpectrum);
+  Time delay = MicroSeconds (0);
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+
+  if (txMobility && receiverMobility)
+    {
+      double pathLossDb = 0;
+      if (rxParams->txAntenna != 0)
+        {
+          Angles txAngles (receiverMobility->GetPosition (), txMobility->GetPosition ());
+          double txAntennaGain = rxParams->txAntenna->GetGainDb (txAngles);
+          NS_LOG_LOGIC ("txAntennaGain = " << txAntennaGain << " dB");
+          pathLossDb -= txAntennaGain;
+        }
+      Ptr<AntennaModel> rxAntenna = receiver->GetRxAntenna ();
+      if (rxAntenna != 0)
+        {
+          Angles rxAngles (txMobility->GetPosition (), receiverMobility->GetPosition ());
+          double rxAntennaGain = rxAntenna->GetGainDb (rxAngles);
+          NS_LOG_LOGIC ("rxAntennaGain = " << rxAntennaGain << " dB");
+          pathLossDb -= rxAntennaGain;
+        }
+      if (m_propagationLoss)
+        {
+          double propagationGainDb = m_propagationLoss->CalcRxPower (0, txMobility, receiverMobility);
+          NS_LOG_LOGIC ("propagationGainDb = " << propagationGainDb << " dB");
+          pathLossDb -= propagationGainDb;
+        }                    
+      NS_LOG_LOGIC ("total pathLoss = " << pathLossDb << " dB");    
+      m_pathLossTrace (txParams->txPhy, receiver, pathLossDb);
+      if ( pathLossDb > m_maxLossDb)
+        {
+          // beyond range
+          return;
+        }
+      double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
+      *(rxParams->psd) *= pathGainLinear;              
+
+      if (m_spectrumPropagationLoss)
+        {
+          rxParams->psd = m_spectrumPropagationLoss->CalcRxPowerSpectralDensity (rxParams->psd, txMobility, receiverMobility);
+        }
+
+      if (m_propagationDelay)
+        {
+          delay = m_propagationDelay->GetDelay (txMobility, receiverMobility);
+        }
+    }
+
+  Ptr<NetDevice> netDev = receiver->GetDevice ();
+  if (netDev)
+    {
+      // the receiver has a NetDevice, so we expect that it is attached to a Node
+      uint32_t dstNode =  netDev->GetNode ()->GetId ();
+      Simulator::ScheduleWithContext (dstNode, delay, &MultiModelSpectrumChannel::StartRx, this,
+                                      rxParams, receiver);
+    }
+  else
+    {
+      // the receiver is not attached to a NetDevice, so we cannot assume that it is attached to a node
+      Simulator::Schedule (delay, &MultiModelSpectrumChannel::StartRx, this,
+                           rxParams, receiver);
+    }
+}
+
 void
 MultiModelSpectrumChannel::StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver)
 {
@@ -393,6 +505,13 @@ MultiModelSpectrumChannel::GetNDevices (void) const
 }
 
 
+uint64_t
+MultiModelSpectrumChannel::GetNPrunedReceivers (void) const
+{
+  return m_nPrunedReceivers;
+}
+
+
 Ptr<NetDevice>
 MultiModelSpectrumChannel::GetDevice (uint32_t i) const
 {
@@ -449,6 +568,24 @@ MultiModelSpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel>
   m_propagationDelay = delay;
 }
 
+Ptr<PropagationLossModel>
+MultiModelSpectrumChannel::GetPropagationLossModel (void) const
+{
+  return m_propagationLoss;
+}
+
+Ptr<SpectrumPropagationLossModel>
+MultiModelSpectrumChannel::GetSpectrumPropagationLossModel (void) const
+{
+  return m_spectrumPropagationLoss;
+}
+
+Ptr<PropagationDelayModel>
+MultiModelSpectrumChannel::GetPropagationDelayModel (void) const
+{
+  return m_propagationDelay;
+}
+
 Ptr<SpectrumPropagationLossModel>
 MultiModelSpectrumChannel::GetSpectrumPropagationLossModel (void)
 {
@@ -28,10 +28,14 @@
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
 #include <map>
+#include <vector>
 #include <set>
 
 namespace ns3 {
 
+class MobilityModel;
+class SpatialIndex;
+
 
 /**
  * \ingroup spectrum
@@ -119,6 +123,9 @@ public:
   virtual void AddPropagationLossModel (Ptr<PropagationLossModel> loss);
   virtual void AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossModel> loss);
   virtual void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay);
+  virtual Ptr<PropagationLossModel> GetPropagationLossModel (void) const;
+  virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void) const;
+  virtual Ptr<PropagationDelayModel> GetPropagationDelayModel (void) const;
   virtual void AddRx (Ptr<SpectrumPhy> phy);
   virtual void StartTx (Ptr<SpectrumSignalParameters> params);
 
@@ -133,6 +140,13 @@ public:
    */
   virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void);
 
+  /**
+   * Get the number of receivers skipped by the transmissions because
+   * they were farther than the MaxRange attribute.
+   * \returns the number of receivers pruned.
+   */
+  uint64_t GetNPrunedReceivers (void) const;
+
 
 protected:
   void DoDispose ();
@@ -158,6 +172,43 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /**
+   * Used internally to start a transmission towards the receivers
+   * found within MaxRange by the spatial index.
+   *
+   * @param txParams The signal paramters.
+   * @param txMobility The mobility model of the transmitter.
+   * @param txInfoIterator The entry of the TX SpectrumModel in m_txSpectrumModelInfoMap.
+   */
+  void StartTxInRange (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                       TxSpectrumModelInfoMap_t::const_iterator txInfoIterator);
+
+  /**
+   * Used internally to convert the power spectral density of a
+   * transmission to the SpectrumModel of a receiver.
+   *
+   * @param txParams The signal paramters.
+   * @param txInfoIterator The entry of the TX SpectrumModel in m_txSpectrumModelInfoMap.
+   * @param rxSpectrumModelUid The Uid of the RX SpectrumModel.
+   * @return The converted power spectral density.
+   */
+  Ptr<SpectrumValue> ConvertTxPowerSpectrum (Ptr<SpectrumSignalParameters> txParams,
+                                             TxSpectrumModelInfoMap_t::const_iterator txInfoIterator,
+                                             SpectrumModelUid_t rxSpectrumModelUid) const;
+
+  /**
+   * Used internally to apply the antenna and propagation models to a
+   * transmission and schedule its reception by one receiver.
+   *
+   * @param txParams The signal paramters.
+   * @param txMobility The mobility model of the transmitter.
+   * @param convertedTxPowerSpectrum The transmitted power spectral
+   * density, in the SpectrumModel of the receiver.
+   * @param receiver A pointer to the receiver SpectrumPhy.
+   */
+  void StartTxToReceiver (Ptr<SpectrumSignalParameters> txParams, Ptr<MobilityModel> txMobility,
+                          Ptr<const SpectrumValue> convertedTxPowerSpectrum, Ptr<SpectrumPhy> receiver);
+
   /**
    * Propagation delay model to be used with this channel.
    */
@@ -201,12 +252,55 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Maximum range [m], if strictly positive.
+   *
+   * Any device farther than this is considered out of range.
+   */
+  double m_maxRange;
+
+  /**
+   * Index of the positions of the receivers, built on first use.
+   */
+  SpatialIndex *m_index;
+
+  /**
+   * Receivers added to the spatial index, by index identifier.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_indexedPhys;
+
+  /**
+   * Receivers not added to the spatial index yet, because their
+   * position is not known.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_unindexedPhys;
+
+  /**
+   * Scratch storage of the receivers returned by the spatial index.
+   */
+  std::vector<uint32_t> m_receivers;
+
+  /**
+   * Scratch storage of the receivers within range of a transmission.
+   */
+  std::vector<Ptr<SpectrumPhy> > m_receiverPhys;
+
+  /**
+   * Number of receivers skipped because they were out of range.
+   */
+  uint64_t m_nPrunedReceivers;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
    * in a future release.
    */
   TracedCallback<Ptr<SpectrumPhy>, Ptr<SpectrumPhy>, double > m_pathLossTrace;
+
+  /**
+   * Traces the signals transmitted.
+   */
+  TracedCallback<Ptr<SpectrumSignalParameters> > m_txSigParamsTrace;
 };
 
 
@@ -97,6 +97,12 @@ SingleModelSpectrumChannel::GetTypeId (void)
                      "loss value reported in this trace. ",
                      MakeTraceSourceAccessor (&SingleModelSpectrumChannel::m_pathLossTrace),
                      "ns3::SpectrumChannel::LossTracedCallback")
+    .AddTraceSource ("TxSigParams",
+                     "This trace is fired whenever a signal starts being "
+                     "transmitted on the channel, with the parameters of "
+                     "the signal, before any loss is applied.",
+                     MakeTraceSourceAccessor (&SingleModelSpectrumChannel::m_txSigParamsTrace),
+                     "ns3::SpectrumChannel::SignalParametersTracedCallback")
   ;
   return tid;
 }
@@ -116,6 +122,7 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_FUNCTION (this << txParams->psd << txParams->duration << txParams->txPhy);
   NS_ASSERT_MSG (txParams->psd, "NULL txPsd");
   NS_ASSERT_MSG (txParams->txPhy, "NULL txPhy");
+  m_txSigParamsTrace (txParams);
 
   // just a sanity check routine. We might want to remove it to save some computational load -- one "if" statement  ;-)
   if (m_spectrumModel == 0)
@@ -260,6 +267,24 @@ SingleModelSpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel>
   m_propagationDelay = delay;
 }
 
+Ptr<PropagationLossModel>
+SingleModelSpectrumChannel::GetPropagationLossModel (void) const
+{
+  return m_propagationLoss;
+}
+
+Ptr<SpectrumPropagationLossModel>
+SingleModelSpectrumChannel::GetSpectrumPropagationLossModel (void) const
+{
+  return m_spectrumPropagationLoss;
+}
+
+Ptr<PropagationDelayModel>
+SingleModelSpectrumChannel::GetPropagationDelayModel (void) const
+{
+  return m_propagationDelay;
+}
+
 
 Ptr<SpectrumPropagationLossModel>
 SingleModelSpectrumChannel::GetSpectrumPropagationLossModel (void)
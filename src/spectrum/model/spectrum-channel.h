@@ -74,6 +74,21 @@ public:
    */
   virtual void SetPropagationDelayModel (Ptr<PropagationDelayModel> delay) = 0;
 
+  /**
+   * \return the single-frequency propagation loss model used, if any
+   */
+  virtual Ptr<PropagationLossModel> GetPropagationLossModel (void) const = 0;
+
+  /**
+   * \return the frequency-dependent propagation loss model used, if any
+   */
+  virtual Ptr<SpectrumPropagationLossModel> GetSpectrumPropagationLossModel (void) const = 0;
+
+  /**
+   * \return the propagation delay model used, if any
+   */
+  virtual Ptr<PropagationDelayModel> GetPropagationDelayModel (void) const = 0;
+
 
   /**
    * Used by attached PHY instances to transmit signals on the channel
@@ -112,6 +127,14 @@ public:
   typedef void (* LossTracedCallback)
     (Ptr<SpectrumPhy> txPhy, Ptr<SpectrumPhy> rxPhy,
      double lossDb);
+
+  /**
+   * TracedCallback signature for the transmissions started on the channel.
+   *
+   * \param [in] params The parameters of the signal transmitted.
+   */
+  typedef void (* SignalParametersTracedCallback)
+    (Ptr<SpectrumSignalParameters> params);
   
 };
 
@@ -23,10 +23,241 @@
 #include <ns3/math.h>
 #include <ns3/log.h>
 
+#if defined (__GNUC__) && defined (__x86_64__)
+/// Compile the SSE2 and AVX kernels, selected at run time.
+#define SPECTRUM_VALUE_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("SpectrumValue");
 
+/*
+ * Element-wise arithmetic kernels.
+ *
+ * Each kernel is generated by SPECTRUM_VALUE_KERNELS for the scalar
+ * case and, on x86-64 with GCC-compatible compilers, for SSE2 and AVX.
+ * The AVX kernels are compiled with a function-level target attribute,
+ * so that no compiler flag is needed, and they are only selected at
+ * run time when the processor supports them.  All the kernels round
+ * every operation like the scalar code, so that the results do not
+ * depend on the instruction set in use.
+ */
+
+/**
+ * \ingroup spectrum
+ * Table of the element-wise kernels for one instruction set.
+ */
+struct SpectrumValueKernels
+{
+  /** r = r + x */
+  void (*add)(double *r, const double *x, size_t n);
+  /** r = r - x */
+  void (*subtract)(double *r, const double *x, size_t n);
+  /** r = r * x */
+  void (*multiply)(double *r, const double *x, size_t n);
+  /** r = r / x */
+  void (*divide)(double *r, const double *x, size_t n);
+  /** r = r + s */
+  void (*addScalar)(double *r, double s, size_t n);
+  /** r = r * s */
+  void (*multiplyScalar)(double *r, double s, size_t n);
+  /** r = r / s */
+  void (*divideScalar)(double *r, double s, size_t n);
+  /** r = r + x * y */
+  void (*addProduct)(double *r, const double *x, const double *y, size_t n);
+  /** r = r + x * s */
+  void (*addProductScalar)(double *r, const double *x, double s, size_t n);
+  /** r = x - y */
+  void (*difference)(double *r, const double *x, const double *y, size_t n);
+  /** r = x / (y + z) */
+  void (*ratio)(double *r, const double *x, const double *y, const double *z, size_t n);
+};
+
+/**
+ * \ingroup spectrum
+ * Generate the kernels and the kernel table of one instruction set.
+ *
+ * \param ISA prefix of the kernel names
+ * \param TARGET function attributes of the kernels
+ * \param W number of doubles per vector
+ * \param VT vector type
+ * \param LD load a vector from an unaligned address
+ * \param ST store a vector to an unaligned address
+ * \param SET1 broadcast a double to a vector
+ * \param ADD vector addition
+ * \param SUB vector subtraction
+ * \param MUL vector multiplication
+ * \param DIV vector division
+ */
+#define SPECTRUM_VALUE_KERNELS(ISA, TARGET, W, VT, LD, ST, SET1, ADD, SUB, MUL, DIV) \
+  TARGET static void                                                    \
+  ISA ## Add (double *r, const double *x, size_t n)                     \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, ADD (LD (r + i), LD (x + i))); } \
+    for (; i < n; i++) { r[i] += x[i]; }                                \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## Subtract (double *r, const double *x, size_t n)                \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, SUB (LD (r + i), LD (x + i))); } \
+    for (; i < n; i++) { r[i] -= x[i]; }                                \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## Multiply (double *r, const double *x, size_t n)                \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, MUL (LD (r + i), LD (x + i))); } \
+    for (; i < n; i++) { r[i] *= x[i]; }                                \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## Divide (double *r, const double *x, size_t n)                  \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, DIV (LD (r + i), LD (x + i))); } \
+    for (; i < n; i++) { r[i] /= x[i]; }                                \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## AddScalar (double *r, double s, size_t n)                      \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    VT vs = SET1 (s);                                                   \
+    for (; i + W <= n; i += W) { ST (r + i, ADD (LD (r + i), vs)); }    \
+    for (; i < n; i++) { r[i] += s; }                                   \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## MultiplyScalar (double *r, double s, size_t n)                 \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    VT vs = SET1 (s);                                                   \
+    for (; i + W <= n; i += W) { ST (r + i, MUL (LD (r + i), vs)); }    \
+    for (; i < n; i++) { r[i] *= s; }                                   \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## DivideScalar (double *r, double s, size_t n)                   \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    VT vs = SET1 (s);                                                   \
+    for (; i + W <= n; i += W) { ST (r + i, DIV (LD (r + i), vs)); }    \
+    for (; i < n; i++) { r[i] /= s; }                                   \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## AddProduct (double *r, const double *x, const double *y, size_t n) \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, ADD (LD (r + i), MUL (LD (x + i), LD (y + i)))); } \
+    for (; i < n; i++) { r[i] += x[i] * y[i]; }                         \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## AddProductScalar (double *r, const double *x, double s, size_t n) \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    VT vs = SET1 (s);                                                   \
+    for (; i + W <= n; i += W) { ST (r + i, ADD (LD (r + i), MUL (LD (x + i), vs))); } \
+    for (; i < n; i++) { r[i] += x[i] * s; }                            \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## Difference (double *r, const double *x, const double *y, size_t n) \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, SUB (LD (x + i), LD (y + i))); } \
+    for (; i < n; i++) { r[i] = x[i] - y[i]; }                          \
+  }                                                                     \
+  TARGET static void                                                    \
+  ISA ## Ratio (double *r, const double *x, const double *y, const double *z, size_t n) \
+  {                                                                     \
+    size_t i = 0;                                                       \
+    for (; i + W <= n; i += W) { ST (r + i, DIV (LD (x + i), ADD (LD (y + i), LD (z + i)))); } \
+    for (; i < n; i++) { r[i] = x[i] / (y[i] + z[i]); }                 \
+  }                                                                     \
+  static const SpectrumValueKernels g_ ## ISA ## Kernels = {            \
+    ISA ## Add, ISA ## Subtract, ISA ## Multiply, ISA ## Divide,        \
+    ISA ## AddScalar, ISA ## MultiplyScalar, ISA ## DivideScalar,       \
+    ISA ## AddProduct, ISA ## AddProductScalar,                         \
+    ISA ## Difference, ISA ## Ratio                                     \
+  };
+
+#define SV_SCALAR_LD(p) (*(p))
+#define SV_SCALAR_ST(p, v) (*(p) = (v))
+#define SV_SCALAR_SET1(s) (s)
+#define SV_SCALAR_ADD(a, b) ((a) + (b))
+#define SV_SCALAR_SUB(a, b) ((a) - (b))
+#define SV_SCALAR_MUL(a, b) ((a) * (b))
+#define SV_SCALAR_DIV(a, b) ((a) / (b))
+
+SPECTRUM_VALUE_KERNELS (Scalar, , 1, double, SV_SCALAR_LD, SV_SCALAR_ST, SV_SCALAR_SET1,
+                        SV_SCALAR_ADD, SV_SCALAR_SUB, SV_SCALAR_MUL, SV_SCALAR_DIV)
+
+#ifdef SPECTRUM_VALUE_X86_SIMD
+SPECTRUM_VALUE_KERNELS (Sse2, , 2, __m128d, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+                        _mm_add_pd, _mm_sub_pd, _mm_mul_pd, _mm_div_pd)
+SPECTRUM_VALUE_KERNELS (Avx, __attribute__ ((target ("avx"))), 4, __m256d,
+                        _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                        _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd, _mm256_div_pd)
+#endif /* SPECTRUM_VALUE_X86_SIMD */
+
+/**
+ * \ingroup spectrum
+ * \param level the requested instruction set
+ * \returns the best instruction set supported, up to the requested one
+ */
+static SpectrumValue::SimdLevel
+GetSupportedSimdLevel (SpectrumValue::SimdLevel level)
+{
+#ifdef SPECTRUM_VALUE_X86_SIMD
+  __builtin_cpu_init ();
+  if (level >= SpectrumValue::SIMD_AVX && __builtin_cpu_supports ("avx"))
+    {
+      return SpectrumValue::SIMD_AVX;
+    }
+  if (level >= SpectrumValue::SIMD_SSE2)
+    {
+      return SpectrumValue::SIMD_SSE2;
+    }
+#endif /* SPECTRUM_VALUE_X86_SIMD */
+  return SpectrumValue::SIMD_NONE;
+}
+
+/** \ingroup spectrum The instruction set of the kernels in use. */
+static SpectrumValue::SimdLevel g_simdLevel = GetSupportedSimdLevel (SpectrumValue::SIMD_AVX);
+
+/**
+ * \ingroup spectrum
+ * \returns the kernels of the instruction set in use
+ */
+static const SpectrumValueKernels &
+GetKernels (void)
+{
+  switch (g_simdLevel)
+    {
+#ifdef SPECTRUM_VALUE_X86_SIMD
+    case SpectrumValue::SIMD_AVX:
+      return g_AvxKernels;
+    case SpectrumValue::SIMD_SSE2:
+      return g_Sse2Kernels;
+#endif /* SPECTRUM_VALUE_X86_SIMD */
+    default:
+      return g_ScalarKernels;
+    }
+}
+
+SpectrumValue::SimdLevel
+SpectrumValue::GetSimdLevel (void)
+{
+  return g_simdLevel;
+}
+
+SpectrumValue::SimdLevel
+SpectrumValue::SetSimdLevel (SimdLevel level)
+{
+  g_simdLevel = GetSupportedSimdLevel (level);
+  NS_LOG_INFO ("SpectrumValue kernels use SIMD level " << g_simdLevel);
+  return g_simdLevel;
+}
+
 SpectrumValue::SpectrumValue ()
 {
 }
@@ -106,31 +337,16 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  GetKernels ().add (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 += s;
-      ++it1;
-    }
+  GetKernels ().addScalar (m_values.data (), s, m_values.size ());
 }
 
 
@@ -138,18 +354,9 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  GetKernels ().subtract (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
@@ -164,31 +371,16 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  GetKernels ().multiply (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 *= s;
-      ++it1;
-    }
+  GetKernels ().multiplyScalar (m_values.data (), s, m_values.size ());
 }
 
 
@@ -197,18 +389,9 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
-
-  while (it1 != m_values.end ())
-    {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
-    }
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  GetKernels ().divide (m_values.data (), x.m_values.data (), m_values.size ());
 }
 
 
@@ -216,13 +399,51 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
+  GetKernels ().divideScalar (m_values.data (), s, m_values.size ());
+}
 
-  while (it1 != m_values.end ())
-    {
-      *it1 /= s;
-      ++it1;
-    }
+
+void
+SpectrumValue::AddProduct (const SpectrumValue& x, const SpectrumValue& y)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == y.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  NS_ASSERT (m_values.size () == y.m_values.size ());
+  GetKernels ().addProduct (m_values.data (), x.m_values.data (), y.m_values.data (), m_values.size ());
+}
+
+
+void
+SpectrumValue::AddProduct (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+  GetKernels ().addProductScalar (m_values.data (), x.m_values.data (), s, m_values.size ());
+}
+
+
+void
+SpectrumValue::AssignDifference (const SpectrumValue& x, const SpectrumValue& y)
+{
+  NS_ASSERT (x.m_spectrumModel == y.m_spectrumModel);
+  NS_ASSERT (x.m_values.size () == y.m_values.size ());
+  m_spectrumModel = x.m_spectrumModel;
+  m_values.resize (x.m_values.size ());
+  GetKernels ().difference (m_values.data (), x.m_values.data (), y.m_values.data (), m_values.size ());
+}
+
+
+void
+SpectrumValue::AssignRatio (const SpectrumValue& x, const SpectrumValue& y, const SpectrumValue& z)
+{
+  NS_ASSERT (x.m_spectrumModel == y.m_spectrumModel);
+  NS_ASSERT (x.m_spectrumModel == z.m_spectrumModel);
+  NS_ASSERT (x.m_values.size () == y.m_values.size ());
+  NS_ASSERT (x.m_values.size () == z.m_values.size ());
+  m_spectrumModel = x.m_spectrumModel;
+  m_values.resize (x.m_values.size ());
+  GetKernels ().ratio (m_values.data (), x.m_values.data (), y.m_values.data (), z.m_values.data (), m_values.size ());
 }
 
 
@@ -503,6 +503,72 @@ public:
    */
   Ptr<SpectrumValue> Copy () const;
 
+  /**
+   * Add the element-wise product of two SpectrumValues, in a single
+   * pass and without creating temporaries: this += x * y
+   *
+   * @param x first factor
+   * @param y second factor
+   */
+  void AddProduct (const SpectrumValue& x, const SpectrumValue& y);
+
+  /**
+   * Add the product of a SpectrumValue and a flat value, in a single
+   * pass and without creating temporaries: this += x * s
+   *
+   * @param x SpectrumValue factor
+   * @param s flat factor
+   */
+  void AddProduct (const SpectrumValue& x, double s);
+
+  /**
+   * Set this SpectrumValue to the element-wise difference of two
+   * other ones, reusing the storage of this instance: this = x - y
+   *
+   * @param x minuend
+   * @param y subtrahend
+   */
+  void AssignDifference (const SpectrumValue& x, const SpectrumValue& y);
+
+  /**
+   * Set this SpectrumValue to x / (y + z) in a single pass, reusing the
+   * storage of this instance.  This computes, for example, the SINR
+   * S / (I + N) of a signal S with interference I and noise N.
+   *
+   * @param x numerator
+   * @param y first term of the denominator
+   * @param z second term of the denominator
+   */
+  void AssignRatio (const SpectrumValue& x, const SpectrumValue& y, const SpectrumValue& z);
+
+  /**
+   * Instruction set extensions used by the element-wise arithmetic
+   * of all the SpectrumValues.
+   */
+  enum SimdLevel
+  {
+    SIMD_NONE = 0, //!< scalar code
+    SIMD_SSE2,     //!< SSE2 (x86-64 only)
+    SIMD_AVX       //!< AVX (x86-64 only)
+  };
+
+  /**
+   * @return the instruction set extensions in use
+   */
+  static SimdLevel GetSimdLevel (void);
+
+  /**
+   * Select the instruction set extensions used by the element-wise
+   * arithmetic.  By default, the best level supported by the processor
+   * is selected at run time.  The results do not depend on this
+   * setting, which is meant for testing and benchmarking.
+   *
+   * @param level the requested instruction set extensions
+   * @return the level in use, which is the best level supported by the
+   * processor and the build up to the requested one
+   */
+  static SimdLevel SetSimdLevel (SimdLevel level);
+
   /**
    *  TracedCallback signature for SpectrumValue.
    *
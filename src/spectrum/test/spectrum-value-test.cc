@@ -82,6 +82,110 @@ SpectrumValueTestCase::DoRun (void)
 
 
 
+/**
+ * Check that the element-wise kernels give the same results as
+ * scalar code with every supported instruction set, for sizes which
+ * exercise both the vector loops and the remainder loops.
+ */
+class SpectrumValueKernelsTestCase : public TestCase
+{
+public:
+  SpectrumValueKernelsTestCase ();
+  virtual ~SpectrumValueKernelsTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Check the kernels with one instruction set and one size.
+   * \param nBands the number of bands of the SpectrumModel
+   */
+  void CheckKernels (uint32_t nBands);
+};
+
+SpectrumValueKernelsTestCase::SpectrumValueKernelsTestCase ()
+  : TestCase ("SpectrumValue element-wise kernels")
+{
+}
+
+SpectrumValueKernelsTestCase::~SpectrumValueKernelsTestCase ()
+{
+}
+
+void
+SpectrumValueKernelsTestCase::CheckKernels (uint32_t nBands)
+{
+  std::vector<double> freqs;
+  for (uint32_t i = 0; i <= nBands; i++)
+    {
+      freqs.push_back (1e9 + i * 180e3);
+    }
+  Ptr<SpectrumModel> m = Create<SpectrumModel> (freqs);
+
+  SpectrumValue x (m), y (m), z (m);
+  for (uint32_t i = 0; i < nBands; i++)
+    {
+      x[i] = std::sin (i + 1.0) * 1e-13;
+      y[i] = 1e-14 / (i + 1.0);
+      z[i] = 4e-15 + i * 1e-17;
+    }
+  double s = 0.7071;
+
+  SpectrumValue sum = x + y;
+  SpectrumValue diff = x - y;
+  SpectrumValue prod = x * y;
+  SpectrumValue quot = x / y;
+  SpectrumValue sumS = x + s;
+  SpectrumValue prodS = x * s;
+  SpectrumValue quotS = x / s;
+  SpectrumValue addProduct = z;
+  addProduct.AddProduct (x, y);
+  SpectrumValue addProductS = z;
+  addProductS.AddProduct (x, s);
+  SpectrumValue difference;
+  difference.AssignDifference (x, y);
+  SpectrumValue ratio (m);
+  ratio.AssignRatio (x, y, z);
+
+  for (uint32_t i = 0; i < nBands; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sum[i], x[i] + y[i], "x + y, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (diff[i], x[i] - y[i], "x - y, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (prod[i], x[i] * y[i], "x * y, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (quot[i], x[i] / y[i], "x / y, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (sumS[i], x[i] + s, "x + s, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (prodS[i], x[i] * s, "x * s, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (quotS[i], x[i] / s, "x / s, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (addProduct[i], z[i] + x[i] * y[i], "z += x * y, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (addProductS[i], z[i] + x[i] * s, "z += x * s, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (difference[i], x[i] - y[i], "AssignDifference, band " << i << " of " << nBands);
+      NS_TEST_ASSERT_MSG_EQ (ratio[i], x[i] / (y[i] + z[i]), "AssignRatio, band " << i << " of " << nBands);
+    }
+  NS_TEST_ASSERT_MSG_EQ (difference.GetSpectrumModelUid (), m->GetUid (), "AssignDifference should set the SpectrumModel");
+}
+
+void
+SpectrumValueKernelsTestCase::DoRun (void)
+{
+  SpectrumValue::SimdLevel defaultLevel = SpectrumValue::GetSimdLevel ();
+  SpectrumValue::SimdLevel levels[] = { SpectrumValue::SIMD_NONE, SpectrumValue::SIMD_SSE2, SpectrumValue::SIMD_AVX };
+  for (uint32_t l = 0; l < sizeof (levels) / sizeof (levels[0]); l++)
+    {
+      if (SpectrumValue::SetSimdLevel (levels[l]) != levels[l])
+        {
+          // not supported by this processor or build
+          continue;
+        }
+      for (uint32_t nBands = 1; nBands <= 13; nBands++)
+        {
+          CheckKernels (nBands);
+        }
+      CheckKernels (100);
+    }
+  SpectrumValue::SetSimdLevel (defaultLevel);
+}
+
+
+
 class SpectrumValueTestSuite : public TestSuite
 {
 public:
@@ -241,6 +345,8 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   tv1rs3 = v1 >> 3;
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
+  AddTestCase (new SpectrumValueKernelsTestCase (), TestCase::QUICK);
+
 
 }
 
@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <map>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-phy-standard.h"
@@ -37,6 +38,14 @@ namespace ns3 {
 /**
  * \ingroup wifi
  * \brief handles interference calculations
+ *
+ * The changes of the noise and interference power are kept ordered by
+ * time, in a map, so that a signal is added in logarithmic time however
+ * many signals overlap.  The changes older than the start of the last
+ * signal received, or than the current time when no signal is received,
+ * are folded into the power at the start of the map, which is the sum of
+ * their deltas: the map only holds the changes which still matter to a
+ * reception or to the energy detection.
  */
 class InterferenceHelper
 {
@@ -264,6 +273,11 @@ private:
    * typedef for a vector of NiChanges
    */
   typedef std::vector <NiChange> NiChanges;
+  /**
+   * typedef for the NI power deltas, ordered by time.  The deltas of a
+   * time are in the order of their insertion.
+   */
+  typedef std::multimap <Time, double> NiChangeMap;
   /**
    * typedef for a list of Events
    */
@@ -331,13 +345,18 @@ private:
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
   /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
+  NiChangeMap m_niChanges;
   double m_firstPower;
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
   /**
-   * Add NiChange to the list at the appropriate position.
+   * Fold the changes earlier than the given time into m_firstPower.
+   *
+   * \param moment the time
+   * \param inclusive whether to fold the changes at the given time too
+   */
+  void FoldNiChanges (Time moment, bool inclusive);
+  /**
+   * Add NiChange to the map, after the changes of the same time.
    *
    * \param change
    */
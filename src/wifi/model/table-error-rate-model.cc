@@ -0,0 +1,234 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "table-error-rate-model.h"
+#include "nist-error-rate-model.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TableErrorRateModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TableErrorRateModel);
+
+/**
+ * The entry of a bit success rate of 1.  Its exponential is 0.
+ */
+static const double ERROR_FREE_ENTRY = -800;
+/**
+ * The entry of a bit success rate of 0.  The exponential of the opposite
+ * of its exponential is 0.
+ */
+static const double ERROR_ENTRY = std::log (800.0);
+
+TypeId
+TableErrorRateModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TableErrorRateModel")
+    .SetParent<ErrorRateModel> ()
+    .SetGroupName ("Wifi")
+    .AddConstructor<TableErrorRateModel> ()
+    .AddAttribute ("ErrorRateModel",
+                   "The error rate model tabulated.  If not set, a NistErrorRateModel is used.",
+                   PointerValue (),
+                   MakePointerAccessor (&TableErrorRateModel::SetErrorRateModel,
+                                        &TableErrorRateModel::GetErrorRateModel),
+                   MakePointerChecker<ErrorRateModel> ())
+    .AddAttribute ("MinSnr",
+                   "The SNR (dB) of the first entry of the tables.  "
+                   "The chunk success rates at lower SNRs are not tabulated.",
+                   DoubleValue (-10.0),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetMinSnr,
+                                       &TableErrorRateModel::GetMinSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxSnr",
+                   "The SNR (dB) of the last entry of the tables.  "
+                   "The chunk success rates at higher SNRs are not tabulated.",
+                   DoubleValue (100.0),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetMaxSnr,
+                                       &TableErrorRateModel::GetMaxSnr),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SnrResolution",
+                   "The SNR step (dB) between the entries of the tables.",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&TableErrorRateModel::SetSnrResolution,
+                                       &TableErrorRateModel::GetSnrResolution),
+                   MakeDoubleChecker<double> (1e-3))
+  ;
+  return tid;
+}
+
+TableErrorRateModel::TableErrorRateModel ()
+  : m_minSnrDb (-10.0),
+    m_maxSnrDb (100.0),
+    m_resolution (0.1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TableErrorRateModel::~TableErrorRateModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TableErrorRateModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_model = 0;
+  m_tables.clear ();
+  ErrorRateModel::DoDispose ();
+}
+
+void
+TableErrorRateModel::SetErrorRateModel (Ptr<ErrorRateModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+  m_model = model;
+  Invalidate ();
+}
+
+Ptr<ErrorRateModel>
+TableErrorRateModel::GetErrorRateModel (void) const
+{
+  return m_model;
+}
+
+void
+TableErrorRateModel::SetMinSnr (double snr)
+{
+  NS_LOG_FUNCTION (this << snr);
+  m_minSnrDb = snr;
+  Invalidate ();
+}
+
+double
+TableErrorRateModel::GetMinSnr (void) const
+{
+  return m_minSnrDb;
+}
+
+void
+TableErrorRateModel::SetMaxSnr (double snr)
+{
+  NS_LOG_FUNCTION (this << snr);
+  m_maxSnrDb = snr;
+  Invalidate ();
+}
+
+double
+TableErrorRateModel::GetMaxSnr (void) const
+{
+  return m_maxSnrDb;
+}
+
+void
+TableErrorRateModel::SetSnrResolution (double resolution)
+{
+  NS_LOG_FUNCTION (this << resolution);
+  m_resolution = resolution;
+  Invalidate ();
+}
+
+double
+TableErrorRateModel::GetSnrResolution (void) const
+{
+  return m_resolution;
+}
+
+void
+TableErrorRateModel::Invalidate (void)
+{
+  m_tables.clear ();
+}
+
+TableErrorRateModel::Table &
+TableErrorRateModel::GetTable (WifiMode mode, WifiTxVector txVector) const
+{
+  // the analytic models depend on the channel width, guard interval and
+  // number of streams through the PHY rate
+  uint64_t key = (static_cast<uint64_t> (mode.GetUid ()) << 32)
+    | (txVector.GetChannelWidth () << 16)
+    | (txVector.IsShortGuardInterval () << 8)
+    | txVector.GetNss ();
+  std::map<uint64_t, Table>::iterator i = m_tables.find (key);
+  if (i == m_tables.end ())
+    {
+      if (m_model == 0)
+        {
+          const_cast<TableErrorRateModel *> (this)->m_model = CreateObject<NistErrorRateModel> ();
+        }
+      uint32_t nEntries = 0;
+      if (m_maxSnrDb > m_minSnrDb)
+        {
+          nEntries = static_cast<uint32_t> ((m_maxSnrDb - m_minSnrDb) / m_resolution) + 1;
+        }
+      NS_LOG_DEBUG ("new table of " << nEntries << " entries for " << mode);
+      i = m_tables.insert (std::make_pair (key, Table ())).first;
+      i->second.values.resize (nEntries);
+      i->second.computed.resize (nEntries, false);
+    }
+  return i->second;
+}
+
+double
+TableErrorRateModel::GetEntry (Table &table, uint32_t i, WifiMode mode, WifiTxVector txVector) const
+{
+  if (!table.computed[i])
+    {
+      double snr = std::pow (10.0, (m_minSnrDb + i * m_resolution) / 10.0);
+      double bitSuccessRate = m_model->GetChunkSuccessRate (mode, txVector, snr, 1);
+      double entry;
+      if (bitSuccessRate >= 1.0)
+        {
+          entry = ERROR_FREE_ENTRY;
+        }
+      else if (bitSuccessRate <= 0.0)
+        {
+          entry = ERROR_ENTRY;
+        }
+      else
+        {
+          entry = std::max (std::log (-std::log (bitSuccessRate)), ERROR_FREE_ENTRY);
+        }
+      table.values[i] = entry;
+      table.computed[i] = true;
+    }
+  return table.values[i];
+}
+
+double
+TableErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint32_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
+  Table &table = GetTable (mode, txVector);
+  double position = (10.0 * std::log10 (snr) - m_minSnrDb) / m_resolution;
+  if (!(position >= 0.0 && position + 1 < table.values.size ()))
+    {
+      NS_LOG_LOGIC ("SNR out of the table");
+      return m_model->GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  uint32_t i = static_cast<uint32_t> (position);
+  double fraction = position - i;
+  double entry = (1 - fraction) * GetEntry (table, i, mode, txVector)
+    + fraction * GetEntry (table, i + 1, mode, txVector);
+  return std::exp (-std::exp (entry) * nbits);
+}
+
+} //namespace ns3
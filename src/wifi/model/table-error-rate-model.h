@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TABLE_ERROR_RATE_MODEL_H
+#define TABLE_ERROR_RATE_MODEL_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "error-rate-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ *
+ * An error rate model which tabulates the chunk success rates of another
+ * error rate model (by default, a NistErrorRateModel), to avoid
+ * evaluating its analytic expressions for every chunk of every frame.
+ *
+ * The analytic models compute the success rate of a chunk of n bits as
+ * the success rate of one bit to the power n.  For each mode and
+ * transmission vector, the table holds the logarithm of the success rate
+ * of one bit at SNRs spaced by the SnrResolution attribute, in dB, and is
+ * filled lazily, as the SNRs are met.  The success rate at other SNRs is
+ * interpolated between the two nearest entries, on a logarithmic scale,
+ * which follows the exponential decrease of the error rates with the SNR
+ * closely: with the default resolution of 0.1 dB, the chunk success rates
+ * differ from the analytic ones by less than 1e-3.  The SNRs out of
+ * [MinSnr, MaxSnr] are handed to the analytic model.
+ */
+class TableErrorRateModel : public ErrorRateModel
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TableErrorRateModel ();
+  virtual ~TableErrorRateModel ();
+
+  /**
+   * \param model the error rate model to tabulate
+   */
+  void SetErrorRateModel (Ptr<ErrorRateModel> model);
+  /**
+   * \return the error rate model tabulated
+   */
+  Ptr<ErrorRateModel> GetErrorRateModel (void) const;
+  /**
+   * \param snr the SNR of the first entry of the tables, in dB
+   */
+  void SetMinSnr (double snr);
+  /**
+   * \return the SNR of the first entry of the tables, in dB
+   */
+  double GetMinSnr (void) const;
+  /**
+   * \param snr the SNR of the last entry of the tables, in dB
+   */
+  void SetMaxSnr (double snr);
+  /**
+   * \return the SNR of the last entry of the tables, in dB
+   */
+  double GetMaxSnr (void) const;
+  /**
+   * \param resolution the SNR step between the entries of the tables, in dB
+   */
+  void SetSnrResolution (double resolution);
+  /**
+   * \return the SNR step between the entries of the tables, in dB
+   */
+  double GetSnrResolution (void) const;
+
+  virtual double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint32_t nbits) const;
+
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * The entries of a table: the logarithm of minus the logarithm of the
+   * success rate of one bit, and whether it has been computed yet
+   */
+  struct Table
+  {
+    std::vector<double> values;  //!< the entries
+    std::vector<bool> computed;  //!< whether each entry has been computed
+  };
+
+  /**
+   * \param mode the Wi-Fi mode
+   * \param txVector the transmission vector
+   * \return the table of the mode and transmission vector
+   */
+  Table & GetTable (WifiMode mode, WifiTxVector txVector) const;
+  /**
+   * \param table the table of the mode and transmission vector
+   * \param i the index of the entry
+   * \param mode the Wi-Fi mode
+   * \param txVector the transmission vector
+   * \return the entry, computed if needed
+   */
+  double GetEntry (Table &table, uint32_t i, WifiMode mode, WifiTxVector txVector) const;
+  /// Drop the tables, which depend on the attributes
+  void Invalidate (void);
+
+  Ptr<ErrorRateModel> m_model;  //!< the error rate model tabulated
+  double m_minSnrDb;            //!< the SNR of the first entry, in dB
+  double m_maxSnrDb;            //!< the SNR of the last entry, in dB
+  double m_resolution;          //!< the SNR step between entries, in dB
+  mutable std::map<uint64_t, Table> m_tables; //!< the tables, by mode and transmission vector
+};
+
+} //namespace ns3
+
+#endif /* TABLE_ERROR_RATE_MODEL_H */
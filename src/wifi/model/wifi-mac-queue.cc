@@ -33,10 +33,12 @@ NS_OBJECT_ENSURE_REGISTERED (WifiMacQueue);
 
 WifiMacQueue::Item::Item (Ptr<const Packet> packet,
                           const WifiMacHeader &hdr,
-                          Time tstamp)
+                          Time tstamp,
+                          int64_t order)
   : packet (packet),
     hdr (hdr),
-    tstamp (tstamp)
+    tstamp (tstamp),
+    order (order)
 {
 }
 
@@ -65,7 +67,9 @@ WifiMacQueue::GetTypeId (void)
 }
 
 WifiMacQueue::WifiMacQueue ()
-  : m_size (0)
+  : m_frontOrder (0),
+    m_backOrder (-1),
+    m_size (0)
 {
 }
 
@@ -110,38 +114,81 @@ WifiMacQueue::Enqueue (Ptr<const Packet> packet, const WifiMacHeader &hdr)
         }
       else if (m_dropPolicy == DROP_OLDEST)
         {
-          m_queue.pop_front ();
-          m_size--;
+          Erase (m_queue.begin ());
         }
     }
   Time now = Simulator::Now ();
-  m_queue.push_back (Item (packet, hdr, now));
+  m_queue.push_back (Item (packet, hdr, now, ++m_backOrder));
+  Index (--m_queue.end ());
   m_size++;
 }
 
 void
-WifiMacQueue::Cleanup (void)
+WifiMacQueue::Index (PacketQueueI it)
 {
-  if (m_queue.empty ())
+  if (it->hdr.IsQosData ())
     {
-      return;
+      m_subQueues[std::make_pair (it->hdr.GetQosTid (), it->hdr.GetAddr1 ())][it->order] = it;
     }
+  m_expiry[std::make_pair (it->tstamp, it->order)] = it;
+}
 
-  Time now = Simulator::Now ();
-  uint32_t n = 0;
-  for (PacketQueueI i = m_queue.begin (); i != m_queue.end (); )
+WifiMacQueue::PacketQueueI
+WifiMacQueue::Erase (PacketQueueI it)
+{
+  if (it->hdr.IsQosData ())
+    {
+      SubQueues::iterator subQueue = m_subQueues.find (std::make_pair (it->hdr.GetQosTid (), it->hdr.GetAddr1 ()));
+      NS_ASSERT (subQueue != m_subQueues.end ());
+      subQueue->second.erase (it->order);
+      if (subQueue->second.empty ())
+        {
+          m_subQueues.erase (subQueue);
+        }
+    }
+  m_expiry.erase (std::make_pair (it->tstamp, it->order));
+  m_size--;
+  return m_queue.erase (it);
+}
+
+WifiMacQueue::PacketQueueI
+WifiMacQueue::Find (uint8_t tid, WifiMacHeader::AddressType type, Mac48Address addr)
+{
+  if (type == WifiMacHeader::ADDR1)
     {
-      if (i->tstamp + m_maxDelay > now)
+      SubQueues::const_iterator subQueue = m_subQueues.find (std::make_pair (tid, addr));
+      if (subQueue == m_subQueues.end ())
         {
-          i++;
+          return m_queue.end ();
         }
-      else
+      return subQueue->second.begin ()->second;
+    }
+  for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); ++it)
+    {
+      if (it->hdr.IsQosData ()
+          && GetAddressForPacket (type, it) == addr
+          && it->hdr.GetQosTid () == tid)
         {
-          i = m_queue.erase (i);
-          n++;
+          return it;
         }
     }
-  m_size -= n;
+  return m_queue.end ();
+}
+
+void
+WifiMacQueue::Cleanup (void)
+{
+  if (m_queue.empty ())
+    {
+      return;
+    }
+
+  // The packets expire in the order of their timestamp
+  Time now = Simulator::Now ();
+  while (!m_expiry.empty () && m_expiry.begin ()->first.first + m_maxDelay <= now)
+    {
+      Erase (m_expiry.begin ()->second);
+    }
 }
 
 Ptr<const Packet>
@@ -151,8 +198,7 @@ WifiMacQueue::Dequeue (WifiMacHeader *hdr)
   if (!m_queue.empty ())
     {
       Item i = m_queue.front ();
-      m_queue.pop_front ();
-      m_size--;
+      Erase (m_queue.begin ());
       *hdr = i.hdr;
       return i.packet;
     }
@@ -178,24 +224,12 @@ WifiMacQueue::DequeueByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
 {
   Cleanup ();
   Ptr<const Packet> packet = 0;
-  if (!m_queue.empty ())
+  PacketQueueI it = Find (tid, type, dest);
+  if (it != m_queue.end ())
     {
-      PacketQueueI it;
-      for (it = m_queue.begin (); it != m_queue.end (); ++it)
-        {
-          if (it->hdr.IsQosData ())
-            {
-              if (GetAddressForPacket (type, it) == dest
-                  && it->hdr.GetQosTid () == tid)
-                {
-                  packet = it->packet;
-                  *hdr = it->hdr;
-                  m_queue.erase (it);
-                  m_size--;
-                  break;
-                }
-            }
-        }
+      packet = it->packet;
+      *hdr = it->hdr;
+      Erase (it);
     }
   return packet;
 }
@@ -205,22 +239,12 @@ WifiMacQueue::PeekByTidAndAddress (WifiMacHeader *hdr, uint8_t tid,
                                    WifiMacHeader::AddressType type, Mac48Address dest, Time *timestamp)
 {
   Cleanup ();
-  if (!m_queue.empty ())
+  PacketQueueI it = Find (tid, type, dest);
+  if (it != m_queue.end ())
     {
-      PacketQueueI it;
-      for (it = m_queue.begin (); it != m_queue.end (); ++it)
-        {
-          if (it->hdr.IsQosData ())
-            {
-              if (GetAddressForPacket (type, it) == dest
-                  && it->hdr.GetQosTid () == tid)
-                {
-                  *hdr = it->hdr;
-                  *timestamp = it->tstamp;
-                  return it->packet;
-                }
-            }
-        }
+      *hdr = it->hdr;
+      *timestamp = it->tstamp;
+      return it->packet;
     }
   return 0;
 }
@@ -243,6 +267,8 @@ void
 WifiMacQueue::Flush (void)
 {
   m_queue.erase (m_queue.begin (), m_queue.end ());
+  m_subQueues.clear ();
+  m_expiry.clear ();
   m_size = 0;
 }
 
@@ -272,8 +298,7 @@ WifiMacQueue::Remove (Ptr<const Packet> packet)
     {
       if (it->packet == packet)
         {
-          m_queue.erase (it);
-          m_size--;
+          Erase (it);
           return true;
         }
     }
@@ -289,7 +314,8 @@ WifiMacQueue::PushFront (Ptr<const Packet> packet, const WifiMacHeader &hdr)
       return;
     }
   Time now = Simulator::Now ();
-  m_queue.push_front (Item (packet, hdr, now));
+  m_queue.push_front (Item (packet, hdr, now, --m_frontOrder));
+  Index (m_queue.begin ());
   m_size++;
 }
 
@@ -298,18 +324,19 @@ WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, WifiMacHeader::AddressTyp
                                           Mac48Address addr)
 {
   Cleanup ();
+  if (type == WifiMacHeader::ADDR1)
+    {
+      SubQueues::const_iterator subQueue = m_subQueues.find (std::make_pair (tid, addr));
+      return subQueue == m_subQueues.end () ? 0 : subQueue->second.size ();
+    }
   uint32_t nPackets = 0;
-  if (!m_queue.empty ())
+  for (PacketQueueI it = m_queue.begin (); it != m_queue.end (); it++)
     {
-      PacketQueueI it;
-      for (it = m_queue.begin (); it != m_queue.end (); it++)
+      if (GetAddressForPacket (type, it) == addr)
         {
-          if (GetAddressForPacket (type, it) == addr)
+          if (it->hdr.IsQosData () && it->hdr.GetQosTid () == tid)
             {
-              if (it->hdr.IsQosData () && it->hdr.GetQosTid () == tid)
-                {
-                  nPackets++;
-                }
+              nPackets++;
             }
         }
     }
@@ -330,8 +357,7 @@ WifiMacQueue::DequeueFirstAvailable (WifiMacHeader *hdr, Time &timestamp,
           *hdr = it->hdr;
           timestamp = it->tstamp;
           packet = it->packet;
-          m_queue.erase (it);
-          m_size--;
+          Erase (it);
           return packet;
         }
     }
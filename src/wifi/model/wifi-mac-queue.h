@@ -24,6 +24,7 @@
 #define WIFI_MAC_QUEUE_H
 
 #include <list>
+#include <map>
 #include <utility>
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
@@ -47,6 +48,12 @@ class QosBlockedDestinations;
  * to verify whether or not it should be dropped. If
  * dot11EDCATableMSDULifetime has elapsed, it is dropped.
  * Otherwise, it is returned to the caller.
+ *
+ * Besides the FIFO list of all the packets, the queue keeps the QoS data
+ * packets of each TID and receiver (address 1) in their FIFO order, so
+ * that the packets of a block ack agreement are found without scanning
+ * the whole queue, and all the packets in the order of their timestamp,
+ * so that removing the expired packets only visits these packets.
  */
 class WifiMacQueue : public Object
 {
@@ -242,13 +249,16 @@ protected:
      * \param packet
      * \param hdr
      * \param tstamp
+     * \param order
      */
     Item (Ptr<const Packet> packet,
           const WifiMacHeader &hdr,
-          Time tstamp);
+          Time tstamp,
+          int64_t order);
     Ptr<const Packet> packet; //!< Actual packet
     WifiMacHeader hdr;        //!< Wifi MAC header associated with the packet
     Time tstamp;              //!< timestamp when the packet arrived at the queue
+    int64_t order;            //!< position of the packet in the queue, increasing from the front
   };
 
   /**
@@ -273,7 +283,43 @@ protected:
    */
   Mac48Address GetAddressForPacket (enum WifiMacHeader::AddressType type, PacketQueueI it);
 
+  /**
+   * The QoS data packets of a TID and receiver, indexed by their order
+   */
+  typedef std::map<int64_t, PacketQueueI> SubQueue;
+  /**
+   * The sub-queues, indexed by TID and receiver (address 1)
+   */
+  typedef std::map<std::pair<uint8_t, Mac48Address>, SubQueue> SubQueues;
+  /**
+   * The packets, indexed by their timestamp and order
+   */
+  typedef std::map<std::pair<Time, int64_t>, PacketQueueI> ExpiryIndex;
+
+  /**
+   * Add a packet newly inserted in the queue to the indexes.
+   * \param it the packet
+   */
+  void Index (PacketQueueI it);
+  /**
+   * Remove a packet from the queue and from the indexes.
+   * \param it the packet
+   * \return the packet following the removed one
+   */
+  PacketQueueI Erase (PacketQueueI it);
+  /**
+   * \param tid the given TID
+   * \param type the given address type
+   * \param addr the given destination
+   * \return the first QoS data packet with the given TID and address
+   */
+  PacketQueueI Find (uint8_t tid, WifiMacHeader::AddressType type, Mac48Address addr);
+
   PacketQueue m_queue; //!< Packet (struct Item) queue
+  SubQueues m_subQueues;     //!< QoS data packets by TID and receiver
+  ExpiryIndex m_expiry;      //!< Packets by timestamp
+  int64_t m_frontOrder;      //!< Order of the packet at the front of the queue
+  int64_t m_backOrder;       //!< Order of the packet at the back of the queue
   uint32_t m_size;     //!< Current queue size
   uint32_t m_maxSize;  //!< Queue capacity
   Time m_maxDelay;     //!< Time to live for packets in the queue
@@ -615,14 +615,13 @@ WifiPhy::SetMobility (Ptr<MobilityModel> mobility)
 Ptr<MobilityModel>
 WifiPhy::GetMobility (void)
 {
-  if (m_mobility != 0)
+  if (m_mobility == 0)
     {
-      return m_mobility;
-    }
-  else
-    {
-      return m_device->GetNode ()->GetObject<MobilityModel> ();
+      // cache the model aggregated to the node: the channels query it
+      // for every transmission
+      m_mobility = m_device->GetNode ()->GetObject<MobilityModel> ();
     }
+  return m_mobility;
 }
 
 void
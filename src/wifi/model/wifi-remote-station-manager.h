@@ -22,6 +22,7 @@
 #define WIFI_REMOTE_STATION_MANAGER_H
 
 #include <vector>
+#include <unordered_map>
 #include <utility>
 #include "ns3/mac48-address.h"
 #include "ns3/traced-callback.h"
@@ -1178,13 +1179,27 @@ private:
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
   /**
-   * A vector of WifiRemoteStations
+   * Hash function of the keys of the WifiRemoteStations: the address of
+   * the station and the TID.
    */
-  typedef std::vector <WifiRemoteStation *> Stations;
+  struct StationKeyHash
+  {
+    /**
+     * \param key the address of the station and the TID
+     * \return the hash of the key
+     */
+    size_t operator() (const std::pair<Mac48Address, uint8_t> &key) const;
+  };
+  /**
+   * The WifiRemoteStations, indexed by the address of the station and
+   * the TID.  The stations are allocated on the heap, so that the
+   * pointers held by the rate control algorithms stay valid.
+   */
+  typedef std::unordered_map <std::pair<Mac48Address, uint8_t>, WifiRemoteStation *, StationKeyHash> Stations;
   /**
-   * A vector of WifiRemoteStationStates
+   * The WifiRemoteStationStates, indexed by the address of the station
    */
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  typedef std::unordered_map <Mac48Address, WifiRemoteStationState *, Mac48AddressHash> StationStates;
 
   /**
    * This is a pointer to the WifiPhy associated with this
@@ -25,6 +25,8 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/spatial-index.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
@@ -51,17 +53,34 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxRange",
+                   "If strictly positive, the maximum distance in meters at which "
+                   "transmissions are delivered to the receiving PHYs. The receivers "
+                   "farther than this are found with a spatial index and skipped "
+                   "without evaluating the propagation models. This is meant to "
+                   "reduce the computational load of large scenarios: it should be "
+                   "set to a distance beyond which the propagation loss model yields "
+                   "a received power below the energy detection threshold of the "
+                   "receivers. By default, all the receivers are considered.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_nTransmissions (0),
+    m_index (0),
+    m_nPrunedReceivers (0)
 {
 }
 
 YansWifiChannel::~YansWifiChannel ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  delete m_index;
+  m_index = 0;
   m_phyList.clear ();
 }
 
@@ -81,52 +100,90 @@ void
 YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
                        WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype, Time duration) const
 {
-  Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  uint32_t j = 0;
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
+  m_nTransmissions++;
+
+  struct Parameters parameters;
+  parameters.type = mpdutype;
+  parameters.duration = duration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
+
+  if (m_maxRange > 0)
     {
-      if (sender != (*i))
+      if (m_index == 0)
         {
-          //For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          m_index = new SpatialIndex (m_maxRange);
+        }
+      while (m_index->GetN () < m_phyList.size ())
+        {
+          m_index->Add (m_phyList[m_index->GetN ()]->GetMobility ());
+        }
+      m_index->GetObjectsInRange (senderMobility->GetPosition (), m_maxRange, m_receivers);
+      uint32_t inRange = 0;
+      for (std::vector<uint32_t>::const_iterator i = m_receivers.begin (); i != m_receivers.end (); i++)
+        {
+          if (senderMobility->GetDistanceFrom (m_phyList[*i]->GetMobility ()) > m_maxRange)
             {
               continue;
             }
-
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+          inRange++;
+          if (sender != m_phyList[*i])
             {
-              dstNode = 0xffffffff;
+              Transmit (sender, senderMobility, *i, packet, txPowerDbm, parameters);
             }
-          else
+        }
+      // the sender itself is always in range
+      m_nPrunedReceivers += m_phyList.size () - inRange;
+    }
+  else
+    {
+      for (uint32_t j = 0; j < m_phyList.size (); j++)
+        {
+          if (sender != m_phyList[j])
             {
-              dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
+              Transmit (sender, senderMobility, j, packet, txPowerDbm, parameters);
             }
+        }
+    }
+}
 
-          struct Parameters parameters;
-          parameters.rxPowerDbm = rxPowerDbm;
-          parameters.type = mpdutype;
-          parameters.duration = duration;
-          parameters.txVector = txVector;
-          parameters.preamble = preamble;
+void
+YansWifiChannel::Transmit (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t j,
+                           Ptr<const Packet> packet, double txPowerDbm, struct Parameters parameters) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[j];
+  //For now don't account for inter channel interference
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive, this,
-                                          j, copy, parameters);
-        }
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ();
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<Object> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
     }
+
+  parameters.rxPowerDbm = rxPowerDbm;
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive, this,
+                                  j, packet, parameters);
 }
 
 void
-YansWifiChannel::Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const
+YansWifiChannel::Receive (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters) const
 {
   m_phyList[i]->StartReceivePreambleAndHeader (packet, parameters.rxPowerDbm, parameters.txVector, parameters.preamble, parameters.type, parameters.duration);
 }
@@ -149,6 +206,29 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
   m_phyList.push_back (phy);
 }
 
+uint64_t
+YansWifiChannel::GetNTransmissions (void) const
+{
+  return m_nTransmissions;
+}
+
+uint64_t
+YansWifiChannel::GetNPrunedReceivers (void) const
+{
+  return m_nPrunedReceivers;
+}
+
+uint64_t
+YansWifiChannel::GetRxPacketCopies (void) const
+{
+  uint64_t copies = 0;
+  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+    {
+      copies += (*i)->GetRxPacketCopies ();
+    }
+  return copies;
+}
+
 int64_t
 YansWifiChannel::AssignStreams (int64_t stream)
 {
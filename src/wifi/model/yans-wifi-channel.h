@@ -34,6 +34,8 @@
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
+class SpatialIndex;
 class PropagationLossModel;
 class PropagationDelayModel;
 
@@ -99,10 +101,31 @@ public:
    * currently invoked only from WifiPhy::Send. YansWifiChannel
    * delivers packets only between PHYs with the same m_channelNumber,
    * e.g. PHYs that are operating on the same channel.
+   *
+   * The packet is not copied: all the receivers share it until it is
+   * handed over to their MAC.
    */
   void Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double txPowerDbm,
              WifiTxVector txVector, WifiPreamble preamble, enum mpduType mpdutype, Time duration) const;
 
+  /**
+   * \return the number of transmissions sent on this channel
+   */
+  uint64_t GetNTransmissions (void) const;
+  /**
+   * Together with GetNTransmissions, this allows measuring the number
+   * of packet allocations per transmission.
+   *
+   * \return the number of received packets copied by the PHYs attached
+   *         to this channel
+   */
+  uint64_t GetRxPacketCopies (void) const;
+  /**
+   * \return the number of receivers skipped by transmissions because
+   *         they were farther than the MaxRange attribute
+   */
+  uint64_t GetNPrunedReceivers (void) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -132,11 +155,28 @@ private:
    * \param txVector the TXVECTOR of the packet
    * \param preamble the type of preamble being used to send the packet
    */
-  void Receive (uint32_t i, Ptr<Packet> packet, struct Parameters parameters) const;
+  void Receive (uint32_t i, Ptr<const Packet> packet, struct Parameters parameters) const;
+  /**
+   * Schedule the reception of a transmission by a YansWifiPhy.
+   *
+   * \param sender the device from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param j index of the receiving YansWifiPhy in the PHY list
+   * \param packet the packet being sent
+   * \param txPowerDbm the tx power associated to the packet
+   * \param parameters the parameters of the transmission, but the received power
+   */
+  void Transmit (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, uint32_t j,
+                 Ptr<const Packet> packet, double txPowerDbm, struct Parameters parameters) const;
 
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  mutable uint64_t m_nTransmissions;   //!< Number of transmissions sent on this channel
+  double m_maxRange;                   //!< Maximum range of the transmissions, if strictly positive
+  mutable SpatialIndex *m_index;       //!< Index of the positions of the PHYs, built on first use
+  mutable std::vector<uint32_t> m_receivers; //!< Receivers returned by the spatial index
+  mutable uint64_t m_nPrunedReceivers; //!< Number of receivers skipped because out of range
 };
 
 } //namespace ns3
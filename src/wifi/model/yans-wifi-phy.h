@@ -69,7 +69,7 @@ public:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::mpduType.
    * \param rxDuration the duration needed for the reception of the packet
    */
-  void StartReceivePreambleAndHeader (Ptr<Packet> packet,
+  void StartReceivePreambleAndHeader (Ptr<const Packet> packet,
                                       double rxPowerDbm,
                                       WifiTxVector txVector,
                                       WifiPreamble preamble,
@@ -84,12 +84,21 @@ public:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::mpduType.
    * \param event the corresponding event of the first time the packet arrives
    */
-  void StartReceivePacket (Ptr<Packet> packet,
+  void StartReceivePacket (Ptr<const Packet> packet,
                            WifiTxVector txVector,
                            WifiPreamble preamble,
                            enum mpduType mpdutype,
                            Ptr<InterferenceHelper::Event> event);
 
+  /**
+   * The packets received from the channel are shared by all the
+   * receivers of a transmission and are only copied when they are
+   * handed over to the MAC.
+   *
+   * \return the number of received packets copied by this PHY
+   */
+  uint64_t GetRxPacketCopies (void) const;
+
   virtual void SetReceiveOkCallback (WifiPhy::RxOkCallback callback);
   virtual void SetReceiveErrorCallback (WifiPhy::RxErrorCallback callback);
   virtual void SendPacket (Ptr<const Packet> packet, WifiTxVector txVector, enum WifiPreamble preamble);
@@ -115,9 +124,18 @@ private:
    * \param mpdutype the type of the MPDU as defined in WifiPhy::mpduType.
    * \param event the corresponding event of the first time the packet arrives
    */
-  void EndReceive (Ptr<Packet> packet, enum WifiPreamble preamble, enum mpduType mpdutype, Ptr<InterferenceHelper::Event> event);
+  void EndReceive (Ptr<const Packet> packet, enum WifiPreamble preamble, enum mpduType mpdutype, Ptr<InterferenceHelper::Event> event);
+  /**
+   * Make the private copy of a received packet handed over to the MAC,
+   * which is free to modify it.
+   *
+   * \param packet the packet shared by the receivers of a transmission
+   * \return a copy of the packet
+   */
+  Ptr<Packet> CopyReceivedPacket (Ptr<const Packet> packet);
 
   Ptr<YansWifiChannel> m_channel;        //!< YansWifiChannel that this YansWifiPhy is connected to
+  uint64_t m_rxPacketCopies;             //!< Number of received packets copied for the MAC
 };
 
 } //namespace ns3
@@ -19,10 +19,14 @@
  */
 
 #include <cmath>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/table-error-rate-model.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/pointer.h"
 
 using namespace ns3;
 
@@ -279,6 +283,78 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+class WifiErrorRateModelsTestCaseTable : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseTable ();
+  virtual ~WifiErrorRateModelsTestCaseTable ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check that a TableErrorRateModel is close to the model it tabulates
+   * \param model the model tabulated
+   * \param modes the modes to check
+   */
+  void Check (Ptr<ErrorRateModel> model, const std::vector<WifiMode> &modes);
+};
+
+WifiErrorRateModelsTestCaseTable::WifiErrorRateModelsTestCaseTable ()
+  : TestCase ("WifiErrorRateModel test case table")
+{
+}
+
+WifiErrorRateModelsTestCaseTable::~WifiErrorRateModelsTestCaseTable ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseTable::Check (Ptr<ErrorRateModel> model, const std::vector<WifiMode> &modes)
+{
+  Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+  table->SetAttribute ("ErrorRateModel", PointerValue (model));
+  WifiTxVector txVector;
+  txVector.SetChannelWidth (20);
+  txVector.SetNss (1);
+  uint32_t sizes[] = { 14, 64, 1500 };
+  for (std::vector<WifiMode>::const_iterator mode = modes.begin (); mode != modes.end (); ++mode)
+    {
+      txVector.SetMode (*mode);
+      // step through the SNRs between the entries of the table
+      for (double snr = -5.0; snr < 40.0; snr += 0.037)
+        {
+          double ratio = std::pow (10.0, snr / 10.0);
+          for (uint32_t i = 0; i < 3; i++)
+            {
+              double expected = model->GetChunkSuccessRate (*mode, txVector, ratio, sizes[i] * 8);
+              double ps = table->GetChunkSuccessRate (*mode, txVector, ratio, sizes[i] * 8);
+              NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, 1e-3, "Tabulated " << *mode << " too far at " << snr << " dB");
+            }
+        }
+    }
+}
+
+void
+WifiErrorRateModelsTestCaseTable::DoRun (void)
+{
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate2Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate5_5Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate9Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate12Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate18Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate36Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate48Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+  modes.push_back (WifiPhy::GetHtMcs7 ());
+  Check (CreateObject<NistErrorRateModel> (), modes);
+  Check (CreateObject<YansErrorRateModel> (), modes);
+}
+
 class WifiErrorRateModelsTestSuite : public TestSuite
 {
 public:
@@ -290,6 +366,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseTable, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite;
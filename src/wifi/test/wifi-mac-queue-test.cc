@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-queue.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * Check the packets returned by a WifiMacQueue for a TID and receiver,
+ * and the removal of the expired packets.
+ */
+class WifiMacQueueTestCase : public TestCase
+{
+public:
+  WifiMacQueueTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue a QoS data packet.
+   * \param tid the TID
+   * \param addr the receiver
+   * \param size the size of the packet, used to tell the packets apart
+   */
+  void Enqueue (uint8_t tid, Mac48Address addr, uint32_t size);
+  /// Check the queue once some of the packets expired
+  void CheckExpired (void);
+
+  Ptr<WifiMacQueue> m_queue; //!< the queue
+  Mac48Address m_a;          //!< a receiver
+  Mac48Address m_b;          //!< another receiver
+};
+
+WifiMacQueueTestCase::WifiMacQueueTestCase ()
+  : TestCase ("Check the packets returned by a WifiMacQueue")
+{
+}
+
+void
+WifiMacQueueTestCase::Enqueue (uint8_t tid, Mac48Address addr, uint32_t size)
+{
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetQosTid (tid);
+  hdr.SetAddr1 (addr);
+  m_queue->Enqueue (Create<Packet> (size), hdr);
+}
+
+void
+WifiMacQueueTestCase::CheckExpired (void)
+{
+  // the packets enqueued at the start expired, not the later ones
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 2, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, m_a), 0, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (2, WifiMacHeader::ADDR1, m_b), 1, "Wrong number of packets");
+  WifiMacHeader hdr;
+  Ptr<const Packet> packet = m_queue->Dequeue (&hdr);
+  NS_TEST_ASSERT_MSG_NE (packet, 0, "Packet expected");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 20, "The later packets should be kept in order");
+}
+
+void
+WifiMacQueueTestCase::DoRun (void)
+{
+  m_queue = CreateObject<WifiMacQueue> ();
+  m_queue->SetMaxDelay (MilliSeconds (100));
+  m_a = Mac48Address ("00:00:00:00:00:01");
+  m_b = Mac48Address ("00:00:00:00:00:02");
+
+  Enqueue (1, m_a, 1);
+  Enqueue (2, m_a, 2);
+  Enqueue (1, m_b, 3);
+  Enqueue (1, m_a, 4);
+  WifiMacHeader mgt;
+  mgt.SetType (WIFI_MAC_MGT_ACTION);
+  mgt.SetAddr1 (m_a);
+  m_queue->Enqueue (Create<Packet> (5), mgt);
+  Enqueue (1, m_a, 6);
+
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, m_a), 3, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (2, WifiMacHeader::ADDR1, m_b), 0, "Wrong number of packets");
+
+  WifiMacHeader hdr;
+  Time tstamp;
+  Ptr<const Packet> packet = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_a, &tstamp);
+  NS_TEST_ASSERT_MSG_NE (packet, 0, "Packet expected");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 1, "The first packet of the TID and receiver should be found");
+
+  // a packet pushed back at the front comes first for its TID and receiver
+  packet = m_queue->DequeueByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_a);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 1, "The first packet of the TID and receiver should be found");
+  packet = m_queue->DequeueByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_a);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 4, "The packets should be found in order");
+  m_queue->PushFront (packet, hdr);
+  packet = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR1, m_a, &tstamp);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 4, "The packet pushed at the front should come first");
+  packet = m_queue->Dequeue (&hdr);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 4, "The packet pushed at the front should come first");
+  packet = m_queue->Dequeue (&hdr);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 2, "The packets should be dequeued in order");
+
+  // the other address types are still supported
+  packet = m_queue->PeekByTidAndAddress (&hdr, 1, WifiMacHeader::ADDR2, Mac48Address (), &tstamp);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 3, "The first packet of the TID and transmitter should be found");
+
+  NS_TEST_EXPECT_MSG_EQ (m_queue->Remove (packet), true, "The packet should be removed");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (1, WifiMacHeader::ADDR1, m_b), 0, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetSize (), 2, "Wrong number of packets");
+
+  Simulator::Schedule (MilliSeconds (50), &WifiMacQueueTestCase::Enqueue, this, 2, m_b, 20);
+  Simulator::Schedule (MilliSeconds (60), &WifiMacQueueTestCase::Enqueue, this, 2, m_a, 21);
+  Simulator::Schedule (MilliSeconds (120), &WifiMacQueueTestCase::CheckExpired, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief WifiMacQueue TestSuite
+ */
+class WifiMacQueueTestSuite : public TestSuite
+{
+public:
+  WifiMacQueueTestSuite ();
+};
+
+WifiMacQueueTestSuite::WifiMacQueueTestSuite ()
+  : TestSuite ("wifi-mac-queue", UNIT)
+{
+  AddTestCase (new WifiMacQueueTestCase (), TestCase::QUICK);
+}
+
+static WifiMacQueueTestSuite g_wifiMacQueueTestSuite; //!< Static variable for test initialization
@@ -25,6 +25,7 @@
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/adhoc-wifi-mac.h"
+#include "ns3/constant-rate-wifi-manager.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
@@ -34,6 +35,7 @@
 #include "ns3/rng-seed-manager.h"
 #include "ns3/config.h"
 #include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/packet-socket-address.h"
 #include "ns3/packet-socket-server.h"
@@ -1090,6 +1092,115 @@ Bug2222TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countInternalCollisions, 1, "unexpected number of internal collisions!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that a broadcast transmission is not copied for every
+ * receiver on the channel: the receivers share the transmitted packet
+ * and only the ones handing it over to their MAC make a private copy,
+ * which the upper layers are free to modify.
+ *
+ * When a maximum range is set on the channel, also make sure that the
+ * receivers out of range are pruned and the others are not.
+ */
+class YansWifiChannelSharedPacketTest : public TestCase
+{
+public:
+  /**
+   * \param maxRange the MaxRange attribute of the channel
+   */
+  YansWifiChannelSharedPacketTest (double maxRange);
+
+  virtual void DoRun (void);
+
+
+private:
+  Ptr<WifiNetDevice> CreateOne (Vector pos, Ptr<YansWifiChannel> channel);
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  double m_maxRange;   //!< the MaxRange attribute of the channel
+  uint32_t m_received; //!< number of packets received by the upper layer
+};
+
+YansWifiChannelSharedPacketTest::YansWifiChannelSharedPacketTest (double maxRange)
+  : TestCase (maxRange > 0 ? "Receivers of a YansWifiChannel transmission share the packet, with range culling"
+              : "Receivers of a YansWifiChannel transmission share the packet until it reaches their MAC"),
+    m_maxRange (maxRange),
+    m_received (0)
+{
+}
+
+void
+YansWifiChannelSharedPacketTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+bool
+YansWifiChannelSharedPacketTest::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "The packet was modified by another receiver");
+  //modify the packet received, as an upper layer would
+  ConstCast<Packet> (p)->RemoveAtStart (50);
+  m_received++;
+  return true;
+}
+
+Ptr<WifiNetDevice>
+YansWifiChannelSharedPacketTest::CreateOne (Vector pos, Ptr<YansWifiChannel> channel)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<WifiNetDevice> dev = CreateObject<WifiNetDevice> ();
+
+  Ptr<WifiMac> mac = CreateObject<AdhocWifiMac> ();
+  mac->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  phy->SetErrorRateModel (error);
+  phy->SetChannel (channel);
+  phy->SetDevice (dev);
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+
+  mobility->SetPosition (pos);
+  node->AggregateObject (mobility);
+  mac->SetAddress (Mac48Address::Allocate ());
+  dev->SetMac (mac);
+  dev->SetPhy (phy);
+  dev->SetRemoteStationManager (manager);
+  node->AddDevice (dev);
+  dev->SetReceiveCallback (MakeCallback (&YansWifiChannelSharedPacketTest::Receive, this));
+  return dev;
+}
+
+void
+YansWifiChannelSharedPacketTest::DoRun (void)
+{
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetAttribute ("MaxRange", DoubleValue (m_maxRange));
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+
+  Ptr<WifiNetDevice> sender = CreateOne (Vector (0.0, 0.0, 0.0), channel);
+  CreateOne (Vector (5.0, 0.0, 0.0), channel);
+  CreateOne (Vector (-5.0, 0.0, 0.0), channel);
+  //too far away to detect the transmission
+  CreateOne (Vector (10000.0, 0.0, 0.0), channel);
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelSharedPacketTest::SendOnePacket, this, sender);
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received, 2, "Both receivers in range should receive the packet");
+  NS_TEST_ASSERT_MSG_EQ (channel->GetNTransmissions (), 1, "One transmission should have been sent");
+  NS_TEST_ASSERT_MSG_EQ (channel->GetRxPacketCopies (), 2, "Only the receivers in range should copy the packet");
+  NS_TEST_ASSERT_MSG_EQ (channel->GetNPrunedReceivers (), (m_maxRange > 0 ? 1 : 0), "Only the farthest receiver should be pruned");
+
+  Simulator::Destroy ();
+}
+
 //-----------------------------------------------------------------------------
 
 class WifiTestSuite : public TestSuite
@@ -1108,6 +1219,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
   AddTestCase (new SetChannelFrequencyTest, TestCase::QUICK);
   AddTestCase (new Bug2222TestCase, TestCase::QUICK); //Bug 2222
+  AddTestCase (new YansWifiChannelSharedPacketTest (0), TestCase::QUICK);
+  AddTestCase (new YansWifiChannelSharedPacketTest (1000), TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-header.h"
+
+using namespace ns3;
+
+/*
+ * Benchmark the demultiplexing of the TCP segments received by a
+ * server which listens on a port and holds many connections on it, as
+ * in an incast scenario.
+ *
+ * For each number of connections, the endpoints of the listening socket
+ * and of the connections are allocated on one node, then segments of
+ * randomly chosen connections are handed to TcpL4Protocol::Receive.
+ * No socket is attached to the endpoints, so the time measured is the
+ * cost of the TCP receive path up to the endpoint, which is dominated
+ * by the demultiplexing when the node has many connections.
+ */
+
+/**
+ * \param nConnections the number of connections of the server
+ * \param nPackets the number of segments received
+ * \param random the random stream choosing the connections
+ * \return the time per segment, in ns
+ */
+static double
+Run (uint32_t nConnections, uint32_t nPackets, Ptr<UniformRandomVariable> random)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<TcpL4Protocol> tcp = node->GetObject<TcpL4Protocol> ();
+  // the loopback interface, with address 127.0.0.1
+  Ptr<Ipv4Interface> interface = node->GetObject<Ipv4L3Protocol> ()->GetInterface (0);
+
+  Ipv4Address server ("127.0.0.1");
+  uint16_t port = 80;
+  tcp->Allocate (port);
+  for (uint32_t i = 0; i < nConnections; i++)
+    {
+      tcp->Allocate (server, port, Ipv4Address (0x0a000000 + i / 64), 1024 + i % 64);
+    }
+
+  // prepare the segments beforehand
+  uint32_t nSegments = 1024;
+  std::vector<Ptr<Packet> > packets;
+  std::vector<Ipv4Header> headers;
+  for (uint32_t i = 0; i < nSegments; i++)
+    {
+      uint32_t connection = random->GetInteger (0, nConnections - 1);
+      TcpHeader tcpHeader;
+      tcpHeader.SetSourcePort (1024 + connection % 64);
+      tcpHeader.SetDestinationPort (port);
+      tcpHeader.SetFlags (TcpHeader::ACK);
+      Ptr<Packet> packet = Create<Packet> (100);
+      packet->AddHeader (tcpHeader);
+      packets.push_back (packet);
+      Ipv4Header ipHeader;
+      ipHeader.SetSource (Ipv4Address (0x0a000000 + connection / 64));
+      ipHeader.SetDestination (server);
+      ipHeader.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+      headers.push_back (ipHeader);
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      IpL4Protocol::RxStatus status = tcp->Receive (packets[i % nSegments]->Copy (), headers[i % nSegments], interface);
+      if (status != IpL4Protocol::RX_OK)
+        {
+          std::cerr << "segment not delivered" << std::endl;
+          exit (1);
+        }
+    }
+  int64_t elapsed = time.End ();
+
+  Simulator::Destroy ();
+  return elapsed * 1e6 / nPackets;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t packets = 1000000;
+  uint32_t maxConnections = 50000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the demultiplexing of TCP segments to the connections of a server.");
+  cmd.AddValue ("packets", "number of segments received for each number of connections", packets);
+  cmd.AddValue ("connections", "largest number of connections", maxConnections);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  std::cout << std::setw (12) << "connections" << std::setw (16) << "per segment (ns)" << std::endl;
+  uint32_t n = 1;
+  while (true)
+    {
+      std::cout << std::setw (12) << n << std::setw (16) << Run (n, packets, random) << std::endl;
+      if (n == maxConnections)
+        {
+          break;
+        }
+      n = std::min (n * 10, maxConnections);
+    }
+  return 0;
+}
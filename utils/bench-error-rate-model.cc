@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/wifi-module.h"
+
+using namespace ns3;
+
+/*
+ * Compare the speed and the chunk success rates of the analytic Wi-Fi
+ * error rate models and of a TableErrorRateModel tabulating them.
+ *
+ * The chunks have random modes, SNRs and sizes, as the chunks of the
+ * frames received by a PHY.
+ */
+
+/// A chunk of a frame
+struct FrameChunk
+{
+  WifiMode mode;  //!< the mode of the chunk
+  double snr;     //!< the SNR of the chunk
+  uint32_t nbits; //!< the size of the chunk
+};
+
+/**
+ * \param model an error rate model
+ * \param chunks the chunks
+ * \param rates the chunk success rates, filled
+ * \return the time per chunk, in ns
+ */
+static double
+Run (Ptr<ErrorRateModel> model, const std::vector<FrameChunk> &chunks, std::vector<double> &rates)
+{
+  WifiTxVector txVector;
+  txVector.SetChannelWidth (20);
+  txVector.SetNss (1);
+  rates.resize (chunks.size ());
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < chunks.size (); i++)
+    {
+      txVector.SetMode (chunks[i].mode);
+      rates[i] = model->GetChunkSuccessRate (chunks[i].mode, txVector, chunks[i].snr, chunks[i].nbits);
+    }
+  int64_t elapsed = time.End ();
+  return elapsed * 1e6 / chunks.size ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nChunks = 1000000;
+  double resolution = 0.1;
+
+  CommandLine cmd;
+  cmd.Usage ("Compare the analytic Wi-Fi error rate models with their tabulation.");
+  cmd.AddValue ("chunks", "number of chunks", nChunks);
+  cmd.AddValue ("resolution", "SNR step of the tables, in dB", resolution);
+  cmd.Parse (argc, argv);
+
+  std::vector<WifiMode> modes;
+  modes.push_back (WifiPhy::GetDsssRate1Mbps ());
+  modes.push_back (WifiPhy::GetDsssRate11Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate6Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate24Mbps ());
+  modes.push_back (WifiPhy::GetOfdmRate54Mbps ());
+  modes.push_back (WifiPhy::GetHtMcs7 ());
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  std::vector<FrameChunk> chunks (nChunks);
+  for (uint32_t i = 0; i < nChunks; i++)
+    {
+      chunks[i].mode = modes[random->GetInteger (0, modes.size () - 1)];
+      chunks[i].snr = std::pow (10.0, random->GetValue (0.0, 40.0) / 10.0);
+      chunks[i].nbits = 8 * random->GetInteger (14, 1500);
+    }
+
+  std::cout << std::setw (8) << "model" << std::setw (18) << "analytic (ns)" << std::setw (18) << "table (ns)"
+            << std::setw (18) << "max error" << std::endl;
+  const char *names[] = { "Nist", "Yans" };
+  for (uint32_t m = 0; m < 2; m++)
+    {
+      Ptr<ErrorRateModel> model;
+      if (m == 0)
+        {
+          model = CreateObject<NistErrorRateModel> ();
+        }
+      else
+        {
+          model = CreateObject<YansErrorRateModel> ();
+        }
+      Ptr<TableErrorRateModel> table = CreateObject<TableErrorRateModel> ();
+      table->SetErrorRateModel (model);
+      table->SetSnrResolution (resolution);
+
+      std::vector<double> expected;
+      std::vector<double> rates;
+      double analyticTime = Run (model, chunks, expected);
+      // the first run fills the tables
+      Run (table, chunks, rates);
+      double tableTime = Run (table, chunks, rates);
+      double maxError = 0;
+      for (uint32_t i = 0; i < nChunks; i++)
+        {
+          maxError = std::max (maxError, std::abs (rates[i] - expected[i]));
+        }
+      std::cout << std::setw (8) << names[m] << std::setw (18) << analyticTime << std::setw (18) << tableTime
+                << std::setw (18) << maxError << std::endl;
+    }
+  return 0;
+}
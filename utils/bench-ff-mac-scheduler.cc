@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/lte-module.h"
+
+using namespace ns3;
+
+/*
+ * Benchmark the downlink scheduling of an FF MAC scheduler of an eNB
+ * serving many UEs.
+ *
+ * The scheduler is driven directly through its SAPs, as LteEnbMac does:
+ * the UEs are configured with one logical channel with a saturated RLC
+ * buffer, then at each TTI a share of the UEs report synthetic subband
+ * CQIs and the scheduler is triggered.  The HARQ is disabled, so that
+ * every UE stays schedulable without HARQ feedback.
+ */
+
+/// The CSCHED SAP user of the benchmark, ignoring the confirmations
+class BenchCschedSapUser : public FfMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf (const struct CschedCellConfigCnfParameters& params) {}
+  virtual void CschedUeConfigCnf (const struct CschedUeConfigCnfParameters& params) {}
+  virtual void CschedLcConfigCnf (const struct CschedLcConfigCnfParameters& params) {}
+  virtual void CschedLcReleaseCnf (const struct CschedLcReleaseCnfParameters& params) {}
+  virtual void CschedUeReleaseCnf (const struct CschedUeReleaseCnfParameters& params) {}
+  virtual void CschedUeConfigUpdateInd (const struct CschedUeConfigUpdateIndParameters& params) {}
+  virtual void CschedCellConfigUpdateInd (const struct CschedCellConfigUpdateIndParameters& params) {}
+};
+
+/// The SCHED SAP user of the benchmark, counting the allocations
+class BenchSchedSapUser : public FfMacSchedSapUser
+{
+public:
+  BenchSchedSapUser ()
+    : m_allocations (0)
+  {
+  }
+  virtual void SchedDlConfigInd (const struct SchedDlConfigIndParameters& params)
+  {
+    m_allocations += params.m_buildDataList.size ();
+  }
+  virtual void SchedUlConfigInd (const struct SchedUlConfigIndParameters& params) {}
+
+  uint64_t m_allocations; //!< the number of DL allocations
+};
+
+/**
+ * \param bandwidth the bandwidth of the cell, in RBs
+ * \return the size of the RBGs of the type 0 allocation (36.213, 7.1.6.1)
+ */
+static uint32_t
+RbgSize (uint32_t bandwidth)
+{
+  if (bandwidth <= 10)
+    {
+      return 1;
+    }
+  if (bandwidth <= 26)
+    {
+      return 2;
+    }
+  if (bandwidth <= 63)
+    {
+      return 3;
+    }
+  return 4;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string scheduler = "ns3::PfFfMacScheduler";
+  uint32_t nUes = 1000;
+  uint32_t nTtis = 10000;
+  uint32_t cqiPeriod = 10;
+  uint32_t bandwidth = 100;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the downlink scheduling of an FF MAC scheduler serving many UEs.");
+  cmd.AddValue ("scheduler", "type of the FF MAC scheduler", scheduler);
+  cmd.AddValue ("ues", "number of UEs", nUes);
+  cmd.AddValue ("ttis", "number of TTIs scheduled", nTtis);
+  cmd.AddValue ("cqiPeriod", "period of the CQI reports of each UE, in TTIs", cqiPeriod);
+  cmd.AddValue ("bandwidth", "bandwidth of the cell, in RBs", bandwidth);
+  cmd.Parse (argc, argv);
+
+  ObjectFactory factory;
+  factory.SetTypeId (scheduler);
+  factory.Set ("HarqEnabled", BooleanValue (false));
+  Ptr<FfMacScheduler> sched = factory.Create<FfMacScheduler> ();
+  Ptr<LteFfrAlgorithm> ffr = CreateObject<LteFrNoOpAlgorithm> ();
+  ffr->SetDlBandwidth (bandwidth);
+  ffr->SetUlBandwidth (bandwidth);
+  sched->SetLteFfrSapProvider (ffr->GetLteFfrSapProvider ());
+  ffr->SetLteFfrSapUser (sched->GetLteFfrSapUser ());
+
+  BenchCschedSapUser cschedUser;
+  BenchSchedSapUser schedUser;
+  sched->SetFfMacCschedSapUser (&cschedUser);
+  sched->SetFfMacSchedSapUser (&schedUser);
+  FfMacCschedSapProvider *csched = sched->GetFfMacCschedSapProvider ();
+  FfMacSchedSapProvider *schedSap = sched->GetFfMacSchedSapProvider ();
+
+  FfMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+  cellConfig.m_dlBandwidth = bandwidth;
+  cellConfig.m_ulBandwidth = bandwidth;
+  csched->CschedCellConfigReq (cellConfig);
+
+  for (uint16_t rnti = 1; rnti <= nUes; rnti++)
+    {
+      FfMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+      ueConfig.m_rnti = rnti;
+      ueConfig.m_reconfigureFlag = false;
+      ueConfig.m_transmissionMode = 0;
+      csched->CschedUeConfigReq (ueConfig);
+
+      FfMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+      lcConfig.m_rnti = rnti;
+      lcConfig.m_reconfigureFlag = false;
+      LogicalChannelConfigListElement_s lc;
+      lc.m_logicalChannelIdentity = 3;
+      lc.m_logicalChannelGroup = 1;
+      lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+      lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+      lc.m_qci = 9;
+      lc.m_eRabMaximulBitrateUl = 0;
+      lc.m_eRabMaximulBitrateDl = 0;
+      lc.m_eRabGuaranteedBitrateUl = 0;
+      lc.m_eRabGuaranteedBitrateDl = 0;
+      lcConfig.m_logicalChannelConfigList.push_back (lc);
+      csched->CschedLcConfigReq (lcConfig);
+
+      FfMacSchedSapProvider::SchedDlRlcBufferReqParameters buffer;
+      buffer.m_rnti = rnti;
+      buffer.m_logicalChannelIdentity = 3;
+      buffer.m_rlcTransmissionQueueSize = 1000000000;
+      buffer.m_rlcTransmissionQueueHolDelay = 0;
+      buffer.m_rlcRetransmissionQueueSize = 0;
+      buffer.m_rlcRetransmissionHolDelay = 0;
+      buffer.m_rlcStatusPduSize = 0;
+      schedSap->SchedDlRlcBufferReq (buffer);
+    }
+
+  // prepare the CQI reports beforehand, one per UE
+  uint32_t nRbgs = (bandwidth + RbgSize (bandwidth) - 1) / RbgSize (bandwidth);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  std::vector<CqiListElement_s> cqis (nUes);
+  for (uint32_t i = 0; i < nUes; i++)
+    {
+      cqis[i].m_rnti = i + 1;
+      cqis[i].m_ri = 1;
+      cqis[i].m_cqiType = CqiListElement_s::A30;
+      cqis[i].m_wbCqi.push_back (random->GetInteger (1, 15));
+      cqis[i].m_wbPmi = 0;
+      cqis[i].m_sbMeasResult.m_higherLayerSelected.resize (nRbgs);
+      for (uint32_t j = 0; j < nRbgs; j++)
+        {
+          cqis[i].m_sbMeasResult.m_higherLayerSelected[j].m_sbPmi = 0;
+          cqis[i].m_sbMeasResult.m_higherLayerSelected[j].m_sbCqi.push_back (random->GetInteger (1, 15));
+        }
+    }
+
+  FfMacSchedSapProvider::SchedDlCqiInfoReqParameters cqiInfo;
+  FfMacSchedSapProvider::SchedDlTriggerReqParameters trigger;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t tti = 0; tti < nTtis; tti++)
+    {
+      uint16_t frame = (tti / 10) % 1024 + 1;
+      uint16_t subframe = tti % 10 + 1;
+      uint16_t sfnSf = (frame << 4) | subframe;
+      cqiInfo.m_sfnSf = sfnSf;
+      cqiInfo.m_cqiList.clear ();
+      for (uint32_t i = tti % cqiPeriod; i < nUes; i += cqiPeriod)
+        {
+          cqiInfo.m_cqiList.push_back (cqis[i]);
+        }
+      schedSap->SchedDlCqiInfoReq (cqiInfo);
+      trigger.m_sfnSf = sfnSf;
+      schedSap->SchedDlTriggerReq (trigger);
+    }
+  int64_t elapsed = time.End ();
+
+  std::cout << scheduler << std::endl;
+  std::cout << std::setw (8) << "UEs" << std::setw (8) << "RBGs" << std::setw (16) << "per TTI (ns)"
+            << std::setw (16) << "allocations" << std::endl;
+  std::cout << std::setw (8) << nUes << std::setw (8) << nRbgs << std::setw (16) << elapsed * 1e6 / nTtis
+            << std::setw (16) << schedUser.m_allocations << std::endl;
+
+  sched->Dispose ();
+  ffr->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "ns3/core-module.h"
+#include "ns3/system-thread.h"
 
 using namespace ns3;
 
@@ -124,12 +125,146 @@ Bench::Cb (void)
 }
 
 
+/**
+ * Inject events into the simulator from other threads, the way
+ * fd-net-device and tap-bridge reader threads do, and measure how
+ * fast the main thread picks them up.
+ */
+class InjectBench
+{
+public:
+  InjectBench (const uint32_t threads, const uint32_t total)
+  : m_threads (threads),
+    m_total (total),
+    m_count (0)
+  { };
+
+  void RunBench (void);
+private:
+  static void Inject (std::pair<InjectBench *, uint32_t> context);
+  void Cb (void);
+  void Poll (void);
+
+  uint32_t m_threads;
+  uint32_t m_total;
+  uint32_t m_count;
+};
+
+void
+InjectBench::RunBench (void)
+{
+  SystemWallClockMs time;
+  double simu;
+
+  m_count = 0;
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (
+          MakeBoundCallback (&InjectBench::Inject,
+                             std::pair<InjectBench *, uint32_t> (this, i))));
+    }
+
+  // keep the event list busy until every injected event has run
+  Simulator::Schedule (NanoSeconds (1), &InjectBench::Poll, this);
+
+  DEB ("running");
+  time.Start ();
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      threads[i]->Start ();
+    }
+  Simulator::Run ();
+  simu = time.End ();
+  simu /= 1000;
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      threads[i]->Join ();
+    }
+  DEB ("run took " << simu << "s");
+
+  LOG (std::setw (g_fwidth) << m_threads <<
+       std::setw (g_fwidth) << simu <<
+       std::setw (g_fwidth) << (m_count / simu) <<
+       std::setw (g_fwidth) << (simu / m_count));
+}
+
+void
+InjectBench::Inject (std::pair<InjectBench *, uint32_t> context)
+{
+  InjectBench *me = context.first;
+  uint32_t perThread = me->m_total / me->m_threads;
+  for (uint32_t i = 0; i < perThread; ++i)
+    {
+      Simulator::ScheduleWithContext (context.second, NanoSeconds (i % 100),
+                                      &InjectBench::Cb, me);
+    }
+}
+
+void
+InjectBench::Cb (void)
+{
+  ++m_count;
+}
+
+void
+InjectBench::Poll (void)
+{
+  if (m_count < (m_total / m_threads) * m_threads)
+    {
+      Simulator::Schedule (NanoSeconds (1), &InjectBench::Poll, this);
+    }
+}
+
+
+/**
+ * Draw a fixed sequence of delays from a mixture of two distributions.
+ *
+ * \param [in] p The probability of drawing from \p a.
+ * \param [in] a The first distribution.
+ * \param [in] b The second distribution.
+ * \returns A stream cycling through the sequence.
+ */
+Ptr<RandomVariableStream>
+GetMixtureStream (double p, Ptr<RandomVariableStream> a, Ptr<RandomVariableStream> b)
+{
+  Ptr<UniformRandomVariable> coin = CreateObject<UniformRandomVariable> ();
+  std::vector<double> nsValues (1000003);
+  for (uint32_t i = 0; i < nsValues.size (); ++i)
+    {
+      nsValues[i] = (coin->GetValue () < p) ? a->GetValue () : b->GetValue ();
+    }
+  Ptr<DeterministicRandomVariable> drv = CreateObject<DeterministicRandomVariable> ();
+  drv->SetValueArray (&nsValues[0], nsValues.size ());
+  return drv;
+}
+
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, std::string dist)
 {
   Ptr<RandomVariableStream> stream = 0;
   
-  if (filename == "")
+  if (filename == "" && dist == "bursty")
+    {
+      LOGME ("using bursty distribution: 90% uniform [0,10) ns, "
+             "10% exponential with mean 10 us");
+      Ptr<UniformRandomVariable> burst = CreateObject<UniformRandomVariable> ();
+      burst->SetAttribute ("Max", DoubleValue (10));
+      Ptr<ExponentialRandomVariable> gap = CreateObject<ExponentialRandomVariable> ();
+      gap->SetAttribute ("Mean", DoubleValue (10000));
+      stream = GetMixtureStream (0.9, burst, gap);
+    }
+  else if (filename == "" && dist == "bimodal")
+    {
+      LOGME ("using bimodal distribution: exponential with mean 100 ns "
+             "or 1 ms, with equal probability");
+      Ptr<ExponentialRandomVariable> shortDelay = CreateObject<ExponentialRandomVariable> ();
+      shortDelay->SetAttribute ("Mean", DoubleValue (100));
+      Ptr<ExponentialRandomVariable> longDelay = CreateObject<ExponentialRandomVariable> ();
+      longDelay->SetAttribute ("Mean", DoubleValue (1000000));
+      stream = GetMixtureStream (0.5, shortDelay, longDelay);
+    }
+  else if (filename == "")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
@@ -186,90 +321,154 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
+  bool poolStats = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
+  uint32_t inject =      0;
   std::string filename = "";
+  std::string dist = "exp";
   
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
              "Event intervals are taken from one of:\n"
-             "  an exponential distribution, with mean 100 ns,\n"
+             "  an exponential distribution, with mean 100 ns (hold model),\n"
+             "  a bursty or bimodal mixture, given by --dist=<bursty|bimodal>,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "With --inject=<threads>, --total events are instead scheduled\n"
+             "with context from that many threads while the simulator runs.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "compare all schedulers",        schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dist",  "event time distribution: exp, bursty or bimodal (default exp)", dist);
+  cmd.AddValue ("inject", "number of threads injecting events with context (default 0)", inject);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("poolstats", "print the event pool statistics", poolStats);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::ListScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+    }
+  else if (schedCal)    { schedulers.push_back ("ns3::CalendarScheduler"); }
+  else if (schedHeap)   { schedulers.push_back ("ns3::HeapScheduler");     }
+  else if (schedList)   { schedulers.push_back ("ns3::ListScheduler");     }
+  else if (schedLadder) { schedulers.push_back ("ns3::LadderScheduler");   }
+  else                  { schedulers.push_back ("ns3::MapScheduler");      }
+  ObjectFactory factory (schedulers.front ());
   Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
   
+  if (inject > 0)
+    {
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+      LOGME ("injecting threads: " << inject);
+      InjectBench *injectBench = new InjectBench (inject, total);
+
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (g_fwidth) << "Threads" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (2 * g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::left << std::setw (g_fwidth) << i;
+          injectBench->RunBench ();
+        }
+      LOG ("");
+      Simulator::Destroy ();
+      delete injectBench;
+      return 0;
+    }
+
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRandomStream (GetRandomStream (filename, dist));
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-       
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (std::vector<std::string>::const_iterator s = schedulers.begin ();
+       s != schedulers.end (); ++s)
     {
-      std::cout << std::setw (g_fwidth) << i;
-      
+      factory.SetTypeId (*s);
+      Simulator::SetScheduler (factory);
+      LOG ("");
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+
+      // table header
+      LOG ("");
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+       
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
+
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+      
+          bench->RunBench ();
+        }
     }
 
   LOG ("");
+  if (poolStats)
+    {
+      LOGME ("event pool statistics:");
+      EventImpl::PrintPoolStats (std::cout);
+      LOG ("");
+    }
   return 0;
 
   Simulator::Destroy ();
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-value.h"
+
+using namespace ns3;
+
+/*
+ * Benchmark the SpectrumValue arithmetic on the inner loop of the LTE
+ * interference model: for each chunk, compute the interference plus
+ * noise and the SINR of the signal being received, and accumulate the
+ * SINR weighted by the chunk duration.
+ *
+ * This is done once with the binary operators, which create temporary
+ * SpectrumValues, and once with the in-place kernels, for each
+ * instruction set supported and for the 6 RB and 100 RB LTE bandwidths.
+ */
+
+/**
+ * \param nRb number of LTE resource blocks
+ * \return a SpectrumModel with one 180 kHz band per resource block
+ */
+static Ptr<SpectrumModel>
+CreateRbSpectrumModel (uint32_t nRb)
+{
+  std::vector<double> freqs;
+  double fc = 2.12e9;
+  for (uint32_t i = 0; i <= nRb; i++)
+    {
+      freqs.push_back (fc - nRb * 90e3 + i * 180e3);
+    }
+  return Create<SpectrumModel> (freqs);
+}
+
+/**
+ * \param m the SpectrumModel
+ * \param scale the magnitude of the values
+ * \return a SpectrumValue with varied values
+ */
+static SpectrumValue
+CreateValue (Ptr<SpectrumModel> m, double scale)
+{
+  SpectrumValue v (m);
+  for (uint32_t i = 0; i < m->GetNumBands (); i++)
+    {
+      v[i] = scale * (1.5 + std::sin (i * scale * 1e16));
+    }
+  return v;
+}
+
+/**
+ * Run the chunk computation with the binary operators.
+ *
+ * \param iterations the number of chunks
+ * \param rx the signal being received
+ * \param all the sum of all the signals
+ * \param noise the noise
+ * \param sum the accumulated SINR
+ * \return the time elapsed, in ms
+ */
+static int64_t
+RunOperators (uint32_t iterations, const SpectrumValue &rx, const SpectrumValue &all,
+              const SpectrumValue &noise, SpectrumValue &sum)
+{
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      SpectrumValue interf = all - rx + noise;
+      SpectrumValue sinr = rx / interf;
+      sum += sinr * 1e-3;
+    }
+  return time.End ();
+}
+
+/**
+ * Run the chunk computation with the in-place kernels.
+ *
+ * \param iterations the number of chunks
+ * \param rx the signal being received
+ * \param all the sum of all the signals
+ * \param noise the noise
+ * \param sum the accumulated SINR
+ * \return the time elapsed, in ms
+ */
+static int64_t
+RunKernels (uint32_t iterations, const SpectrumValue &rx, const SpectrumValue &all,
+            const SpectrumValue &noise, SpectrumValue &sum)
+{
+  SpectrumValue interf;
+  SpectrumValue sinr;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      interf.AssignDifference (all, rx);
+      sinr.AssignRatio (rx, interf, noise);
+      interf += noise;
+      sum.AddProduct (sinr, 1e-3);
+    }
+  return time.End ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t bands = 600000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the SpectrumValue arithmetic of the LTE interference model.\n"
+             "\n"
+             "The number of chunks computed for each bandwidth is such that\n"
+             "the same number of band values is processed for all bandwidths.");
+  cmd.AddValue ("bands", "number of band values processed (x 1000)", bands);
+  cmd.Parse (argc, argv);
+
+  const char *levelNames[] = { "none", "sse2", "avx" };
+  SpectrumValue::SimdLevel levels[] = { SpectrumValue::SIMD_NONE, SpectrumValue::SIMD_SSE2, SpectrumValue::SIMD_AVX };
+  SpectrumValue::SimdLevel defaultLevel = SpectrumValue::GetSimdLevel ();
+  uint32_t rbs[] = { 6, 100 };
+
+  std::cout << std::setprecision (3);
+  std::cout << "default SIMD level: " << levelNames[defaultLevel] << std::endl;
+  std::cout << std::setw (6) << "RBs" << std::setw (8) << "SIMD"
+            << std::setw (16) << "operators (ns)" << std::setw (16) << "kernels (ns)"
+            << std::setw (10) << "speedup" << std::endl;
+
+  for (uint32_t r = 0; r < sizeof (rbs) / sizeof (rbs[0]); r++)
+    {
+      Ptr<SpectrumModel> m = CreateRbSpectrumModel (rbs[r]);
+      SpectrumValue rx = CreateValue (m, 1e-14);
+      SpectrumValue all = rx + CreateValue (m, 3e-15);
+      SpectrumValue noise = CreateValue (m, 4e-18);
+      uint32_t iterations = (uint64_t)bands * 1000 / rbs[r];
+
+      for (uint32_t l = 0; l < sizeof (levels) / sizeof (levels[0]); l++)
+        {
+          if (SpectrumValue::SetSimdLevel (levels[l]) != levels[l])
+            {
+              continue;
+            }
+          SpectrumValue sum1 (m);
+          SpectrumValue sum2 (m);
+          int64_t operators = RunOperators (iterations, rx, all, noise, sum1);
+          int64_t kernels = RunKernels (iterations, rx, all, noise, sum2);
+          if (Norm (sum1 - sum2) != 0)
+            {
+              std::cerr << "results differ" << std::endl;
+              return 1;
+            }
+          std::cout << std::setw (6) << rbs[r] << std::setw (8) << levelNames[levels[l]]
+                    << std::setw (16) << operators * 1e6 / iterations
+                    << std::setw (16) << kernels * 1e6 / iterations
+                    << std::setw (10) << (double)operators / std::max<int64_t> (kernels, 1)
+                    << std::endl;
+        }
+    }
+  SpectrumValue::SetSimdLevel (defaultLevel);
+  return 0;
+}
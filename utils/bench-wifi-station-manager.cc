@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+using namespace ns3;
+
+/*
+ * Benchmark the overhead of the remote station manager of an access
+ * point for each data frame sent to one of its associated stations.
+ *
+ * For each number of stations, the stations are associated to the
+ * WifiRemoteStationManager of the ApWifiMac of one node, then for each
+ * frame the manager is asked the TX vector, whether to protect the frame
+ * with RTS/CTS, and is told about the ACK and an uplink frame received,
+ * as MacLow does.
+ */
+
+/**
+ * \param manager the type of WifiRemoteStationManager
+ * \param nStations the number of associated stations
+ * \param nFrames the number of frames sent
+ * \param random the random stream choosing the stations
+ * \return the time per frame, in ns
+ */
+static double
+Run (std::string manager, uint32_t nStations, uint32_t nFrames, Ptr<UniformRandomVariable> random)
+{
+  Ptr<Node> ap = CreateObject<Node> ();
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager (manager);
+  WifiMacHelper mac;
+  mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (Ssid ("bench")));
+  NetDeviceContainer devices = wifi.Install (phy, mac, ap);
+  Ptr<WifiRemoteStationManager> stations = DynamicCast<WifiNetDevice> (devices.Get (0))->GetRemoteStationManager ();
+
+  std::vector<Mac48Address> addresses;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      Mac48Address address = Mac48Address::Allocate ();
+      stations->AddAllSupportedModes (address);
+      stations->RecordGotAssocTxOk (address);
+      addresses.push_back (address);
+    }
+
+  // prepare the frames beforehand
+  uint32_t nHeaders = 1024;
+  std::vector<WifiMacHeader> headers;
+  for (uint32_t i = 0; i < nHeaders; i++)
+    {
+      WifiMacHeader header;
+      header.SetType (WIFI_MAC_DATA);
+      header.SetAddr1 (addresses[random->GetInteger (0, nStations - 1)]);
+      headers.push_back (header);
+    }
+  Ptr<Packet> packet = Create<Packet> (1000);
+  WifiMode ackMode = stations->GetDefaultMode ();
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < nFrames; i++)
+    {
+      const WifiMacHeader *header = &headers[i % nHeaders];
+      Mac48Address address = header->GetAddr1 ();
+      WifiTxVector txVector = stations->GetDataTxVector (address, header, packet);
+      stations->NeedRts (address, header, packet, txVector);
+      stations->ReportDataOk (address, header, 20, ackMode, 20);
+      stations->ReportRxOk (address, header, 20, txVector.GetMode ());
+    }
+  int64_t elapsed = time.End ();
+
+  Simulator::Destroy ();
+  return elapsed * 1e6 / nFrames;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t frames = 1000000;
+  uint32_t maxStations = 2000;
+  std::string manager = "ns3::MinstrelWifiManager";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the per-frame overhead of the remote station manager of an access point.");
+  cmd.AddValue ("frames", "number of frames sent for each number of stations", frames);
+  cmd.AddValue ("stations", "largest number of associated stations", maxStations);
+  cmd.AddValue ("manager", "type of the remote station manager", manager);
+  cmd.Parse (argc, argv);
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  std::cout << manager << std::endl;
+  std::cout << std::setw (12) << "stations" << std::setw (16) << "per frame (ns)" << std::endl;
+  uint32_t n = 1;
+  while (true)
+    {
+      std::cout << std::setw (12) << n << std::setw (16) << Run (manager, n, frames, random) << std::endl;
+      if (n == maxStations)
+        {
+          break;
+        }
+      n = std::min (n * 10, maxStations);
+    }
+  return 0;
+}
@@ -0,0 +1,55 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/lte-module.h"
+
+using namespace ns3;
+
+/*
+ * Convert a text fading trace, as generated by fading_trace_generator.m,
+ * into the binary format memory mapped by TraceFadingLossModel.
+ */
+
+int main (int argc, char *argv[])
+{
+  std::string in;
+  std::string out;
+  uint32_t rbNum = 100;
+  uint32_t samplesNum = 10000;
+
+  CommandLine cmd;
+  cmd.Usage ("Convert a text fading trace into the binary format of TraceFadingLossModel.");
+  cmd.AddValue ("in", "name of the text trace", in);
+  cmd.AddValue ("out", "name of the binary trace written", out);
+  cmd.AddValue ("rbNum", "number of RBs of the trace", rbNum);
+  cmd.AddValue ("samplesNum", "number of samples per RB of the trace", samplesNum);
+  cmd.Parse (argc, argv);
+
+  if (in.empty () || out.empty () || rbNum > 255)
+    {
+      std::cerr << "Usage: convert-fading-trace --in=<text trace> --out=<binary trace> [--rbNum=100] [--samplesNum=10000]" << std::endl;
+      return 1;
+    }
+  if (!TraceFadingLossModel::ConvertTrace (in, out, rbNum, samplesNum))
+    {
+      std::cerr << "Could not convert " << in << " into " << out << std::endl;
+      return 1;
+    }
+  return 0;
+}